@@ -0,0 +1,95 @@
+/**
+ * @file BlockHotness.h
+ * @brief Per-block obfuscation intensity from profile counts or loop structure
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * Obfuscating the hottest blocks costs the most runtime for the least
+ * protection. When the module carries profile data (compiled with
+ * --profile), each block gets an intensity between 0 and 100: full
+ * strength at or below the profile summary's cold count threshold, none
+ * at or above its hot count threshold, linear in between. Passes scale
+ * their probabilities by it.
+ *
+ * Without a profile, a static estimate can stand in: LoopInfo and
+ * BlockFrequencyInfo give each loop block its expected executions per
+ * call. Blocks of innermost loops at or above a threshold are spared
+ * entirely, blocks of outer loops above it get half intensity.
+ *
+ * A function's policy intensity (FunctionPolicy) scales all of its blocks
+ * on top of that.
+ */
+
+#ifndef BLOCK_HOTNESS_H
+#define BLOCK_HOTNESS_H
+
+#include <cstdint>
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/PassManager.h"
+
+namespace llvm {
+class ProfileSummaryInfo;
+}
+
+namespace obfuscator {
+
+/**
+ * @class BlockHotness
+ * @brief Obfuscation intensity of the blocks of one function
+ */
+class BlockHotness {
+public:
+    /**
+     * @brief Full intensity everywhere
+     */
+    BlockHotness() = default;
+
+    /**
+     * @brief Rate the blocks of a function by their profile counts
+     *
+     * Needs ProfileSummaryAnalysis cached for the module. Without profile
+     * data, blocks are rated by loop structure if hotLoopThreshold is set,
+     * otherwise every block stays at the function's policy intensity.
+     *
+     * @param hotLoopThreshold Relative frequency from which loop blocks count as hot (0 = off)
+     */
+    BlockHotness(llvm::Function& func, llvm::FunctionAnalysisManager& analyses,
+                 uint32_t hotLoopThreshold = 0);
+
+    /**
+     * @brief Intensity of a block, 100 for blocks created after rating
+     */
+    uint32_t getIntensity(const llvm::BasicBlock* bb) const {
+        auto it = intensity_.find(bb);
+        return (it == intensity_.end() ? 100 : it->second) * policyIntensity_ / 100;
+    }
+
+    /**
+     * @brief Intensity of the hottest block, for whole-function transforms
+     */
+    uint32_t getFunctionIntensity() const { return functionIntensity_ * policyIntensity_ / 100; }
+
+    /**
+     * @brief Scale a percentage (probability, ratio) by a block's intensity
+     */
+    uint32_t scale(uint32_t percentage, const llvm::BasicBlock* bb) const {
+        return percentage * getIntensity(bb) / 100;
+    }
+
+private:
+    void rateByProfile(llvm::Function& func, llvm::FunctionAnalysisManager& analyses,
+                       const llvm::ProfileSummaryInfo& summary);
+    void rateByLoops(llvm::Function& func, llvm::FunctionAnalysisManager& analyses,
+                     uint32_t hotLoopThreshold);
+    void setIntensity(const llvm::BasicBlock* bb, uint32_t intensity);
+
+    llvm::DenseMap<const llvm::BasicBlock*, uint32_t> intensity_;
+    uint32_t functionIntensity_ = 100;
+    uint32_t policyIntensity_ = 100;
+};
+
+} // namespace obfuscator
+
+#endif // BLOCK_HOTNESS_H
@@ -0,0 +1,119 @@
+/**
+ * @file BoundedQueue.h
+ * @brief Blocking FIFO queue with a capacity bound
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * Producers block while the queue is full, so a fast stage cannot run
+ * arbitrarily far ahead of a slow one. Closing the queue wakes everyone:
+ * further pushes fail, and consumers drain what is left before pop()
+ * reports the end.
+ */
+
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace obfuscator {
+
+/**
+ * @class BoundedQueue
+ * @brief Multi-producer, multi-consumer queue of at most a fixed number of items
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    /**
+     * @brief Create an open queue
+     * @param capacity Maximum number of queued items (at least 1)
+     */
+    explicit BoundedQueue(size_t capacity)
+        : capacity_(std::max<size_t>(capacity, 1)), closed_(false), highWatermark_(0) {
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    /**
+     * @brief Append an item, waiting for room
+     * @param item Item to append
+     * @return false if the queue was closed (the item is dropped)
+     */
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [this] { return closed_ || items_.size() < capacity_; });
+        if (closed_) {
+            return false;
+        }
+        items_.push_back(std::move(item));
+        highWatermark_ = std::max(highWatermark_, items_.size());
+        lock.unlock();
+        notEmpty_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Take the oldest item, waiting for one
+     * @param item Receives the item
+     * @return false once the queue is closed and empty
+     */
+    bool pop(T& item) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+        if (items_.empty()) {
+            return false;
+        }
+        item = std::move(items_.front());
+        items_.pop_front();
+        lock.unlock();
+        notFull_.notify_one();
+        return true;
+    }
+
+    /**
+     * @brief Stop accepting items and wake all waiters
+     */
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            closed_ = true;
+        }
+        notFull_.notify_all();
+        notEmpty_.notify_all();
+    }
+
+    /**
+     * @brief Get the number of queued items
+     */
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return items_.size();
+    }
+
+    /**
+     * @brief Get the largest number of items queued at once
+     */
+    size_t getHighWatermark() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return highWatermark_;
+    }
+
+private:
+    const size_t capacity_;
+    mutable std::mutex mutex_;
+    std::condition_variable notFull_;
+    std::condition_variable notEmpty_;
+    std::deque<T> items_;
+    bool closed_;
+    size_t highWatermark_;
+};
+
+} // namespace obfuscator
+
+#endif // BOUNDED_QUEUE_H
@@ -22,6 +22,17 @@ public:
     bool parse(int argc, char* argv[]);
     const ObfuscationConfig& getConfig() const { return config_; }
     const std::string& getInputFile() const { return inputFile_; }
+    const std::vector<std::string>& getInputFiles() const { return inputFiles_; }
+    bool isProjectMode() const { return inputFiles_.size() > 1; }
+    bool isManifestMode() const { return !manifestFile_.empty(); }
+    const std::string& getManifestFile() const { return manifestFile_; }
+    const std::string& getResultsFile() const { return resultsFile_; }
+    bool isServeMode() const { return !serveSocket_.empty(); }
+    const std::string& getServeSocket() const { return serveSocket_; }
+    bool isClientMode() const { return !connectSocket_.empty(); }
+    const std::string& getConnectSocket() const { return connectSocket_; }
+    bool shouldSendInput() const { return sendInput_; }
+    bool isServerStatusQuery() const { return serverStatus_; }
     const std::string& getOutputFile() const { return outputFile_; }
     bool shouldShowHelp() const { return showHelp_; }
     bool shouldShowVersion() const { return showVersion_; }
@@ -35,8 +46,15 @@ public:
 private:
     ObfuscationConfig config_;
     std::string inputFile_;
+    std::vector<std::string> inputFiles_;
     std::string outputFile_;
     std::string configFile_;
+    std::string manifestFile_;
+    std::string resultsFile_;
+    std::string serveSocket_;
+    std::string connectSocket_;
+    bool sendInput_;
+    bool serverStatus_;
     bool showHelp_;
     bool showVersion_;
     bool autoTuneEnabled_;
@@ -0,0 +1,64 @@
+/**
+ * @file ClangFrontend.h
+ * @brief In-process clang frontend for compiling sources to LLVM modules
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * Drives a clang CompilerInstance inside the obfuscator process so that
+ * C/C++ sources are parsed straight into an LLVMContext, without spawning
+ * a compiler or writing intermediate bitcode to disk.
+ */
+
+#ifndef CLANG_FRONTEND_H
+#define CLANG_FRONTEND_H
+
+#include <string>
+#include <vector>
+#include <memory>
+
+#include "llvm/IR/Module.h"
+#include "llvm/IR/LLVMContext.h"
+
+namespace obfuscator {
+
+/**
+ * @class ClangFrontend
+ * @brief Compiles C/C++ sources to LLVM IR modules in-process
+ */
+class ClangFrontend {
+public:
+    /**
+     * @brief Construct a new Clang Frontend
+     * @param extraArgs Additional compiler arguments appended to every compile
+     */
+    explicit ClangFrontend(const std::vector<std::string>& extraArgs = {});
+
+    /**
+     * @brief Check whether the frontend was linked into this build
+     * @return true if in-process compilation is available
+     */
+    static bool isAvailable();
+
+    /**
+     * @brief Compile a source file to an LLVM module
+     * @param sourceFile Path to C/C++ source file
+     * @param context LLVM context that will own the module
+     * @return Compiled module, or nullptr on failure
+     */
+    std::unique_ptr<llvm::Module> compile(const std::string& sourceFile,
+                                          llvm::LLVMContext& context);
+
+    /**
+     * @brief Check if a source file should be compiled as C++
+     * @param sourceFile Path to source file
+     * @return true for C++ extensions
+     */
+    static bool isCppSource(const std::string& sourceFile);
+
+private:
+    std::vector<std::string> extraArgs_;
+};
+
+} // namespace obfuscator
+
+#endif // CLANG_FRONTEND_H
@@ -0,0 +1,121 @@
+/**
+ * @file CodeGenerator.h
+ * @brief In-process machine code generation for obfuscated modules
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * Runs the LLVM TargetMachine codegen pipeline directly on the in-memory
+ * module, producing the same object code llc would without serializing
+ * bitcode or spawning a process. Large modules can instead be split into
+ * partitions (in the style of llvm::splitCodeGen) that are compiled on
+ * worker threads, each in its own LLVMContext.
+ */
+
+#ifndef CODE_GENERATOR_H
+#define CODE_GENERATOR_H
+
+#include <string>
+#include <memory>
+#include <map>
+#include <vector>
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+#include "WorkStealingPool.h"
+
+namespace obfuscator {
+
+/**
+ * @class CodeGenerator
+ * @brief Emits object code from LLVM modules using cached target machines
+ *
+ * A CodeGenerator is not thread-safe; use one instance per thread.
+ */
+class CodeGenerator {
+public:
+    /**
+     * @brief Construct a new Code Generator
+     */
+    CodeGenerator();
+
+    /**
+     * @brief Destroy the Code Generator
+     */
+    ~CodeGenerator();
+
+    /**
+     * @brief Emit an object file for a module
+     * @param module Module to compile (codegen may mutate it)
+     * @param objectFile Path to output object file
+     * @return true if emission successful
+     */
+    bool emitObject(llvm::Module& module, const std::string& objectFile);
+
+    /**
+     * @brief Emit object code for a module into a stream
+     * @param module Module to compile (codegen may mutate it)
+     * @param out Seekable output stream
+     * @return true if emission successful
+     */
+    bool emitObject(llvm::Module& module, llvm::raw_pwrite_stream& out);
+
+    /**
+     * @brief Emit object code for a module into a memory buffer
+     * @param module Module to compile (codegen may mutate it)
+     * @param buffer Buffer receiving the object file bytes
+     * @return true if emission successful
+     */
+    bool emitObject(llvm::Module& module, llvm::SmallVectorImpl<char>& buffer);
+
+    /**
+     * @brief Split a module into partitions and emit their objects in parallel
+     * @param module Module to compile; its local symbols are promoted to
+     *        hidden globals with a module-specific suffix
+     * @param partitions Number of partitions (and threads)
+     * @param objects Receives one object per partition, to be linked together
+     * @return true if every partition was emitted
+     */
+    bool emitPartitions(llvm::Module& module, uint32_t partitions,
+                        std::vector<llvm::SmallVector<char, 0>>& objects);
+
+    /**
+     * @brief Choose how many partitions a module is worth splitting into
+     * @param module Module to compile
+     * @param jobs Configured codegen threads (0 = all cores)
+     * @return Partition count, 1 if the module should not be split
+     */
+    static uint32_t getPartitionCount(const llvm::Module& module, uint32_t jobs);
+
+    /**
+     * @brief Turn local symbols into hidden globals that separately
+     *        compiled parts of the module can share
+     * @param module Module to rewrite
+     *
+     * Helpers such as obf.decrypt.ctor or obf.cache.key exist with the same
+     * name in every translation unit, so the promoted names carry a suffix
+     * derived from the module to stay apart in the final link.
+     */
+    static void promoteLocals(llvm::Module& module);
+
+    /**
+     * @brief Get (or create) the target machine for a module's triple
+     * @param module Module whose triple selects the target
+     * @return Target machine, or nullptr if the target is unavailable
+     */
+    llvm::TargetMachine* getTargetMachine(llvm::Module& module);
+
+private:
+    std::map<std::string, std::unique_ptr<llvm::TargetMachine>> targetMachines_;
+    std::unique_ptr<WorkStealingPool> pool_;
+
+    /**
+     * @brief Register native targets with the LLVM target registry once
+     */
+    static void initializeTargets();
+};
+
+} // namespace obfuscator
+
+#endif // CODE_GENERATOR_H
@@ -18,9 +18,25 @@ public:
     ConfigParser();
     ~ConfigParser();
 
+    /**
+     * @brief Parse a configuration file, YAML for .yaml/.yml files, JSON otherwise
+     */
     bool parseFile(const std::string& filepath, ObfuscationConfig& config);
     bool parseJSON(const std::string& json, ObfuscationConfig& config);
 
+    /**
+     * @brief Parse the YAML layout written by AutoTuner::saveConfigToYAML
+     *
+     * obfuscation.level applies its preset first, the other settings then
+     * override it. Unknown keys are ignored, so files for other tools (the
+     * MAOS mode files in config/) can be read too. The functions section
+     * takes the allow, deny and protect lists as sequences of name regexes,
+     * and policies as a mapping from name regex to policy.
+     *
+     * @return false if the YAML is malformed or a value is invalid
+     */
+    bool parseYAML(const std::string& yaml, ObfuscationConfig& config);
+
 private:
     bool validateJSON(const std::string& json);
 };
@@ -0,0 +1,100 @@
+/**
+ * @file FunctionCache.h
+ * @brief Per-function cache of obfuscated bodies for incremental rebuilds
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * Every defined function is keyed by its own printed IR, the attributes
+ * and metadata it carries, the layouts of the named types it uses, the
+ * target and the configuration. Before the passes run, functions with a
+ * cached body are reduced to declarations so the passes skip them; after
+ * the passes, fresh bodies are stored and cached ones are linked back in
+ * through a FunctionTransplant. Module-level artifacts (string tables,
+ * constructors, helper functions) are rebuilt every run, so a module built
+ * from cached bodies matches a full run.
+ */
+
+#ifndef FUNCTION_CACHE_H
+#define FUNCTION_CACHE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "llvm/IR/Module.h"
+#include "llvm/IR/ModuleSlotTracker.h"
+#include "ObfuscationConfig.h"
+#include "ResultCache.h"
+
+namespace obfuscator {
+
+/**
+ * @class FunctionCache
+ * @brief Skips the passes for functions whose obfuscated body is cached
+ */
+class FunctionCache {
+public:
+    /**
+     * @brief Construct over an open result cache
+     * @param storage Cache the entries are kept in
+     * @param config Configuration the passes run with
+     */
+    FunctionCache(ResultCache& storage, const ObfuscationConfig& config);
+
+    /**
+     * @brief Look up every function and reduce hits to declarations
+     * @param module Unobfuscated module
+     * @return Number of functions taken from the cache
+     */
+    size_t prepare(llvm::Module& module);
+
+    /**
+     * @brief Store freshly obfuscated functions and link cached bodies back
+     * @param module Module after the passes ran
+     * @return false if cached bodies could not be linked back
+     */
+    bool finish(llvm::Module& module);
+
+    /**
+     * @brief Compute the cache key of an unobfuscated function
+     * @param func Function definition
+     * @return Cache key
+     */
+    std::string computeKey(const llvm::Function& func) const;
+
+    /**
+     * @brief Get number of functions taken from the cache by the last prepare()
+     * @return Hit count
+     */
+    size_t getHitCount() const { return hits_.size(); }
+
+    /**
+     * @brief Get number of functions obfuscated afresh by the last prepare()
+     * @return Miss count
+     */
+    size_t getMissCount() const { return misses_.size(); }
+
+private:
+    std::string computeKey(const llvm::Function& func, llvm::ModuleSlotTracker& slots) const;
+
+    struct Miss {
+        std::string name;
+        std::string key;
+    };
+
+    struct Hit {
+        std::string name;
+        std::unique_ptr<llvm::Module> body;
+        llvm::GlobalValue::LinkageTypes linkage;
+        llvm::Comdat* comdat;
+    };
+
+    ResultCache& storage_;
+    const ObfuscationConfig& config_;
+    std::vector<Miss> misses_;
+    std::vector<Hit> hits_;
+};
+
+} // namespace obfuscator
+
+#endif // FUNCTION_CACHE_H
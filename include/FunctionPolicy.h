@@ -0,0 +1,90 @@
+/**
+ * @file FunctionPolicy.h
+ * @brief Per-function obfuscation level and intensity
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * A policy is a comma-separated list of settings:
+ *
+ *   level=none|low|medium|high   Function-local passes of that preset ("none": skip the function)
+ *   intensity=<0-100>            Scales the probabilities and ratios of every pass
+ *
+ * Functions get policies from source annotations, which clang records in
+ * llvm.global.annotations,
+ *
+ *   __attribute__((annotate("phantron:level=high,intensity=80")))
+ *
+ * and from the function name lists of the configuration. The deny list
+ * wins over everything, then annotations, then the first matching policy
+ * rule.
+ *
+ * Obfuscation can also be limited to what matters: the functions of the
+ * allow list, and the protected region, i.e. every function within a
+ * number of direct calls of sensitive roots (e.g. check_license). The
+ * rest then gets the outside policy, "level=none" unless configured, so
+ * the cost scales with the protected code rather than the module.
+ *
+ * resolve() records the outcome as function attributes before the first
+ * cycle, so policies travel with the functions into shards and batches.
+ */
+
+#ifndef FUNCTION_POLICY_H
+#define FUNCTION_POLICY_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "llvm/ADT/StringRef.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/Module.h"
+#include "ObfuscationConfig.h"
+
+namespace obfuscator {
+
+/**
+ * @struct FunctionPolicy
+ * @brief How one function is obfuscated
+ */
+struct FunctionPolicy {
+    std::string level;         ///< "none", "low", "medium", "high", empty for the configured level
+    uint32_t intensity = 100;  ///< Percentage applied to every pass's probabilities
+
+    /**
+     * @brief Apply the settings of a policy text on top of a policy
+     * @param text Settings, e.g. "level=low,intensity=50"
+     * @param policy Policy to update
+     * @return false if a setting is unknown or its value invalid
+     */
+    static bool parse(llvm::StringRef text, FunctionPolicy& policy);
+
+    /**
+     * @brief Resolve the policy of every definition and record it on the function
+     *
+     * Policies that select the configured level at full intensity leave the
+     * function untouched, so modules without policies are not changed.
+     * @param module Module to tag
+     * @param config Configuration with the level, the function name lists and the roots
+     * @return Levels other than the configured one that functions were given
+     */
+    static std::vector<std::string> resolve(llvm::Module& module,
+                                            const ObfuscationConfig& config);
+
+    /**
+     * @brief Level recorded by resolve(), empty for the configured level
+     */
+    static llvm::StringRef getLevel(const llvm::Function& func);
+
+    /**
+     * @brief Intensity recorded by resolve(), 100 if none was
+     */
+    static uint32_t getIntensity(const llvm::Function& func);
+
+    /**
+     * @brief Whether resolve() excluded the function from obfuscation
+     */
+    static bool isExcluded(const llvm::Function& func) { return getLevel(func) == "none"; }
+};
+
+} // namespace obfuscator
+
+#endif // FUNCTION_POLICY_H
@@ -0,0 +1,105 @@
+/**
+ * @file FunctionTransplant.h
+ * @brief Copy function definitions out of a module and link replacements back
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * While a transplant is open, local symbols of the module are external so
+ * that detached copies of its functions can refer to them by name. Copies
+ * are standalone modules (declarations for everything they reference) that
+ * can be moved through bitcode, transformed elsewhere, staged back in any
+ * context-compatible form and finally committed over the originals in one
+ * link. restore() puts linkage, comdats and symbol order back as they were.
+ */
+
+#ifndef FUNCTION_TRANSPLANT_H
+#define FUNCTION_TRANSPLANT_H
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Linker/Linker.h"
+
+namespace obfuscator {
+
+/**
+ * @class FunctionTransplant
+ * @brief Replaces function bodies of a module with externally produced ones
+ */
+class FunctionTransplant {
+public:
+    /**
+     * @brief Open a transplant on a module
+     * @param module Module whose functions are copied and replaced
+     */
+    explicit FunctionTransplant(llvm::Module& module);
+
+    /**
+     * @brief Restore the module if restore() was not called
+     */
+    ~FunctionTransplant();
+
+    FunctionTransplant(const FunctionTransplant&) = delete;
+    FunctionTransplant& operator=(const FunctionTransplant&) = delete;
+
+    /**
+     * @brief Check whether functions of a module can be transplanted
+     * @param module Module to inspect
+     * @return false for modules with debug info, ifuncs or unnamed local symbols
+     */
+    static bool canTransplant(const llvm::Module& module);
+
+    /**
+     * @brief Copy functions, and declarations of what they use, to a new module
+     * @param functions Definitions to copy
+     * @return Standalone module in the same context
+     */
+    std::unique_ptr<llvm::Module> extract(llvm::ArrayRef<llvm::Function*> functions) const;
+
+    /**
+     * @brief Copy functions of a module without local symbols to a new module
+     * @param module Module whose symbols the copies refer to by name
+     * @param functions Definitions to copy
+     * @return Standalone module in the same context
+     */
+    static std::unique_ptr<llvm::Module> extract(const llvm::Module& module,
+                                                 llvm::ArrayRef<llvm::Function*> functions);
+
+    /**
+     * @brief Merge a module of replacement definitions into the staging area
+     * @param replacements Module in the same context as the transplanted module
+     * @return false if the definitions clash with already staged ones
+     */
+    bool stage(std::unique_ptr<llvm::Module> replacements);
+
+    /**
+     * @brief Replace functions by the staged definitions of the same name
+     * @param originals Functions to replace (definitions or declarations)
+     * @return false if linking the staged definitions failed
+     */
+    bool commit(llvm::ArrayRef<llvm::Function*> originals);
+
+    /**
+     * @brief Restore linkage, comdats and symbol order of the module
+     */
+    void restore();
+
+private:
+    llvm::Module& module_;
+    std::unique_ptr<llvm::Module> staging_;
+    std::unique_ptr<llvm::Linker> stagingLinker_;
+
+    std::vector<std::pair<std::string, llvm::GlobalValue::LinkageTypes>> savedLinkage_;
+    std::vector<std::pair<std::string, llvm::Comdat*>> savedComdats_;
+    std::vector<std::string> globalOrder_;
+    std::vector<std::string> functionOrder_;
+    bool restored_;
+};
+
+} // namespace obfuscator
+
+#endif // FUNCTION_TRANSPLANT_H
@@ -0,0 +1,107 @@
+/**
+ * @file Linker.h
+ * @brief Link stage producing the final obfuscated executable
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * Links object files either in-process through the lld ELF driver (when
+ * lld is linked into the build) or through the system clang driver.
+ */
+
+#ifndef LINKER_H
+#define LINKER_H
+
+#include <string>
+#include <vector>
+#include "llvm/ADT/SmallVector.h"
+#include "ObfuscationConfig.h"
+
+namespace obfuscator {
+
+/**
+ * @struct LinkerOptions
+ * @brief Inputs to a single link
+ */
+struct LinkerOptions {
+    std::vector<std::string> objectFiles;         ///< Objects produced by codegen
+    std::vector<std::string> runtimeObjects;      ///< Extra objects linked with the inputs
+    std::vector<std::string> libraries;           ///< Libraries passed as -l<name>
+    std::vector<std::string> librarySearchPaths;  ///< Directories passed as -L<dir>
+    std::string outputFile;
+    bool isCpp;                                   ///< Link the C++ runtime
+
+    LinkerOptions() : isCpp(false) {}
+};
+
+/**
+ * @class Linker
+ * @brief Links object files into an executable
+ */
+class Linker {
+public:
+    /**
+     * @brief Check whether lld was linked into this build
+     * @return true if in-process linking is available
+     */
+    static bool isInProcessAvailable();
+
+    /**
+     * @brief Build link options with the default and configured libraries
+     * @param config Obfuscation configuration (extra libraries, objects, paths)
+     * @param isCpp Whether the C++ standard library is needed
+     * @return Options without inputs or output set
+     */
+    static LinkerOptions makeOptions(const ObfuscationConfig& config, bool isCpp);
+
+    /**
+     * @brief Link objects into an executable
+     * @param options Link inputs and output path
+     * @return true if linking successful
+     */
+    bool link(const LinkerOptions& options);
+
+    /**
+     * @brief Combine objects into one relocatable object (ld -r)
+     * @param objectFiles Objects to combine
+     * @param outputFile Path to the combined object
+     * @return true if linking successful
+     */
+    bool linkRelocatable(const std::vector<std::string>& objectFiles,
+                         const std::string& outputFile);
+
+    /**
+     * @brief Combine objects into one relocatable object kept in memory
+     * @param objectFiles Objects to combine
+     * @param output Buffer receiving the combined object
+     * @return true if linking successful
+     */
+    bool linkRelocatable(const std::vector<std::string>& objectFiles,
+                         llvm::SmallVectorImpl<char>& output);
+
+private:
+    /**
+     * @brief Link through the lld ELF driver in this process
+     */
+    bool linkInProcess(const LinkerOptions& options);
+
+    /**
+     * @brief Relocatable link through the lld ELF driver in this process
+     */
+    bool linkRelocatableInProcess(const std::vector<std::string>& objectFiles,
+                                  const std::string& outputFile);
+
+    /**
+     * @brief Relocatable link through the lld ELF driver into memory
+     */
+    bool linkRelocatableInProcess(const std::vector<std::string>& objectFiles,
+                                  llvm::SmallVectorImpl<char>& output);
+
+    /**
+     * @brief Link through the system clang/clang++ driver
+     */
+    bool linkWithDriver(const LinkerOptions& options);
+};
+
+} // namespace obfuscator
+
+#endif // LINKER_H
@@ -11,6 +11,7 @@
 #include <string>
 #include <fstream>
 #include <mutex>
+#include <atomic>
 
 namespace obfuscator {
 
@@ -28,6 +29,7 @@ public:
     void setLogLevel(LogLevel level);
     void setLogFile(const std::string& filepath);
     void setVerbose(bool verbose);
+    void setUseStderr(bool useStderr);  // Keep stdout free for machine-readable output
     
     void debug(const std::string& message);
     void info(const std::string& message);
@@ -44,8 +46,9 @@ private:
     std::string levelToString(LogLevel level) const;
     std::string getCurrentTimestamp() const;
 
-    LogLevel logLevel_;
-    bool verbose_;
+    std::atomic<LogLevel> logLevel_;
+    std::atomic<bool> verbose_;
+    std::atomic<bool> useStderr_;
     std::ofstream logFile_;
     std::mutex mutex_;
 };
@@ -0,0 +1,123 @@
+/**
+ * @file LowMemoryPipeline.h
+ * @brief Batch-wise obfuscation and codegen of lazily loaded modules
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * Instead of holding the whole module in memory through obfuscation and
+ * codegen, function bodies are materialized a batch at a time, copied into
+ * a module of their own in a private LLVMContext, obfuscated and compiled
+ * there, and released from the main module as soon as their object is
+ * written. What remains at the end (globals, declarations, string tables)
+ * is obfuscated and compiled last, and all objects are combined into one
+ * relocatable object. Peak memory is bounded by the largest batch plus
+ * the module's global state instead of the whole module.
+ */
+
+#ifndef LOW_MEMORY_PIPELINE_H
+#define LOW_MEMORY_PIPELINE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/IR/Module.h"
+#include "ObfuscationConfig.h"
+#include "PassManager.h"
+#include "MetricsCollector.h"
+#include "Linker.h"
+#include "CodeGenerator.h"
+#include "MemoryFile.h"
+
+namespace obfuscator {
+
+/**
+ * @class LowMemoryPipeline
+ * @brief Obfuscates and compiles a module one function batch at a time
+ */
+class LowMemoryPipeline {
+public:
+    /**
+     * @brief Construct a pipeline
+     * @param config Obfuscation configuration (batch size, staging mode)
+     * @param passManager Passes run on every batch
+     * @param linker Linker that combines the batch objects
+     */
+    LowMemoryPipeline(const ObfuscationConfig& config, PassManager& passManager, Linker& linker);
+
+    /**
+     * @brief Check whether a module can be compiled in batches
+     * @param module Module to inspect
+     * @return false for modules with debug info or ifuncs
+     */
+    static bool canRun(const llvm::Module& module);
+
+    /**
+     * @brief Obfuscate and compile a module
+     * @param module Module, typically loaded lazily; left without function bodies
+     * @param metrics Metrics collector for reporting
+     * @param objectFile Path receiving the combined relocatable object
+     * @return true if every batch was obfuscated and compiled
+     */
+    bool run(llvm::Module& module, MetricsCollector& metrics, const std::string& objectFile);
+
+    /**
+     * @brief Obfuscate and compile a module to an in-memory object
+     * @param module Module, typically loaded lazily; left without function bodies
+     * @param metrics Metrics collector for reporting
+     * @param objectBuffer Buffer receiving the combined relocatable object
+     * @return true if every batch was obfuscated and compiled
+     */
+    bool run(llvm::Module& module, MetricsCollector& metrics,
+             llvm::SmallVectorImpl<char>& objectBuffer);
+
+private:
+    /**
+     * @brief Obfuscate and compile every batch and stage the objects
+     */
+    bool compileBatches(llvm::Module& module, MetricsCollector& metrics);
+
+    /**
+     * @brief Drop the staged batch objects
+     */
+    void releaseObjects();
+
+    /**
+     * @brief Obfuscate and compile a module in its own context
+     * @param bitcode Module to compile, as bitcode
+     * @param metrics Metrics collector for reporting
+     * @return true if the object was emitted and staged
+     */
+    bool compileBatch(llvm::StringRef bitcode, MetricsCollector& metrics);
+
+    /**
+     * @brief Run all obfuscation cycles and compile one module
+     */
+    bool obfuscateAndEmit(llvm::Module& module, MetricsCollector& metrics);
+
+    /**
+     * @brief Keep an object for the final relocatable link
+     */
+    bool stageObject(llvm::StringRef object);
+
+    const ObfuscationConfig& config_;
+    PassManager& passManager_;
+    Linker& linker_;
+    CodeGenerator codeGenerator_;
+
+    std::vector<std::unique_ptr<MemoryFile>> memoryObjects_;
+    std::vector<std::string> objectFiles_;
+    std::string objectStem_;
+    bool stageInMemory_;
+
+    uint32_t originalInsts_;
+    uint32_t obfuscatedInsts_;
+    uint32_t originalBBs_;
+    uint32_t obfuscatedBBs_;
+    uint32_t obfuscatedFuncs_;
+};
+
+} // namespace obfuscator
+
+#endif // LOW_MEMORY_PIPELINE_H
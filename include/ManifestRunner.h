@@ -0,0 +1,97 @@
+/**
+ * @file ManifestRunner.h
+ * @brief Batch obfuscation of many independent programs in one process
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * A manifest lists input/output pairs, one per line. Every worker thread
+ * owns one ObfuscationEngine for its whole share of the manifest, so
+ * LLVM's static initialization, the pass objects, the target machines and
+ * the LLVMContext are set up once per worker instead of once per file.
+ * Local value names are discarded to keep the shared context small. With
+ * pipelineWorkers set, entries go through a StagedPipeline instead, so
+ * the stages of different files overlap. Each processed entry is
+ * reported as one JSON object per line.
+ */
+
+#ifndef MANIFEST_RUNNER_H
+#define MANIFEST_RUNNER_H
+
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "ObfuscationConfig.h"
+
+namespace obfuscator {
+
+/**
+ * @struct ManifestEntry
+ * @brief One program to obfuscate
+ */
+struct ManifestEntry {
+    std::string inputFile;
+    std::string outputFile;
+};
+
+/**
+ * @class ManifestRunner
+ * @brief Obfuscates every entry of a manifest with long-lived engines
+ */
+class ManifestRunner {
+public:
+    /**
+     * @brief Construct a runner
+     * @param config Obfuscation configuration shared by all entries
+     */
+    explicit ManifestRunner(const ObfuscationConfig& config);
+
+    /**
+     * @brief Read a manifest
+     *
+     * Every non-empty line not starting with '#' holds an input path and,
+     * separated by a tab or spaces, an output path. Without an output path
+     * the binary is written next to the input with an ".obf" suffix.
+     *
+     * @param manifestFile Path to the manifest
+     * @param entries Receives the entries in manifest order
+     * @return false if the manifest cannot be read
+     */
+    static bool parseManifest(const std::string& manifestFile, std::vector<ManifestEntry>& entries);
+
+    /**
+     * @brief Obfuscate all entries of a manifest
+     * @param manifestFile Path to the manifest
+     * @param results Stream receiving one JSON result line per entry
+     * @return true if every entry was obfuscated
+     */
+    bool run(const std::string& manifestFile, std::ostream& results);
+
+    /**
+     * @brief Get number of entries that failed in the last run
+     * @return Failure count
+     */
+    size_t getFailureCount() const { return failures_; }
+
+private:
+    /**
+     * @brief Run the entries through a StagedPipeline instead
+     */
+    bool runPipelined(const std::vector<ManifestEntry>& entries, std::ostream& results);
+
+    /**
+     * @brief Worker loop: claim entries until none are left
+     */
+    void runWorker(const std::vector<ManifestEntry>& entries, std::atomic<size_t>& nextEntry,
+                   std::ostream& results);
+
+    ObfuscationConfig config_;
+    std::mutex resultsMutex_;
+    std::atomic<size_t> failures_;
+};
+
+} // namespace obfuscator
+
+#endif // MANIFEST_RUNNER_H
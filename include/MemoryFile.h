@@ -0,0 +1,62 @@
+/**
+ * @file MemoryFile.h
+ * @brief Anonymous in-memory file for handing data to external tools
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * Backed by memfd_create on Linux, so tools that insist on a path can
+ * read and write through /proc/self/fd/<n> without touching the disk.
+ * Other platforms fall back to a uniquely named temporary file that is
+ * removed when the MemoryFile is destroyed.
+ */
+
+#ifndef MEMORY_FILE_H
+#define MEMORY_FILE_H
+
+#include <string>
+#include <memory>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+
+namespace obfuscator {
+
+class MemoryFile {
+public:
+    /**
+     * @brief Create an empty in-memory file
+     * @param name Debug name (shows up in /proc/<pid>/fd)
+     */
+    explicit MemoryFile(const std::string& name);
+    ~MemoryFile();
+
+    MemoryFile(const MemoryFile&) = delete;
+    MemoryFile& operator=(const MemoryFile&) = delete;
+
+    bool isValid() const { return fd_ >= 0; }
+    int getFD() const { return fd_; }
+
+    /**
+     * @brief Path that other code or child processes can open
+     */
+    const std::string& getPath() const { return path_; }
+
+    /**
+     * @brief Replace the file contents
+     */
+    bool write(llvm::StringRef data);
+
+    /**
+     * @brief Read the whole file back into a memory buffer
+     */
+    std::unique_ptr<llvm::MemoryBuffer> read() const;
+
+private:
+    int fd_;
+    std::string path_;
+    bool isTempFile_;
+};
+
+} // namespace obfuscator
+
+#endif // MEMORY_FILE_H
@@ -0,0 +1,81 @@
+/**
+ * @file MemoryTracker.h
+ * @brief Resident memory, allocation volume and IR size probes
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * Resident and peak resident set sizes come from /proc/self/status; the
+ * peak can be reset through /proc/self/clear_refs so that it covers a
+ * single pass. Allocation volume is counted per thread by the global
+ * operator new replacements in CountingAllocator.cpp, which every IR
+ * object and analysis goes through. Only the phantron executables link
+ * that file; buffers LLVM takes straight from malloc (SmallVector
+ * storage) are not included.
+ */
+
+#ifndef MEMORY_TRACKER_H
+#define MEMORY_TRACKER_H
+
+#include <cstdint>
+#include "llvm/IR/Module.h"
+
+namespace obfuscator {
+
+/**
+ * @struct IRSize
+ * @brief Size of a module's IR
+ */
+struct IRSize {
+    int64_t instructions = 0;
+    int64_t basicBlocks = 0;
+    int64_t functions = 0;  // Definitions
+    int64_t globals = 0;    // Global variables
+
+    /**
+     * @brief Count the IR of a module
+     */
+    static IRSize measure(const llvm::Module& module);
+
+    IRSize& operator+=(const IRSize& other);
+    IRSize operator-(const IRSize& other) const;
+};
+
+/**
+ * @class MemoryTracker
+ * @brief Process memory probes
+ */
+class MemoryTracker {
+public:
+    /**
+     * @brief Bytes requested through operator new by the calling thread so far
+     *
+     * Always 0 unless the program links CountingAllocator.cpp; the library
+     * and the pass plugin leave the host's operator new alone.
+     */
+    static uint64_t getThreadAllocatedBytes();
+
+    /**
+     * @brief Add to the calling thread's allocation count (operator new hook)
+     */
+    static void recordAllocation(uint64_t bytes);
+
+    /**
+     * @brief Current resident set size in bytes (0 if unknown)
+     */
+    static uint64_t getResidentBytes();
+
+    /**
+     * @brief Peak resident set size since start or the last reset, in bytes
+     */
+    static uint64_t getPeakResidentBytes();
+
+    /**
+     * @brief Restart peak tracking at the current resident set size
+     * @return false if the kernel does not support it
+     */
+    static bool resetPeakResident();
+};
+
+} // namespace obfuscator
+
+#endif // MEMORY_TRACKER_H
@@ -11,10 +11,30 @@
 #include <cstdint>
 #include <string>
 #include <map>
+#include <vector>
 #include <chrono>
+#include "PerfCounters.h"
 
 namespace obfuscator {
 
+/**
+ * @struct PassMemoryStats
+ * @brief Memory use and IR growth of one pass in one cycle
+ */
+struct PassMemoryStats {
+    std::string pass;
+    uint32_t cycle = 0;
+    int64_t instructionDelta = 0;
+    int64_t basicBlockDelta = 0;
+    int64_t functionDelta = 0;
+    int64_t globalDelta = 0;
+    uint64_t peakResidentBytes = 0;  // Peak RSS while the pass ran
+    int64_t peakResidentGrowth = 0;  // Peak RSS above the RSS the pass started with
+    int64_t residentDelta = 0;       // RSS after minus before
+    uint64_t allocatedBytes = 0;     // operator new volume of the pass, over all its threads
+    bool batched = false;            // RSS figures are those of the whole parallel batch
+};
+
 /**
  * @struct ObfuscationMetrics
  * @brief Comprehensive metrics for obfuscation process
@@ -53,6 +73,12 @@ struct ObfuscationMetrics {
     uint32_t antiDebugChecksAdded;
     uint32_t fakeLoopsInserted;
 
+    // Result cache
+    uint32_t cacheHits;
+    uint32_t cacheMisses;
+    uint32_t functionCacheHits;
+    uint32_t functionCacheMisses;
+
     // Timing metrics
     std::chrono::milliseconds compilationTime;
     std::chrono::milliseconds obfuscationTime;
@@ -61,7 +87,17 @@ struct ObfuscationMetrics {
 
     // Per-pass metrics
     std::map<std::string, uint32_t> passTransformations;
-    std::map<std::string, std::chrono::milliseconds> passTimings;
+    std::map<std::string, std::chrono::nanoseconds> passTimings;  // Summed over cycles
+
+    // Hardware counter deltas (only with perfCounters enabled)
+    std::map<std::string, PerfCounterValues> passCounters;   // Summed over cycles
+    std::map<std::string, PerfCounterValues> stageCounters;
+
+    // Per pass and cycle memory use (only with memoryProfile enabled)
+    std::vector<PassMemoryStats> passMemory;
+
+    // Pass names in the order the PassScheduler chose
+    std::vector<std::string> passSchedule;
 
     /**
      * @brief Default constructor
@@ -125,9 +161,41 @@ public:
     /**
      * @brief Record timing information
      * @param passName Name of the pass or phase
-     * @param duration Duration in milliseconds
+     * @param duration Duration, added to earlier runs of the same pass
+     */
+    void recordTiming(const std::string& passName, std::chrono::nanoseconds duration);
+
+    /**
+     * @brief Record hardware counter deltas of a pass
+     * @param passName Name of the pass
+     * @param counters Counter deltas, added to earlier runs of the same pass
+     */
+    void recordPassCounters(const std::string& passName, const PerfCounterValues& counters);
+
+    /**
+     * @brief Record hardware counter deltas of a pipeline stage
+     * @param stageName Name of the stage
+     * @param counters Counter deltas
+     */
+    void recordStageCounters(const std::string& stageName, const PerfCounterValues& counters);
+
+    /**
+     * @brief Record memory use and IR growth of one pass run
+     * @param stats Statistics of the run
+     */
+    void recordPassMemory(const PassMemoryStats& stats);
+
+    /**
+     * @brief Record the order passes run in
+     * @param schedule Pass names in run order
+     */
+    void recordPassSchedule(const std::vector<std::string>& schedule);
+
+    /**
+     * @brief Accumulate metrics from another collector (e.g. another translation unit)
+     * @param other Metrics to add into this collector
      */
-    void recordTiming(const std::string& passName, std::chrono::milliseconds duration);
+    void merge(const MetricsCollector& other);
 
     /**
      * @brief Get current metrics
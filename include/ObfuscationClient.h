@@ -0,0 +1,74 @@
+/**
+ * @file ObfuscationClient.h
+ * @brief Thin command-line client of the obfuscation daemon
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * Forwards the command line to a server started with --serve and
+ * reports the result the way a local run would: the summary, the output
+ * path and the exit status. With --send-input the input travels over the
+ * socket and the binary comes back the same way, for servers that do not
+ * share the client's file system.
+ */
+
+#ifndef OBFUSCATION_CLIENT_H
+#define OBFUSCATION_CLIENT_H
+
+#include <string>
+#include <vector>
+
+#include "ObfuscationConfig.h"
+
+namespace obfuscator {
+
+/**
+ * @class ObfuscationClient
+ * @brief Submits jobs and status queries to an ObfuscationServer
+ */
+class ObfuscationClient {
+public:
+    /**
+     * @brief Construct a client
+     * @param socketPath Path of the server's Unix domain socket
+     */
+    explicit ObfuscationClient(const std::string& socketPath);
+
+    /**
+     * @brief Drop client-only options from a command line
+     * @param argc Argument count
+     * @param argv Arguments, argv[0] being the program
+     * @return Arguments the server should parse
+     */
+    static std::vector<std::string> forwardedArguments(int argc, char* argv[]);
+
+    /**
+     * @brief Run a job on the server
+     * @param args Forwarded command-line arguments
+     * @param config Configuration parsed locally (for the summary)
+     * @param inputFile Input file, sent as data if sendInput is set
+     * @param outputFile Output file, written locally if sendInput is set
+     * @param sendInput Send the input bytes instead of its path
+     * @return Process exit status
+     */
+    int obfuscate(const std::vector<std::string>& args, const ObfuscationConfig& config,
+                  const std::string& inputFile, const std::string& outputFile, bool sendInput);
+
+    /**
+     * @brief Print the server's worker count, queue depth and job counts
+     * @return Process exit status
+     */
+    int printStatus();
+
+private:
+    /**
+     * @brief Connect to the server
+     * @return Connected socket, or -1
+     */
+    int connectToServer() const;
+
+    std::string socketPath_;
+};
+
+} // namespace obfuscator
+
+#endif // OBFUSCATION_CLIENT_H
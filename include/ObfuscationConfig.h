@@ -9,6 +9,8 @@
 #define OBFUSCATION_CONFIG_H
 
 #include <string>
+#include <utility>
+#include <vector>
 #include <cstdint>
 
 namespace obfuscator {
@@ -45,6 +47,14 @@ struct ObfuscationConfig {
     uint32_t obfuscationCycles;
     uint32_t seed;
     bool verbose;
+    bool inMemoryPipeline;  // Keep IR/objects in memory, only write the final binary
+    uint32_t jobs;          // Worker threads for multi-file builds (0 = all cores)
+    uint32_t passJobs;      // Threads for function-local passes (1 = serial, 0 = all cores)
+    uint32_t codegenJobs;   // Codegen partitions compiled in parallel (1 = one, 0 = all cores)
+    bool lowMemory;         // Load bodies lazily and obfuscate/compile them in batches
+    uint32_t batchFunctions;  // Functions per batch in low-memory mode
+    bool discardValueNames;   // Drop names of local values when loading IR
+    std::vector<uint32_t> pipelineWorkers;  // Manifest stage workers: compile, obfuscate, codegen, link (empty = off)
 
     // Control flow obfuscation
     bool enableControlFlowFlattening;
@@ -82,10 +92,36 @@ struct ObfuscationConfig {
     bool enableAntiDebug;
     bool enableAntiTamper;
     
+    // Profile-guided obfuscation
+    std::string profileFile;  // llvm-profdata profile; hot blocks get lighter transforms ("" = none)
+    uint32_t hotLoopThreshold;  // Without a profile: spare loop blocks estimated to run this often per call (0 = off)
+    
+    // Per-function policy (see FunctionPolicy.h)
+    std::vector<std::string> functionAllowList;  // Name regexes; if any, only matching functions are obfuscated
+    std::vector<std::string> functionDenyList;   // Name regexes of functions never obfuscated
+    std::vector<std::pair<std::string, std::string>> functionPolicies;  // Name regex -> policy, first match wins
+    std::vector<std::string> protectedRoots;  // Name regexes of sensitive entry points (empty = no region)
+    uint32_t protectedDepth;                  // Call hops from the roots that stay fully obfuscated
+    std::string outsidePolicy;                // Policy of functions neither allowed nor in the region
+    
+    // Link settings
+    std::vector<std::string> linkLibraries;     // Extra libraries (-l<name>)
+    std::vector<std::string> linkObjects;       // Extra runtime objects/archives
+    std::vector<std::string> linkSearchPaths;   // Extra library directories (-L<dir>)
+    
+    // Result cache
+    std::string cacheDirectory;  // Content-addressed result cache ("" = disabled)
+    uint64_t cacheMaxSize;       // Size bound in bytes, least recently used entries go first
+    bool incremental;            // Also reuse obfuscated bodies of unchanged functions
+    
     // Output settings
     std::string reportFormat;  // "json", "html", "both"
     std::string reportPath;
     bool generateMetrics;
+    std::string traceFile;  // Chrome trace-event output ("" = no tracing)
+    bool traceFunctions;    // Also trace every function in parallel passes
+    bool perfCounters;      // Report hardware counters per pass and stage
+    bool memoryProfile;     // Report RSS, allocation volume and IR growth per pass and cycle
 
     /**
      * @brief Default constructor with safe defaults
@@ -103,6 +139,16 @@ struct ObfuscationConfig {
      * @return true if configuration is valid
      */
     bool validate() const;
+
+    /**
+     * @brief Serialize every setting that affects the generated code
+     *
+     * Used as part of result cache keys; settings that only change how the
+     * work is scheduled or reported (threads, logging, reports) are left out.
+     *
+     * @return Canonical text, stable across runs
+     */
+    std::string fingerprint() const;
 };
 
 } // namespace obfuscator
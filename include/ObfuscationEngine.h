@@ -11,15 +11,24 @@
 #ifndef OBFUSCATION_ENGINE_H
 #define OBFUSCATION_ENGINE_H
 
+#include <functional>
 #include <string>
 #include <memory>
 #include <vector>
 
 #include "llvm/IR/Module.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "ObfuscationConfig.h"
 #include "ReportGenerator.h"
 #include "PassManager.h"
+#include "ClangFrontend.h"
+#include "CodeGenerator.h"
+#include "Linker.h"
+#include "ResultCache.h"
+#include "FunctionCache.h"
+#include "PerfCounters.h"
 
 namespace obfuscator {
 
@@ -48,6 +57,54 @@ public:
      */
     bool processFile(const std::string& inputFile, const std::string& outputFile);
 
+    /**
+     * @brief Compile and obfuscate a source file to object code without linking
+     * @param inputFile Path to input source file
+     * @param objectBuffer Buffer receiving the object file bytes
+     * @return true if successful
+     */
+    bool processToObject(const std::string& inputFile, llvm::SmallVectorImpl<char>& objectBuffer);
+
+    /**
+     * @brief Pipeline stage: compile a source file to a module
+     *
+     * The stage methods split processFile() into steps for pipelined
+     * batches. Each step only touches the module and context it is given,
+     * so consecutive steps of one file may run on different engines and
+     * threads. The result cache is not consulted.
+     *
+     * @param inputFile Path to input source file
+     * @param context Context owned by the caller, one per file
+     * @return Module, or nullptr on failure
+     */
+    std::unique_ptr<llvm::Module> compileStage(const std::string& inputFile,
+                                               llvm::LLVMContext& context);
+
+    /**
+     * @brief Pipeline stage: obfuscate a module
+     * @param module Module from compileStage()
+     * @return Metrics of the obfuscation, or nullptr on failure
+     */
+    std::shared_ptr<MetricsCollector> obfuscateStage(llvm::Module& module);
+
+    /**
+     * @brief Pipeline stage: compile an obfuscated module to an in-memory object
+     * @param module Module from obfuscateStage()
+     * @param objectBuffer Buffer receiving the object file bytes
+     * @return true if compilation successful
+     */
+    bool codegenStage(llvm::Module& module, llvm::SmallVectorImpl<char>& objectBuffer);
+
+    /**
+     * @brief Pipeline stage: link an object to the final binary
+     * @param objectData Object from codegenStage()
+     * @param outputFile Path to output binary
+     * @param inputFile Path to original input file (for detecting C++ files)
+     * @return true if linking successful
+     */
+    bool linkStage(llvm::StringRef objectData, const std::string& outputFile,
+                   const std::string& inputFile);
+
     /**
      * @brief Get the report generator for metrics collection
      * @return Shared pointer to report generator
@@ -56,19 +113,62 @@ public:
 
 private:
     /**
-     * @brief Compile source file to LLVM IR
+     * @brief Compile source file to an LLVM module in the engine's context
+     *
+     * Uses the in-process clang frontend when it is linked in, and falls
+     * back to a clang subprocess plus a temporary bitcode file otherwise.
+     *
+     * @param sourceFile Path to source file
+     * @param context Context the module is created in
+     * @return Compiled module, or nullptr on failure
+     */
+    std::unique_ptr<llvm::Module> compileToIR(const std::string& sourceFile,
+                                              llvm::LLVMContext& context);
+
+    /**
+     * @brief Compile source file with an external clang through a bitcode file
+     * @param sourceFile Path to source file
+     * @param context LLVM context
+     * @return LLVM module, or nullptr on failure
+     */
+    std::unique_ptr<llvm::Module> compileToIRThroughFile(const std::string& sourceFile,
+                                                         llvm::LLVMContext& context);
+
+    /**
+     * @brief Compile source file to a bitcode file with an external clang
      * @param sourceFile Path to source file
      * @param irFile Path to output IR file
      * @return true if compilation successful
      */
-    bool compileToIR(const std::string& sourceFile, const std::string& irFile);
+    bool compileToIRFile(const std::string& sourceFile, const std::string& irFile);
 
     /**
-     * @brief Load LLVM IR module from file
+     * @brief Compile source file to bitcode held in memory with an external clang
+     * @param sourceFile Path to source file
+     * @return Bitcode buffer, or nullptr on failure
+     */
+    std::unique_ptr<llvm::MemoryBuffer> compileToIRBuffer(const std::string& sourceFile);
+
+    /**
+     * @brief Load LLVM IR module from an in-memory buffer
+     *
+     * In low-memory mode function bodies are only read when materialized,
+     * so the module keeps the buffer.
+     *
+     * @param buffer Bitcode or textual IR
+     * @param context Context the module is created in
+     * @return Unique pointer to loaded module
+     */
+    std::unique_ptr<llvm::Module> loadModule(std::unique_ptr<llvm::MemoryBuffer> buffer,
+                                             llvm::LLVMContext& context);
+
+    /**
+     * @brief Load LLVM IR module from file, lazily in low-memory mode
      * @param irFile Path to IR file
+     * @param context Context the module is created in
      * @return Unique pointer to loaded module
      */
-    std::unique_ptr<llvm::Module> loadModule(const std::string& irFile);
+    std::unique_ptr<llvm::Module> loadModule(const std::string& irFile, llvm::LLVMContext& context);
 
     /**
      * @brief Apply obfuscation passes to module
@@ -85,6 +185,50 @@ private:
      */
     bool compileToObject(llvm::Module& module, const std::string& objectFile);
 
+    /**
+     * @brief Compile obfuscated IR to an in-memory object
+     * @param module Obfuscated LLVM module
+     * @param objectBuffer Buffer receiving the object file bytes
+     * @return true if compilation successful
+     */
+    bool compileToObject(llvm::Module& module, llvm::SmallVectorImpl<char>& objectBuffer);
+
+    /**
+     * @brief Compile partitions of a module in parallel and combine their objects
+     * @param module Obfuscated LLVM module
+     * @param partitions Number of partitions
+     * @param combine Links the partition objects, given as paths, into one object
+     * @return true if compilation successful
+     */
+    bool compilePartitions(llvm::Module& module, uint32_t partitions,
+                           const std::function<bool(const std::vector<std::string>&)>& combine);
+
+    /**
+     * @brief Obfuscate and compile a lazily loaded module a batch of functions at a time
+     * @param module Unobfuscated module, left without function bodies
+     * @param objectFile Path to the combined relocatable object
+     * @return true if compilation successful
+     */
+    bool compileInBatches(llvm::Module& module, const std::string& objectFile);
+
+    /**
+     * @brief Obfuscate and compile a module in batches to an in-memory object
+     * @param module Unobfuscated module, left without function bodies
+     * @param objectBuffer Buffer receiving the object file bytes
+     * @return true if compilation successful
+     */
+    bool compileInBatches(llvm::Module& module, llvm::SmallVectorImpl<char>& objectBuffer);
+
+    /**
+     * @brief Load a module that cannot be compiled in batches and obfuscate it whole
+     */
+    bool obfuscateWhole(llvm::Module& module);
+
+    /**
+     * @brief Give the report a fresh collector for the batch pipeline
+     */
+    MetricsCollector& startBatchMetrics();
+
     /**
      * @brief Link object file to final binary
      * @param objectFile Path to object file
@@ -94,10 +238,49 @@ private:
      */
     bool linkToBinary(const std::string& objectFile, const std::string& binaryFile, const std::string& inputFile);
 
+    /**
+     * @brief Link in-memory object data to final binary
+     * @param objectData Object file bytes
+     * @param binaryFile Path to output binary
+     * @param inputFile Path to original input file (for detecting C++ files)
+     * @return true if linking successful
+     */
+    bool linkToBinary(llvm::StringRef objectData, const std::string& binaryFile, const std::string& inputFile);
+
+    /**
+     * @brief Compute the result cache key of a module before obfuscation
+     * @param module Unobfuscated module
+     * @param kind "object" or "binary"
+     * @param inputFile Original input (binaries depend on the link driver it selects)
+     * @return Cache key
+     */
+    std::string computeCacheKey(const llvm::Module& module, llvm::StringRef kind,
+                                const std::string& inputFile) const;
+
+    /**
+     * @brief Write a cached binary to the output path
+     * @param binary Cached binary
+     * @param binaryFile Path to output binary
+     * @return true if the binary was written
+     */
+    bool writeCachedBinary(const llvm::MemoryBuffer& binary, const std::string& binaryFile);
+
+    /**
+     * @brief Read this thread's hardware counters if they are enabled
+     * @return Readings, or an empty set when perfCounters is off
+     */
+    PerfCounterValues readCounters() const;
+
     ObfuscationConfig config_;
     std::unique_ptr<llvm::LLVMContext> context_;
     std::unique_ptr<PassManager> passManager_;
+    std::unique_ptr<ClangFrontend> frontend_;
+    std::vector<std::string> frontendArgs_;  // Extra clang arguments, e.g. the profile
+    std::unique_ptr<CodeGenerator> codeGenerator_;
+    std::unique_ptr<Linker> linker_;
     std::shared_ptr<ReportGenerator> reportGenerator_;
+    std::unique_ptr<ResultCache> cache_;
+    std::unique_ptr<FunctionCache> functionCache_;
 };
 
 } // namespace obfuscator
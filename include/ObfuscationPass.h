@@ -12,6 +12,8 @@
 #include "llvm/IR/Function.h"
 #include "llvm/IR/PassManager.h"
 #include "llvm/Pass.h"
+#include "RandomStream.h"
+#include "BlockHotness.h"
 #include <string>
 #include <cstdint>
 
@@ -19,6 +21,36 @@ namespace obfuscator {
 
 class MetricsCollector;
 
+/**
+ * @brief Properties of the IR that passes rewrite, destroy or add to (bit set)
+ */
+enum IRProperty : uint32_t {
+    IR_INSTRUCTIONS = 1u << 0,       ///< Instructions of any kind
+    IR_ARITHMETIC = 1u << 1,         ///< Integer binary operators
+    IR_CONSTANT_OPERANDS = 1u << 2,  ///< Integer constants used directly as operands
+    IR_BASIC_BLOCKS = 1u << 3,       ///< Blocks and the branches between them
+    IR_STRUCTURED_CFG = 1u << 4,     ///< Control flow not yet routed through a dispatcher
+    IR_DIRECT_CALLS = 1u << 5,       ///< Calls to known functions
+    IR_PLAIN_STRINGS = 1u << 6,      ///< String literals stored in the clear
+    IR_RUNTIME_HELPERS = 1u << 7,    ///< Functions added by passes
+};
+
+/// Properties every input module is assumed to have
+constexpr uint32_t IR_INPUT_PROPERTIES = IR_INSTRUCTIONS | IR_ARITHMETIC | IR_CONSTANT_OPERANDS |
+                                         IR_BASIC_BLOCKS | IR_STRUCTURED_CFG | IR_DIRECT_CALLS |
+                                         IR_PLAIN_STRINGS;
+
+/**
+ * @struct PassTraits
+ * @brief What a pass needs from the IR and what it does to it, for scheduling
+ */
+struct PassTraits {
+    uint32_t required = 0;     ///< Properties the pass rewrites; it must run while they hold
+    uint32_t invalidated = 0;  ///< Properties that no longer hold after the pass
+    uint32_t produced = 0;     ///< Properties the pass adds new instances of
+    uint32_t growth = 0;       ///< Estimated growth of the IR it rewrites, in percent
+};
+
 /**
  * @class ObfuscationPass
  * @brief Abstract base class for obfuscation transformations
@@ -45,6 +77,20 @@ public:
      */
     virtual bool runOnModule(llvm::Module& module, MetricsCollector& metrics) = 0;
 
+    /**
+     * @brief Run the pass through a new-PM ModulePassManager
+     *
+     * Analyses cached in the manager stay valid across passes until a pass
+     * invalidates them. Module passes invalidate everything when they
+     * change the module; function passes only the functions they change.
+     * @param module LLVM module to transform
+     * @param metrics Metrics collector for reporting
+     * @param analyses Module analysis manager, with the function proxies registered
+     * @return true if transformations were made
+     */
+    virtual bool run(llvm::Module& module, MetricsCollector& metrics,
+                     llvm::ModuleAnalysisManager& analyses);
+
     /**
      * @brief Get pass name
      * @return Pass name string
@@ -69,10 +115,72 @@ public:
      */
     void setSeed(uint32_t seed) { seed_ = seed; }
 
+    /**
+     * @brief Set the obfuscation cycle the next run belongs to
+     * @param cycle Cycle index (part of every derived random stream)
+     */
+    void setCycle(uint32_t cycle) { cycle_ = cycle; }
+
+    /**
+     * @brief Estimate hotness statically when the module has no profile
+     * @param threshold Relative block frequency from which loop blocks are spared (0 = off)
+     */
+    void setHotLoopThreshold(uint32_t threshold) { hotLoopThreshold_ = threshold; }
+
+    /**
+     * @brief Restrict a function-local pass to functions a policy gave a level
+     * @param level Level name from FunctionPolicy, empty for the configured level
+     */
+    void setPolicyLevel(const std::string& level) { policyLevel_ = level; }
+
+    /**
+     * @brief Level set by setPolicyLevel, empty for the configured level
+     */
+    const std::string& getPolicyLevel() const { return policyLevel_; }
+
+    /**
+     * @brief Whether the pass only transforms one function at a time
+     *
+     * Function-local passes may run concurrently on separate modules, so
+     * they must not keep mutable state between runOnModule calls.
+     * @return true if the pass can run on module shards in parallel
+     */
+    virtual bool isFunctionLocal() const { return false; }
+
+    /**
+     * @brief Declared inputs and effects, used by the PassScheduler
+     *
+     * A pass that does not override this has no constraints and runs in
+     * registration order relative to other unconstrained passes.
+     * @return Traits of the pass with its current settings
+     */
+    virtual PassTraits getTraits() const { return PassTraits(); }
+
 protected:
     std::string name_;
     bool enabled_;
     uint32_t seed_;
+    uint32_t cycle_;
+    uint32_t hotLoopThreshold_;
+    std::string policyLevel_;
+
+    /**
+     * @brief Random stream for one function in the current cycle
+     * @param func Function being transformed
+     * @return Stream that depends only on seed, cycle, pass and function name
+     */
+    RandomStream getRandomStream(const llvm::Function& func) const {
+        return getRandomStream(func.getName());
+    }
+
+    /**
+     * @brief Random stream for a named entity (e.g. a global) in the current cycle
+     * @param entity Entity name
+     * @return Stream that depends only on seed, cycle, pass and entity name
+     */
+    RandomStream getRandomStream(llvm::StringRef entity) const {
+        return RandomStream::derive(seed_, cycle_, name_, entity);
+    }
 
     /**
      * @brief Check if a function should be obfuscated
@@ -82,6 +190,68 @@ protected:
     bool shouldObfuscateFunction(llvm::Function& func) const;
 };
 
+/**
+ * @class FunctionObfuscationPass
+ * @brief Base class for passes that transform one function at a time
+ *
+ * The pass runs as a new-PM function pass over every definition, so
+ * runOnFunction can ask the FunctionAnalysisManager for DominatorTree,
+ * LoopInfo or BlockFrequencyInfo and gets them cached. Functions the pass
+ * transformed are marked with "obfuscated.<name>" metadata and skipped in
+ * later cycles.
+ */
+class FunctionObfuscationPass : public ObfuscationPass {
+public:
+    using ObfuscationPass::ObfuscationPass;
+
+    /**
+     * @brief Run the pass with analysis managers of its own
+     */
+    bool runOnModule(llvm::Module& module, MetricsCollector& metrics) override;
+
+    bool run(llvm::Module& module, MetricsCollector& metrics,
+             llvm::ModuleAnalysisManager& analyses) override;
+
+    bool isFunctionLocal() const override { return true; }
+
+    /**
+     * @brief Transform a function unless it is excluded or was transformed before
+     * @param func Function to transform
+     * @param analyses Analysis manager of the function
+     * @return Number of transformations made
+     */
+    uint32_t obfuscateFunction(llvm::Function& func, llvm::FunctionAnalysisManager& analyses);
+
+    /**
+     * @brief Whether the pass leaves the blocks and edges of every function intact
+     */
+    bool preservesCFG() const;
+
+protected:
+    /**
+     * @brief Transform one function
+     * @param func Function to transform, already checked by shouldObfuscateFunction
+     * @param analyses Analysis manager of the function
+     * @return Number of transformations made
+     */
+    virtual uint32_t runOnFunction(llvm::Function& func,
+                                   llvm::FunctionAnalysisManager& analyses) = 0;
+
+    /**
+     * @brief Rate how strongly each block of a function may be obfuscated
+     *
+     * Call before transforming, blocks added later are rated at full intensity.
+     */
+    BlockHotness getHotness(llvm::Function& func, llvm::FunctionAnalysisManager& analyses) const {
+        return BlockHotness(func, analyses, hotLoopThreshold_);
+    }
+
+    /**
+     * @brief Add the transformations of one run over a module to the metrics
+     */
+    virtual void recordTransformations(MetricsCollector& metrics, uint32_t count) const;
+};
+
 } // namespace obfuscator
 
 #endif // OBFUSCATION_PASS_H
@@ -0,0 +1,130 @@
+/**
+ * @file ObfuscationServer.h
+ * @brief Long-running obfuscation daemon on a Unix domain socket
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * Keeps LLVM initialized and a few warm ObfuscationEngines (with their
+ * pass objects, target machines and result caches) per worker thread, so
+ * repeated jobs from IDEs or CI skip process start-up. Each connection
+ * carries one request in the ServerMessage format: either a status query
+ * or an obfuscation job made of the client's command-line arguments, its
+ * working directory and, optionally, the input bytes. Each request is
+ * read on a thread of its own under one overall deadline; jobs then wait
+ * in a queue for the next free worker.
+ */
+
+#ifndef OBFUSCATION_SERVER_H
+#define OBFUSCATION_SERVER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "ObfuscationConfig.h"
+#include "ObfuscationEngine.h"
+#include "ServerProtocol.h"
+
+namespace obfuscator {
+
+/**
+ * @class ObfuscationServer
+ * @brief Serves obfuscation jobs from a pool of warm workers
+ */
+class ObfuscationServer {
+public:
+    /**
+     * @brief Construct a server
+     * @param config Server settings (jobs = worker count, 0 = all cores)
+     */
+    explicit ObfuscationServer(const ObfuscationConfig& config);
+
+    ~ObfuscationServer();
+
+    /**
+     * @brief Listen on a socket and serve until requestStop() is called
+     *
+     * Queued jobs are finished before the call returns, and the socket
+     * file is removed.
+     *
+     * @param socketPath Path of the Unix domain socket
+     * @return false if the socket could not be set up
+     */
+    bool run(const std::string& socketPath);
+
+    /**
+     * @brief Ask running servers to shut down (async-signal-safe)
+     */
+    static void requestStop();
+
+    /**
+     * @brief Get number of jobs waiting for a worker
+     * @return Queue depth
+     */
+    size_t getQueueDepth() const;
+
+private:
+    /**
+     * @struct Job
+     * @brief Accepted connection with its request
+     */
+    struct Job {
+        int fd;
+        ServerMessage request;
+        size_t queueDepth;
+    };
+
+    /**
+     * @brief Engines a worker keeps warm, most recently used first
+     */
+    using EngineCache = std::list<std::pair<std::string, std::unique_ptr<ObfuscationEngine>>>;
+
+    /**
+     * @brief Worker loop: take jobs until the server stops and the queue is empty
+     */
+    void runWorker();
+
+    /**
+     * @brief Read a request and answer or queue it (runs on its own thread)
+     *
+     * The whole request must arrive within one deadline. Status queries
+     * are answered right here rather than waiting for a worker.
+     */
+    void readRequest(int fd);
+
+    /**
+     * @brief Run one obfuscation job
+     * @param job Job to run
+     * @param engines Calling worker's engines
+     * @return Response to send back
+     */
+    ServerMessage processJob(const Job& job, EngineCache& engines);
+
+    /**
+     * @brief Describe the server load
+     */
+    ServerMessage makeStatus() const;
+
+    ObfuscationConfig config_;
+    uint32_t workerCount_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable available_;
+    std::deque<Job> queue_;
+    bool draining_;
+    std::condition_variable readersDone_;
+    size_t readers_;  // Connections whose request is still being read
+
+    std::atomic<size_t> activeJobs_;
+    std::atomic<size_t> completedJobs_;
+    std::atomic<size_t> failedJobs_;
+};
+
+} // namespace obfuscator
+
+#endif // OBFUSCATION_SERVER_H
@@ -0,0 +1,115 @@
+/**
+ * @file ParallelPassRunner.h
+ * @brief Function-parallel execution of function-local obfuscation passes
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * An LLVMContext cannot be mutated from several threads, so the module is
+ * split into shards of whole functions, each shard is moved into a private
+ * context through bitcode and transformed on a worker thread, and the
+ * results are linked back serially through a FunctionTransplant. The link
+ * is the commit phase: new declarations, intrinsics and globals created by
+ * passes enter the main module there, all at once, after the shards were
+ * merged in a fixed order.
+ */
+
+#ifndef PARALLEL_PASS_RUNNER_H
+#define PARALLEL_PASS_RUNNER_H
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "llvm/IR/Module.h"
+#include "ObfuscationPass.h"
+#include "MetricsCollector.h"
+#include "PerfCounters.h"
+#include "MemoryTracker.h"
+#include "WorkStealingPool.h"
+
+namespace obfuscator {
+
+/**
+ * @struct PassOutcome
+ * @brief Aggregated result of one pass over all shards
+ */
+struct PassOutcome {
+    bool modified = false;
+    std::chrono::nanoseconds cpuTime{0};  ///< Summed over all shards
+    PerfCounterValues counters;           ///< Summed over all shards (if counted)
+    IRSize irDelta;                       ///< Summed over all shards (if measured)
+    uint64_t allocatedBytes = 0;          ///< Summed over all shards (if measured)
+};
+
+/**
+ * @class ParallelPassRunner
+ * @brief Runs a batch of function-local passes over module shards in parallel
+ */
+class ParallelPassRunner {
+public:
+    /**
+     * @brief Construct a runner and start its thread pool
+     * @param threadCount Worker threads (0 = all cores)
+     * @param countEvents Read each worker's hardware counters around every pass
+     * @param measureMemory Measure IR growth and allocations of every pass
+     */
+    explicit ParallelPassRunner(uint32_t threadCount, bool countEvents = false,
+                                bool measureMemory = false);
+
+    /**
+     * @brief Check whether a module can be split into shards
+     * @param module Module to inspect
+     * @return false for modules with debug info, ifuncs or unnamed local symbols
+     */
+    static bool canShard(const llvm::Module& module);
+
+    /**
+     * @brief Run passes over all function definitions in parallel
+     * @param module Module to transform in place
+     * @param passes Function-local passes, applied in order to each shard
+     * @param metrics Metrics collector receiving the merged shard metrics
+     * @param outcomes Per-pass results (same order as passes)
+     * @return false if the module was left untouched (caller should run serially)
+     */
+    bool run(llvm::Module& module, const std::vector<ObfuscationPass*>& passes,
+             MetricsCollector& metrics, std::vector<PassOutcome>& outcomes);
+
+    /**
+     * @brief Get number of worker threads
+     * @return Thread count
+     */
+    uint32_t getThreadCount() const { return pool_.getThreadCount(); }
+
+private:
+    /**
+     * @struct Shard
+     * @brief A group of functions transformed together in one context
+     */
+    struct Shard {
+        std::vector<llvm::Function*> functions;
+        uint64_t instructionCount = 0;
+        llvm::SmallVector<char, 0> bitcode;
+        MetricsCollector metrics;
+        std::vector<PassOutcome> outcomes;
+        bool success = false;
+    };
+
+    /**
+     * @brief Partition function definitions into size-balanced shards
+     */
+    std::vector<std::unique_ptr<Shard>> partition(llvm::Module& module) const;
+
+    /**
+     * @brief Transform one shard in a private LLVMContext
+     */
+    void runShard(Shard& shard, const std::vector<ObfuscationPass*>& passes) const;
+
+    WorkStealingPool pool_;
+    bool countEvents_;
+    bool measureMemory_;
+};
+
+} // namespace obfuscator
+
+#endif // PARALLEL_PASS_RUNNER_H
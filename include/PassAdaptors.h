@@ -0,0 +1,110 @@
+/**
+ * @file PassAdaptors.h
+ * @brief New pass manager adaptors for obfuscation passes
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * Every obfuscation pass runs inside an llvm::ModulePassManager: module
+ * passes through a ModulePassAdaptor, function-local passes through a
+ * FunctionPassAdaptor nested in a module-to-function adaptor. Analyses are
+ * then cached by the analysis managers across passes and invalidated by
+ * the PreservedAnalyses each pass returns.
+ */
+
+#ifndef PASS_ADAPTORS_H
+#define PASS_ADAPTORS_H
+
+#include <cstdint>
+#include "llvm/IR/PassManager.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "ObfuscationPass.h"
+
+namespace obfuscator {
+
+class MetricsCollector;
+
+/**
+ * @class AnalysisManagers
+ * @brief Loop, function, CGSCC and module analysis managers wired together
+ *
+ * Holds cached analyses for one module. Results refer to the IR by
+ * address, so the managers must not outlive the module, and must be
+ * cleared when functions are replaced behind their back.
+ */
+class AnalysisManagers {
+public:
+    /**
+     * @brief Register LLVM's analyses and the proxies between the managers
+     */
+    AnalysisManagers();
+
+    AnalysisManagers(const AnalysisManagers&) = delete;
+    AnalysisManagers& operator=(const AnalysisManagers&) = delete;
+
+    llvm::ModuleAnalysisManager& getModuleManager() { return moduleManager_; }
+    llvm::FunctionAnalysisManager& getFunctionManager() { return functionManager_; }
+
+    /**
+     * @brief Drop every cached result
+     */
+    void clear();
+
+private:
+    // The registered analysis factories may refer to the builder
+    llvm::PassBuilder builder_;
+    llvm::LoopAnalysisManager loopManager_;
+    llvm::FunctionAnalysisManager functionManager_;
+    llvm::CGSCCAnalysisManager cgsccManager_;
+    llvm::ModuleAnalysisManager moduleManager_;
+};
+
+/**
+ * @class FunctionPassAdaptor
+ * @brief Runs a FunctionObfuscationPass as a new-PM function pass
+ */
+class FunctionPassAdaptor : public llvm::PassInfoMixin<FunctionPassAdaptor> {
+public:
+    /**
+     * @param pass Pass to run
+     * @param transformations Counter the transformations of every function are added to
+     */
+    FunctionPassAdaptor(FunctionObfuscationPass& pass, uint32_t& transformations)
+        : pass_(&pass), transformations_(&transformations) {}
+
+    llvm::PreservedAnalyses run(llvm::Function& func, llvm::FunctionAnalysisManager& analyses);
+
+    // Obfuscation must not be skipped for optnone functions
+    static bool isRequired() { return true; }
+
+private:
+    FunctionObfuscationPass* pass_;
+    uint32_t* transformations_;
+};
+
+/**
+ * @class ModulePassAdaptor
+ * @brief Runs an ObfuscationPass's runOnModule as a new-PM module pass
+ */
+class ModulePassAdaptor : public llvm::PassInfoMixin<ModulePassAdaptor> {
+public:
+    /**
+     * @param pass Pass to run
+     * @param metrics Metrics collector handed to the pass
+     * @param modified Set to whether the pass changed the module
+     */
+    ModulePassAdaptor(ObfuscationPass& pass, MetricsCollector& metrics, bool& modified)
+        : pass_(&pass), metrics_(&metrics), modified_(&modified) {}
+
+    llvm::PreservedAnalyses run(llvm::Module& module, llvm::ModuleAnalysisManager& analyses);
+
+    static bool isRequired() { return true; }
+
+private:
+    ObfuscationPass* pass_;
+    MetricsCollector* metrics_;
+    bool* modified_;
+};
+
+} // namespace obfuscator
+
+#endif // PASS_ADAPTORS_H
@@ -9,11 +9,14 @@
 #define PASS_MANAGER_H
 
 #include <memory>
+#include <string>
 #include <vector>
 #include "llvm/IR/Module.h"
 #include "ObfuscationPass.h"
 #include "ObfuscationConfig.h"
 #include "MetricsCollector.h"
+#include "ParallelPassRunner.h"
+#include "PassAdaptors.h"
 
 namespace obfuscator {
 
@@ -36,17 +39,30 @@ public:
 
     /**
      * @brief Add an obfuscation pass to the pipeline
+     *
+     * The run order is recomputed from all passes' traits before the next run.
      * @param pass Unique pointer to obfuscation pass
      */
     void addPass(std::unique_ptr<ObfuscationPass> pass);
 
+    /**
+     * @brief Resolve the function policies of a module, before its first cycle
+     *
+     * Tags the functions with their policies (FunctionPolicy::resolve) and
+     * adds the function-local passes of levels other than the configured
+     * one, so functions given such a level get that preset's passes.
+     * @param module Whole module; shards and batches made from it keep the tags
+     */
+    void resolvePolicies(llvm::Module& module);
+
     /**
      * @brief Run all passes on a module
      * @param module LLVM module to transform
      * @param metrics Metrics collector for reporting
+     * @param cycle Obfuscation cycle index, mixed into every random stream
      * @return true if any transformations were made
      */
-    bool runPasses(llvm::Module& module, MetricsCollector& metrics);
+    bool runPasses(llvm::Module& module, MetricsCollector& metrics, uint32_t cycle = 0);
 
     /**
      * @brief Get number of registered passes
@@ -54,6 +70,11 @@ public:
      */
     size_t getPassCount() const { return passes_.size(); }
 
+    /**
+     * @brief Get the names of the registered passes in run order
+     */
+    const std::vector<std::string>& getSchedule();
+
     /**
      * @brief Clear all registered passes
      */
@@ -65,8 +86,38 @@ private:
      */
     void initializePasses();
 
+    /**
+     * @brief Add the passes a configuration enables
+     * @param config Configuration whose switches and settings to use
+     * @param policyLevel Level the passes are restricted to, empty for the configured level;
+     *                    with a level, only function-local passes are added
+     */
+    void addConfiguredPasses(const ObfuscationConfig& config, const std::string& policyLevel);
+
+    /**
+     * @brief Reorder the passes with the PassScheduler
+     */
+    void schedulePasses();
+
+    /**
+     * @brief Run a single pass over the whole module, timing it
+     */
+    bool runPass(ObfuscationPass& pass, llvm::Module& module, MetricsCollector& metrics,
+                 uint32_t cycle, AnalysisManagers& analyses);
+
+    /**
+     * @brief Run consecutive function-local passes across the thread pool
+     */
+    bool runFunctionLocalPasses(const std::vector<ObfuscationPass*>& batch,
+                                llvm::Module& module, MetricsCollector& metrics, uint32_t cycle,
+                                AnalysisManagers& analyses);
+
     ObfuscationConfig config_;
-    std::vector<std::unique_ptr<ObfuscationPass>> passes_;
+    std::vector<std::unique_ptr<ObfuscationPass>> passes_;  // In run order once scheduled
+    std::vector<std::string> schedule_;
+    std::vector<std::string> policyLevels_;  // Levels whose passes were added for function policies
+    bool scheduled_ = false;
+    std::unique_ptr<ParallelPassRunner> parallelRunner_;  // Null when passes run serially
 };
 
 } // namespace obfuscator
@@ -0,0 +1,67 @@
+/**
+ * @file PassScheduler.h
+ * @brief Orders obfuscation passes by their declared traits
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * Every pass declares the IR properties it rewrites, destroys and adds to
+ * (PassTraits). Two kinds of constraints follow from that:
+ *
+ *  - Hard: a pass that needs a property runs before any pass that destroys
+ *    it, and after some pass that produces it if the input lacks it.
+ *  - Soft: a pass that rewrites a property prefers to run before passes
+ *    that add more of it, otherwise it also rewrites their output. Each
+ *    such preference weighs the rewriting pass's growth.
+ *
+ * Function-local passes restricted to different policy levels
+ * (FunctionPolicy) transform disjoint functions and constrain each other
+ * in neither way.
+ *
+ * The schedule is built greedily: of the passes whose hard predecessors
+ * are done, the one that leaves the least weight of soft preferences
+ * unmet goes next. Ties keep function-local passes together, so the
+ * parallel runner splits the module fewer times, and then fall back to
+ * registration order, which makes the schedule deterministic.
+ */
+
+#ifndef PASS_SCHEDULER_H
+#define PASS_SCHEDULER_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include "ObfuscationPass.h"
+
+namespace obfuscator {
+
+/**
+ * @class PassScheduler
+ * @brief Computes a run order for a set of passes
+ */
+class PassScheduler {
+public:
+    /**
+     * @brief Order the passes
+     * @param passes Passes in registration order
+     * @return Indices into passes, in run order
+     */
+    std::vector<size_t> schedule(const std::vector<const ObfuscationPass*>& passes);
+
+    /**
+     * @brief Constraints that decided the last schedule, one line each
+     */
+    const std::vector<std::string>& getDecisions() const { return decisions_; }
+
+    /**
+     * @brief Whether the last schedule had to break a cycle of hard constraints
+     */
+    bool hadConflict() const { return conflict_; }
+
+private:
+    std::vector<std::string> decisions_;
+    bool conflict_ = false;
+};
+
+} // namespace obfuscator
+
+#endif // PASS_SCHEDULER_H
@@ -0,0 +1,83 @@
+/**
+ * @file PerfCounters.h
+ * @brief Hardware performance counters of the calling thread
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * Counts cycles, retired instructions, last-level cache misses and branch
+ * misses through perf_event_open. Counters are per thread and user space
+ * only, so they work under the default perf_event_paranoid setting and
+ * measure exactly the code between two reads on that thread. Counters the
+ * kernel or the hardware refuses (containers, VMs without a PMU, other
+ * platforms) are reported as unavailable instead of failing the run.
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <array>
+#include <cstdint>
+
+namespace obfuscator {
+
+/**
+ * @struct PerfCounterValues
+ * @brief A set of counter readings, or the difference of two
+ */
+struct PerfCounterValues {
+    enum Counter { CYCLES = 0, INSTRUCTIONS, CACHE_MISSES, BRANCH_MISSES, COUNTER_COUNT };
+
+    std::array<uint64_t, COUNTER_COUNT> counts{};
+    uint32_t available = 0;  // Bit per Counter that could be read
+
+    bool has(Counter counter) const { return (available >> counter) & 1; }
+
+    /**
+     * @brief Instructions per cycle, 0 without both counters
+     */
+    double getIPC() const;
+
+    /**
+     * @brief Name of a counter as used in reports
+     */
+    static const char* getCounterName(Counter counter);
+
+    PerfCounterValues& operator+=(const PerfCounterValues& other);
+    PerfCounterValues operator-(const PerfCounterValues& earlier) const;
+};
+
+/**
+ * @class PerfCounters
+ * @brief The calling thread's counters, opened on first use
+ */
+class PerfCounters {
+public:
+    /**
+     * @brief Get the counters of the calling thread
+     */
+    static PerfCounters& forThread();
+
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /**
+     * @brief Read all counters, scaled for multiplexing
+     */
+    PerfCounterValues read() const;
+
+    /**
+     * @brief Check whether any counter could be opened
+     */
+    bool isAvailable() const;
+
+private:
+    PerfCounters();
+
+    std::array<int, PerfCounterValues::COUNTER_COUNT> fds_;
+};
+
+} // namespace obfuscator
+
+#endif // PERF_COUNTERS_H
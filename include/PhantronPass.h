@@ -0,0 +1,65 @@
+/**
+ * @file PhantronPass.h
+ * @brief Obfuscation as a pass of a regular LLVM optimization pipeline
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * The phantron pass plugin (libphantron.so) adds PhantronPass at the end of
+ * the optimization pipeline of clang or opt, so sources are obfuscated
+ * while they are compiled instead of in a separate IR round trip.
+ *
+ * Settings are taken, in increasing priority, from the medium preset,
+ * -phantron-level, the YAML file named by PHANTRON_CONFIG, the YAML file
+ * given with -phantron-config, and the remaining -phantron-* options.
+ */
+
+#ifndef PHANTRON_PASS_H
+#define PHANTRON_PASS_H
+
+#include <memory>
+#include "llvm/IR/PassManager.h"
+#include "llvm/Passes/PassBuilder.h"
+#include "ObfuscationConfig.h"
+
+namespace obfuscator {
+
+class PassManager;
+
+/**
+ * @class PhantronPass
+ * @brief Runs every obfuscation cycle of a configuration on a module
+ */
+class PhantronPass : public llvm::PassInfoMixin<PhantronPass> {
+public:
+    explicit PhantronPass(const ObfuscationConfig& config);
+    PhantronPass(PhantronPass&&);
+    ~PhantronPass();
+
+    llvm::PreservedAnalyses run(llvm::Module& module, llvm::ModuleAnalysisManager& analyses);
+
+    // Obfuscation must not be skipped for optnone functions or at -O0
+    static bool isRequired() { return true; }
+
+private:
+    ObfuscationConfig config_;
+    std::unique_ptr<PassManager> passManager_;
+};
+
+/**
+ * @brief Build the configuration from the -phantron-* options and PHANTRON_CONFIG
+ * @return false if a configuration file cannot be read or is invalid
+ */
+bool loadPluginConfig(ObfuscationConfig& config);
+
+/**
+ * @brief Add PhantronPass to a PassBuilder's pipelines
+ *
+ * Runs at the OptimizerLast extension point, after the optimizations that
+ * would otherwise simplify the obfuscated code away, and is available as
+ * "phantron" in textual pipelines (opt -passes=phantron).
+ */
+void registerPhantronPass(llvm::PassBuilder& builder);
+
+} // namespace obfuscator
+
+#endif // PHANTRON_PASS_H
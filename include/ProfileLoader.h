@@ -0,0 +1,39 @@
+/**
+ * @file ProfileLoader.h
+ * @brief Attaching llvm-profdata profiles to compiled modules
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * Profile counts are matched against the code by clang while it compiles
+ * the sources (-O1, like every compile of the pipeline), so a profile is
+ * applied by extending the frontend arguments. Suitable profiles come from
+ * a -O1 build with -fprofile-generate or -fprofile-instr-generate, merged
+ * with llvm-profdata, or from sampling converted to an LLVM sample profile.
+ */
+
+#ifndef PROFILE_LOADER_H
+#define PROFILE_LOADER_H
+
+#include <string>
+#include <vector>
+
+namespace obfuscator {
+
+/**
+ * @class ProfileLoader
+ * @brief Recognizes profiles and turns them into clang arguments
+ */
+class ProfileLoader {
+public:
+    /**
+     * @brief Clang arguments that attach a profile's counts to the compiled module
+     * @param path Indexed instrumentation profile or sample profile
+     * @param args Receives the arguments
+     * @return false if the file is not such a profile
+     */
+    static bool getFrontendArgs(const std::string& path, std::vector<std::string>& args);
+};
+
+} // namespace obfuscator
+
+#endif // PROFILE_LOADER_H
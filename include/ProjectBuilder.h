@@ -0,0 +1,90 @@
+/**
+ * @file ProjectBuilder.h
+ * @brief Parallel multi-file project obfuscation
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * Obfuscates many translation units concurrently, each worker thread
+ * owning its own ObfuscationEngine (and therefore its own LLVMContext),
+ * then links all resulting objects into a single binary.
+ */
+
+#ifndef PROJECT_BUILDER_H
+#define PROJECT_BUILDER_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+
+#include "llvm/ADT/SmallVector.h"
+#include "ObfuscationConfig.h"
+#include "ReportGenerator.h"
+#include "Linker.h"
+
+namespace obfuscator {
+
+/**
+ * @class ProjectBuilder
+ * @brief Builds an obfuscated binary from multiple translation units
+ */
+class ProjectBuilder {
+public:
+    /**
+     * @brief Construct a new Project Builder
+     * @param config Obfuscation configuration shared by all units
+     */
+    explicit ProjectBuilder(const ObfuscationConfig& config);
+
+    /**
+     * @brief Obfuscate all inputs in parallel and link them into one binary
+     * @param inputFiles Source files of the project
+     * @param outputFile Path to output binary
+     * @return true if every unit compiled and the link succeeded
+     */
+    bool build(const std::vector<std::string>& inputFiles, const std::string& outputFile);
+
+    /**
+     * @brief Get the report generator with metrics aggregated over all units
+     * @return Shared pointer to report generator
+     */
+    std::shared_ptr<ReportGenerator> getReportGenerator() const { return reportGenerator_; }
+
+    /**
+     * @brief Number of worker threads a build will use
+     * @param unitCount Number of translation units
+     * @return Worker count (never more than the unit count)
+     */
+    uint32_t getWorkerCount(size_t unitCount) const;
+
+private:
+    /**
+     * @struct TranslationUnit
+     * @brief Per-input work item and its result
+     */
+    struct TranslationUnit {
+        std::string inputFile;
+        llvm::SmallVector<char, 0> object;
+        std::shared_ptr<MetricsCollector> metrics;
+        bool success = false;
+    };
+
+    /**
+     * @brief Worker loop: claim units until none are left
+     */
+    void runWorker(std::vector<TranslationUnit>& units, std::atomic<size_t>& nextUnit,
+                   std::atomic<bool>& failed);
+
+    /**
+     * @brief Link all unit objects into the final binary
+     */
+    bool linkUnits(const std::vector<TranslationUnit>& units, const std::string& outputFile);
+
+    ObfuscationConfig config_;
+    std::shared_ptr<ReportGenerator> reportGenerator_;
+    Linker linker_;
+};
+
+} // namespace obfuscator
+
+#endif // PROJECT_BUILDER_H
@@ -0,0 +1,73 @@
+/**
+ * @file RandomStream.h
+ * @brief Deterministic counter-based random streams
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * Philox4x32-10 generator whose output depends only on its key and
+ * counter. Every (seed, cycle, pass, function) tuple gets an independent
+ * stream, so passes produce identical output regardless of the order or
+ * thread in which functions are visited.
+ */
+
+#ifndef RANDOM_STREAM_H
+#define RANDOM_STREAM_H
+
+#include <array>
+#include <cstdint>
+#include "llvm/ADT/StringRef.h"
+
+namespace obfuscator {
+
+/**
+ * @class RandomStream
+ * @brief Philox4x32-10 random stream addressed by key and stream id
+ */
+class RandomStream {
+public:
+    /**
+     * @brief Construct a stream
+     * @param key 64-bit Philox key
+     * @param streamId 64-bit stream identifier (upper half of the counter)
+     * @param subStream 32-bit sub-stream identifier
+     */
+    RandomStream(uint64_t key, uint64_t streamId, uint32_t subStream = 0);
+
+    /**
+     * @brief Derive the stream for one entity of one pass in one cycle
+     * @param seed Global obfuscation seed
+     * @param cycle Obfuscation cycle index
+     * @param passName Name of the pass drawing numbers
+     * @param entity Name of the function (or global) being transformed
+     * @return Stream independent of every other derived stream
+     */
+    static RandomStream derive(uint32_t seed, uint32_t cycle,
+                               llvm::StringRef passName, llvm::StringRef entity);
+
+    /**
+     * @brief Raw Philox4x32-10 block function
+     * @param counter 128-bit counter
+     * @param key 64-bit key
+     * @return Four output words
+     */
+    static std::array<uint32_t, 4> philox(std::array<uint32_t, 4> counter,
+                                          std::array<uint32_t, 2> key);
+
+    uint32_t getUInt32();
+    uint32_t getUInt32(uint32_t min, uint32_t max);
+    uint64_t getUInt64();
+    bool getBool(uint32_t probability);
+    double getDouble();
+
+private:
+    void refill();
+
+    std::array<uint32_t, 2> key_;
+    std::array<uint32_t, 4> counter_;   // {block, subStream, streamLo, streamHi}
+    std::array<uint32_t, 4> buffer_;
+    unsigned index_;
+};
+
+} // namespace obfuscator
+
+#endif // RANDOM_STREAM_H
@@ -38,6 +38,12 @@ public:
      */
     void setMetricsCollector(std::shared_ptr<MetricsCollector> metrics);
 
+    /**
+     * @brief Get the metrics collector
+     * @return Shared pointer to metrics collector (may be null)
+     */
+    std::shared_ptr<MetricsCollector> getMetricsCollector() const { return metrics_; }
+
     /**
      * @brief Generate report in specified format
      * @param outputPath Path to output report file
@@ -0,0 +1,95 @@
+/**
+ * @file ResultCache.h
+ * @brief Content-addressed on-disk cache of obfuscation results
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * Entries are keyed by a SHA-256 over the unobfuscated input IR, every
+ * code-affecting configuration setting (including the seed) and the
+ * obfuscator version, so a hit is exactly what a full run would produce.
+ * Entries are single files written through a rename, which makes the cache
+ * safe to share between concurrent builds. Hits refresh an entry's
+ * modification time; a store that takes the cache over its size bound
+ * evicts the least recently used entries until 90% of the bound is left.
+ */
+
+#ifndef RESULT_CACHE_H
+#define RESULT_CACHE_H
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "ObfuscationConfig.h"
+
+namespace obfuscator {
+
+/**
+ * @class ResultCache
+ * @brief Size-bounded LRU cache of final objects and binaries
+ */
+class ResultCache {
+public:
+    /**
+     * @brief Open (and create if needed) a cache directory
+     * @param directory Cache directory
+     * @param maxSize Size bound in bytes
+     */
+    ResultCache(const std::string& directory, uint64_t maxSize);
+
+    /**
+     * @brief Compute the cache key for one result
+     * @param input Canonical form of the unobfuscated input, e.g. textual IR
+     * @param config Configuration the result is produced with
+     * @param kind Kind of result, e.g. "object" or "binary"
+     * @return Lower-case hex SHA-256
+     */
+    static std::string computeKey(llvm::StringRef input, const ObfuscationConfig& config,
+                                  llvm::StringRef kind);
+
+    /**
+     * @brief Look up an entry and mark it as recently used
+     * @param key Key from computeKey
+     * @return Entry contents, or nullptr on a miss
+     */
+    std::unique_ptr<llvm::MemoryBuffer> lookup(const std::string& key);
+
+    /**
+     * @brief Store an entry, then evict down to the size bound
+     * @param key Key from computeKey
+     * @param data Result bytes
+     * @return true if the entry was written
+     */
+    bool store(const std::string& key, llvm::StringRef data);
+
+    /**
+     * @brief Remove least recently used entries if the cache exceeds its bound
+     */
+    void evict();
+
+    /**
+     * @brief Get total size of all entries
+     * @return Size in bytes
+     */
+    uint64_t getSize() const;
+
+    /**
+     * @brief Get cache directory
+     * @return Directory path
+     */
+    const std::string& getDirectory() const { return directory_; }
+
+private:
+    std::string entryPath(const std::string& key) const;
+
+    std::string directory_;
+    uint64_t maxSize_;
+    uint64_t knownSize_;  ///< Total at the last scan plus what this instance stored since
+    bool sizeKnown_;
+};
+
+} // namespace obfuscator
+
+#endif // RESULT_CACHE_H
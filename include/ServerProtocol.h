@@ -0,0 +1,77 @@
+/**
+ * @file ServerProtocol.h
+ * @brief Wire format between the obfuscation daemon and its clients
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * A message is a sequence of named fields, each written as
+ * "<name> <length>\n" followed by exactly <length> bytes of value and a
+ * newline, and terminated by an "end 0\n" field. Values are opaque
+ * bytes, so bitcode and object files travel unencoded. A connection
+ * carries one request and one response.
+ */
+
+#ifndef SERVER_PROTOCOL_H
+#define SERVER_PROTOCOL_H
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "llvm/ADT/StringRef.h"
+
+namespace obfuscator {
+
+/**
+ * @class ServerMessage
+ * @brief Ordered list of named fields, names may repeat
+ */
+class ServerMessage {
+public:
+    /**
+     * @brief Append a field
+     * @param name Field name (no spaces or newlines)
+     * @param value Field value, any bytes
+     */
+    void add(const std::string& name, llvm::StringRef value);
+
+    /**
+     * @brief Get the first value of a field
+     * @param name Field name
+     * @return Value, or an empty string if the field is missing
+     */
+    std::string get(llvm::StringRef name) const;
+
+    /**
+     * @brief Get all values of a repeated field in order
+     */
+    std::vector<std::string> getAll(llvm::StringRef name) const;
+
+    /**
+     * @brief Check whether a field is present
+     */
+    bool has(llvm::StringRef name) const;
+
+    /**
+     * @brief Read one message from a socket
+     * @param fd Connected socket
+     * @param maxSize Upper bound on the total size of all values
+     * @param timeoutMs Time allowed for the whole message, -1 for no limit
+     * @return false on a closed connection, timeout or malformed message
+     */
+    bool read(int fd, size_t maxSize, int timeoutMs = -1);
+
+    /**
+     * @brief Write the message to a socket
+     * @param fd Connected socket
+     * @return false if the peer went away
+     */
+    bool write(int fd) const;
+
+private:
+    std::vector<std::pair<std::string, std::string>> fields_;
+};
+
+} // namespace obfuscator
+
+#endif // SERVER_PROTOCOL_H
@@ -0,0 +1,142 @@
+/**
+ * @file StagedPipeline.h
+ * @brief Pipelined batch execution with one worker pool per stage
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * Files move through four stages (frontend, obfuscation, codegen, link),
+ * each served by its own worker threads and fed by a bounded queue. While
+ * one file is being obfuscated, the next is already in the frontend and
+ * the previous one in the linker, so CPU-heavy stages overlap the
+ * process- and I/O-heavy ones. Every file carries its own LLVMContext
+ * from stage to stage; each worker owns an ObfuscationEngine for the
+ * stage's components. Queue bounds keep the number of modules in flight,
+ * and with it memory use, limited.
+ */
+
+#ifndef STAGED_PIPELINE_H
+#define STAGED_PIPELINE_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "BoundedQueue.h"
+#include "ManifestRunner.h"
+#include "MetricsCollector.h"
+#include "ObfuscationConfig.h"
+#include "PerfCounters.h"
+
+namespace obfuscator {
+
+/**
+ * @class StagedPipeline
+ * @brief Runs manifest entries through per-stage worker pools
+ */
+class StagedPipeline {
+public:
+    enum Stage { COMPILE = 0, OBFUSCATE, CODEGEN, LINK, STAGE_COUNT };
+
+    /**
+     * @struct StageStats
+     * @brief Load of one stage over a run
+     */
+    struct StageStats {
+        uint32_t workers = 0;
+        size_t jobs = 0;
+        std::chrono::microseconds busy{0};   // Summed over workers
+        std::chrono::microseconds wait{0};   // Summed queue wait of all jobs
+        size_t maxQueueDepth = 0;
+        double utilization = 0.0;            // busy / (workers * wall time)
+    };
+
+    /**
+     * @struct Result
+     * @brief Outcome of one entry
+     */
+    struct Result {
+        size_t index = 0;
+        bool success = false;
+        std::string failedStage;
+        std::shared_ptr<MetricsCollector> metrics;
+        std::array<std::chrono::microseconds, STAGE_COUNT> wait{};
+        std::array<std::chrono::microseconds, STAGE_COUNT> run{};
+    };
+
+    /**
+     * @brief Construct a pipeline
+     * @param config Obfuscation configuration shared by all entries
+     * @param workers Worker count per stage, in Stage order
+     */
+    StagedPipeline(const ObfuscationConfig& config, const std::vector<uint32_t>& workers);
+
+    /**
+     * @brief Run all entries through the pipeline
+     * @param entries Programs to obfuscate
+     * @param report Called once per entry, from worker threads, one call at a time
+     * @return true if every entry succeeded
+     */
+    bool run(const std::vector<ManifestEntry>& entries,
+             const std::function<void(const Result&)>& report);
+
+    /**
+     * @brief Get per-stage statistics of the last run, in Stage order
+     */
+    const std::vector<StageStats>& getStageStats() const { return stats_; }
+
+    /**
+     * @brief Get the name of a stage
+     */
+    static const char* getStageName(Stage stage);
+
+private:
+    /**
+     * @struct Job
+     * @brief One entry and the state it carries between stages
+     */
+    struct Job {
+        size_t index;
+        const ManifestEntry* entry;
+        std::unique_ptr<llvm::LLVMContext> context;
+        std::unique_ptr<llvm::Module> module;
+        llvm::SmallVector<char, 0> object;
+        Result result;
+        std::array<PerfCounterValues, STAGE_COUNT> counters;  // Per stage, if counted
+        std::chrono::steady_clock::time_point queuedAt;
+        std::chrono::steady_clock::time_point startedAt;
+    };
+
+    using JobQueue = BoundedQueue<std::unique_ptr<Job>>;
+
+    /**
+     * @brief Worker loop of one stage
+     */
+    void runStageWorker(Stage stage);
+
+    /**
+     * @brief Report a finished or failed job
+     */
+    void finish(std::unique_ptr<Job> job);
+
+    ObfuscationConfig config_;
+    std::vector<uint32_t> workers_;
+    std::array<std::unique_ptr<JobQueue>, STAGE_COUNT> queues_;
+    std::array<std::atomic<uint32_t>, STAGE_COUNT> runningWorkers_;
+    std::vector<StageStats> stats_;
+
+    std::mutex mutex_;
+    const std::function<void(const Result&)>* report_;
+    size_t failures_;
+};
+
+} // namespace obfuscator
+
+#endif // STAGED_PIPELINE_H
@@ -0,0 +1,87 @@
+/**
+ * @file WorkStealingPool.h
+ * @brief Fixed-size thread pool with per-worker work-stealing queues
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * Work is spread across per-worker deques up front. A worker drains its
+ * own deque from the back and, once empty, steals from the front of the
+ * others, so a few expensive items do not leave the rest of the pool idle.
+ */
+
+#ifndef WORK_STEALING_POOL_H
+#define WORK_STEALING_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace obfuscator {
+
+/**
+ * @class WorkStealingPool
+ * @brief Runs indexed work items on a set of persistent threads
+ */
+class WorkStealingPool {
+public:
+    /**
+     * @brief Start the pool
+     * @param threadCount Total workers including the calling thread (0 = all cores)
+     */
+    explicit WorkStealingPool(uint32_t threadCount);
+
+    /**
+     * @brief Stop and join all worker threads
+     */
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    /**
+     * @brief Run body(i) for every i in [0, count) and wait for completion
+     * @param count Number of work items
+     * @param body Work function; must be safe to call concurrently
+     *
+     * The calling thread takes part as worker 0. Not reentrant.
+     */
+    void parallelFor(size_t count, const std::function<void(size_t)>& body);
+
+    /**
+     * @brief Get the number of workers (including the calling thread)
+     * @return Worker count
+     */
+    uint32_t getThreadCount() const { return static_cast<uint32_t>(queues_.size()); }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<size_t> items;
+    };
+
+    void workerLoop(uint32_t worker);
+    bool runOne(uint32_t worker);
+    bool popLocal(uint32_t worker, size_t& item);
+    bool steal(uint32_t worker, size_t& item);
+
+    std::vector<std::unique_ptr<WorkQueue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::mutex stateMutex_;
+    std::condition_variable wakeWorkers_;
+    std::condition_variable allDone_;
+    const std::function<void(size_t)>* body_;
+    std::atomic<size_t> pending_;
+    uint64_t generation_;
+    bool stopping_;
+};
+
+} // namespace obfuscator
+
+#endif // WORK_STEALING_POOL_H
@@ -16,6 +16,7 @@ class AntiDebug : public ObfuscationPass {
 public:
     AntiDebug();
     bool runOnModule(llvm::Module& module, MetricsCollector& metrics) override;
+    PassTraits getTraits() const override;
 
 private:
     uint32_t insertAntiDebugChecks(llvm::Module& module);
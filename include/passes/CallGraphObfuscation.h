@@ -16,6 +16,7 @@ class CallGraphObfuscation : public ObfuscationPass {
 public:
     CallGraphObfuscation();
     bool runOnModule(llvm::Module& module, MetricsCollector& metrics) override;
+    PassTraits getTraits() const override;
 
 private:
     uint32_t obfuscateCalls(llvm::Module& module);
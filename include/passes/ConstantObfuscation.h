@@ -12,14 +12,18 @@
 
 namespace obfuscator {
 
-class ConstantObfuscation : public ObfuscationPass {
+class ConstantObfuscation : public FunctionObfuscationPass {
 public:
     explicit ConstantObfuscation(uint32_t complexity = 50);
-    bool runOnModule(llvm::Module& module, MetricsCollector& metrics) override;
+    PassTraits getTraits() const override;
+
+protected:
+    uint32_t runOnFunction(llvm::Function& func, llvm::FunctionAnalysisManager& analyses) override;
+    void recordTransformations(MetricsCollector& metrics, uint32_t count) const override;
 
 private:
     uint32_t complexity_;
-    uint32_t obfuscateConstants(llvm::Function& func);
+    uint32_t obfuscateConstants(llvm::Function& func, const BlockHotness& hotness);
 };
 
 } // namespace obfuscator
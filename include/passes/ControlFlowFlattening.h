@@ -7,6 +7,12 @@
  * This pass transforms the control flow graph into a flattened structure
  * where all basic blocks are dispatched through a quantum-inspired central
  * switch statement with probability-based state evolution.
+ *
+ * Functions with more than a few hundred blocks are dispatched in two
+ * levels: the top switch picks a region of consecutive blocks, whose own
+ * switch picks the block. Branches that stay within a region go straight
+ * to the region's switch. Block states come from a DenseMap, so the
+ * transform is linear in the size of the function.
  */
 
 #ifndef CONTROL_FLOW_FLATTENING_H
@@ -22,7 +28,7 @@ namespace obfuscator {
  * @class ControlFlowFlattening
  * @brief Flattens control flow to obscure program logic
  */
-class ControlFlowFlattening : public ObfuscationPass {
+class ControlFlowFlattening : public FunctionObfuscationPass {
 public:
     /**
      * @brief Construct a new Control Flow Flattening pass
@@ -30,13 +36,11 @@ public:
      */
     explicit ControlFlowFlattening(uint32_t complexity = 50);
 
-    /**
-     * @brief Run control flow flattening on module
-     * @param module LLVM module to transform
-     * @param metrics Metrics collector
-     * @return true if transformations were made
-     */
-    bool runOnModule(llvm::Module& module, MetricsCollector& metrics) override;
+    PassTraits getTraits() const override;
+
+protected:
+    uint32_t runOnFunction(llvm::Function& func, llvm::FunctionAnalysisManager& analyses) override;
+    void recordTransformations(MetricsCollector& metrics, uint32_t count) const override;
 
 private:
     uint32_t complexity_;
@@ -48,6 +52,15 @@ private:
      */
     bool flattenFunction(llvm::Function& func);
 
+    /**
+     * @brief Move PHIs and values used across blocks to stack slots
+     *
+     * Once every block is entered from a dispatcher, only the entry
+     * block dominates the others.
+     * @param func Function about to be flattened
+     */
+    void demoteToStack(llvm::Function& func);
+
     /**
      * @brief Check if function is suitable for flattening
      * @param func Function to check
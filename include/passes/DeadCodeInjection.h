@@ -12,14 +12,18 @@
 
 namespace obfuscator {
 
-class DeadCodeInjection : public ObfuscationPass {
+class DeadCodeInjection : public FunctionObfuscationPass {
 public:
     explicit DeadCodeInjection(uint32_t ratio = 20);
-    bool runOnModule(llvm::Module& module, MetricsCollector& metrics) override;
+    PassTraits getTraits() const override;
+
+protected:
+    uint32_t runOnFunction(llvm::Function& func, llvm::FunctionAnalysisManager& analyses) override;
+    void recordTransformations(MetricsCollector& metrics, uint32_t count) const override;
 
 private:
     uint32_t ratio_;
-    uint32_t injectDeadCode(llvm::Function& func);
+    uint32_t injectDeadCode(llvm::Function& func, const BlockHotness& hotness);
 };
 
 } // namespace obfuscator
@@ -22,10 +22,13 @@ namespace obfuscator {
  * but structurally different code variants, making pattern recognition
  * extremely difficult.
  */
-class GrammarMetamorphic : public ObfuscationPass {
+class GrammarMetamorphic : public FunctionObfuscationPass {
 public:
     GrammarMetamorphic(uint32_t transformationRate = 50);
-    bool runOnModule(llvm::Module& module, MetricsCollector& metrics) override;
+    PassTraits getTraits() const override;
+
+protected:
+    uint32_t runOnFunction(llvm::Function& func, llvm::FunctionAnalysisManager& analyses) override;
 
 private:
     uint32_t transformationRate_;  ///< Percentage of instructions to transform (0-100)
@@ -33,7 +36,7 @@ private:
     /**
      * @brief Apply grammar transformations to function
      */
-    uint32_t transformFunction(llvm::Function& func);
+    uint32_t transformFunction(llvm::Function& func, const BlockHotness& hotness);
     
     /**
      * @brief Grammar rule: a = b + c → a = b - (-c)
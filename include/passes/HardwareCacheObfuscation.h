@@ -25,6 +25,7 @@ class HardwareCacheObfuscation : public ObfuscationPass {
 public:
     HardwareCacheObfuscation(uint32_t intensity = 50);
     bool runOnModule(llvm::Module& module, MetricsCollector& metrics) override;
+    PassTraits getTraits() const override;
 
 private:
     uint32_t intensity_;  ///< Obfuscation intensity (0-100)
@@ -21,10 +21,13 @@ namespace obfuscator {
  * equivalent but exponentially complex MBA expressions. Defeats SMT solvers
  * and symbolic execution engines.
  */
-class MBAObfuscation : public ObfuscationPass {
+class MBAObfuscation : public FunctionObfuscationPass {
 public:
     explicit MBAObfuscation(uint32_t probability = 75);
-    bool runOnModule(llvm::Module& module, MetricsCollector& metrics) override;
+    PassTraits getTraits() const override;
+
+protected:
+    uint32_t runOnFunction(llvm::Function& func, llvm::FunctionAnalysisManager& analyses) override;
 
 private:
     uint32_t probability_; // Percentage of operations to transform
@@ -32,7 +35,7 @@ private:
     /**
      * @brief Transform arithmetic operations to MBA equivalents
      */
-    uint32_t transformArithmeticOperations(llvm::Function& func);
+    uint32_t transformArithmeticOperations(llvm::Function& func, const BlockHotness& hotness);
     
     /**
      * @brief Generate MBA equivalent for addition: a + b
@@ -74,7 +77,8 @@ private:
      * Returns: (expr + noise) - noise
      */
     llvm::Value* addNoiseCancellation(llvm::IRBuilder<>& builder,
-                                      llvm::Value* expr);
+                                      llvm::Value* expr,
+                                      RandomStream& rng);
 };
 
 } // namespace obfuscator
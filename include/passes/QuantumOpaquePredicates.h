@@ -21,10 +21,14 @@ namespace obfuscator {
  * probability theory. Predicates are always true/false but require exponential
  * time complexity to prove using automated tools.
  */
-class QuantumOpaquePredicates : public ObfuscationPass {
+class QuantumOpaquePredicates : public FunctionObfuscationPass {
 public:
     explicit QuantumOpaquePredicates(uint32_t count = 10);
-    bool runOnModule(llvm::Module& module, MetricsCollector& metrics) override;
+    PassTraits getTraits() const override;
+
+protected:
+    uint32_t runOnFunction(llvm::Function& func, llvm::FunctionAnalysisManager& analyses) override;
+    void recordTransformations(MetricsCollector& metrics, uint32_t count) const override;
 
 private:
     uint32_t count_;
@@ -32,7 +36,7 @@ private:
     /**
      * @brief Insert quantum-inspired predicates into function
      */
-    uint32_t insertQuantumPredicates(llvm::Function& func);
+    uint32_t insertQuantumPredicates(llvm::Function& func, const BlockHotness& hotness);
     
     /**
      * @brief Create Bell state entangled predicate
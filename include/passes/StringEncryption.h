@@ -17,6 +17,7 @@ class StringEncryption : public ObfuscationPass {
 public:
     explicit StringEncryption(const std::string& algorithm = "xor");
     bool runOnModule(llvm::Module& module, MetricsCollector& metrics) override;
+    PassTraits getTraits() const override;
 
 private:
     std::string algorithm_;
@@ -0,0 +1,83 @@
+#!/usr/bin/env bash
+# Compile time of control-flow flattening on very large functions.
+#
+# Generates one function of 1k, 10k and 50k blocks (a chain where every
+# block branches one or two blocks ahead and merges the values in PHIs),
+# flattens it with the pass plugin in opt, and compiles it with llc before
+# and after. Reports the flattening time and both codegen times.
+#
+# Usage: scripts/benchmark/flatten_scaling.sh [plugin] [sizes...]
+
+set -euo pipefail
+
+PLUGIN=${1:-build/libphantron.so}
+shift || true
+SIZES=${*:-1000 10000 50000}
+OPT=${OPT:-opt}
+LLC=${LLC:-llc}
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# Flattening only, one cycle
+cat > "$WORK/flatten.yaml" <<EOF
+obfuscation:
+  level: medium
+  cycles: 1
+  seed: 1
+control_flow:
+  flattening_enabled: true
+instructions:
+  substitution: false
+  dead_code: false
+data_obfuscation:
+  string_encryption: false
+  constant_obfuscation: false
+advanced:
+  call_graph_obfuscation: false
+  anti_debug: false
+EOF
+
+generate() {
+    awk -v n="$1" 'BEGIN {
+        print "define i64 @chain(i64 %x) {\nentry:\n  br label %b0"
+        for (i = 0; i < n; i++) {
+            print "b" i ":"
+            if (i == 0) {
+                print "  %v0 = add i64 %x, 1"
+            } else if (i == 1) {
+                print "  %v1 = add i64 %v0, 2"
+            } else {
+                printf "  %%p%d = phi i64 [ %%v%d, %%b%d ], [ %%v%d, %%b%d ]\n", i, i-1, i-1, i-2, i-2
+                printf "  %%v%d = add i64 %%p%d, %d\n", i, i, i
+            }
+            if (i + 1 == n) {
+                print "  ret i64 %v" i
+            } else if (i + 2 == n) {
+                print "  br label %b" i+1
+            } else {
+                printf "  %%c%d = icmp ult i64 %%v%d, %d\n", i, i, i * 7
+                printf "  br i1 %%c%d, label %%b%d, label %%b%d\n", i, i+1, i+2
+            }
+        }
+        print "}"
+    }'
+}
+
+seconds() {
+    local start end
+    start=$(date +%s%N)
+    "$@" > /dev/null
+    end=$(date +%s%N)
+    awk -v ns=$((end - start)) 'BEGIN { printf "%.2f", ns / 1e9 }'
+}
+
+printf "%-8s %12s %14s %14s\n" "blocks" "flatten (s)" "llc plain (s)" "llc flat (s)"
+for size in $SIZES; do
+    generate "$size" > "$WORK/chain.ll"
+    flatten=$(PHANTRON_CONFIG="$WORK/flatten.yaml" seconds \
+        "$OPT" -load-pass-plugin "$PLUGIN" -passes=phantron "$WORK/chain.ll" -o "$WORK/flat.bc")
+    plain=$(seconds "$LLC" -O1 -filetype=obj "$WORK/chain.ll" -o "$WORK/plain.o")
+    flat=$(seconds "$LLC" -O1 -filetype=obj "$WORK/flat.bc" -o "$WORK/flat.o")
+    printf "%-8s %12s %14s %14s\n" "$size" "$flatten" "$plain" "$flat"
+done
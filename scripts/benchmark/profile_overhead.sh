@@ -0,0 +1,72 @@
+#!/usr/bin/env bash
+# Runtime overhead of obfuscation with and without a training profile.
+#
+# Builds tests/test_advanced_algorithms.c (or the given source, such as
+# scripts/benchmark/profile_workload.ll) plainly, obfuscated, and
+# obfuscated with --profile from a training run, then reports each
+# binary's user-space instructions (perf) or run time over the
+# unobfuscated one. Fails if an obfuscated binary prints something else.
+#
+# Usage: scripts/benchmark/profile_overhead.sh [obfuscator] [source] [runs]
+
+set -euo pipefail
+
+OBFUSCATOR=${1:-build/phantron-llvm-obfuscator}
+SOURCE=${2:-tests/test_advanced_algorithms.c}
+RUNS=${3:-200}
+LEVEL=${LEVEL:-medium}
+SEED=${SEED:-1}
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# The obfuscator compiles at -O1, so the training build does too and the
+# profile matches the code it is applied to
+clang -O1 "$SOURCE" -o "$WORK/baseline"
+clang -O1 -fprofile-generate="$WORK/raw" "$SOURCE" -o "$WORK/instrumented"
+"$WORK/instrumented" > /dev/null
+llvm-profdata merge -o "$WORK/train.profdata" "$WORK"/raw/*.profraw
+
+"$OBFUSCATOR" --seed "$SEED" -l "$LEVEL" --report "$WORK/plain" \
+    -o "$WORK/obfuscated" "$SOURCE" > /dev/null
+"$OBFUSCATOR" --seed "$SEED" -l "$LEVEL" --report "$WORK/guided" \
+    --profile "$WORK/train.profdata" -o "$WORK/guided" "$SOURCE" > /dev/null
+
+# Timing a miscompiled binary says nothing, so refuse to
+expected=$("$WORK/baseline")
+for binary in obfuscated guided; do
+    if [[ "$("$WORK/$binary")" != "$expected" ]]; then
+        echo "error: $binary output differs from the baseline" >&2
+        exit 1
+    fi
+done
+
+if perf stat -e instructions:u true > /dev/null 2>&1; then
+    UNIT="instructions"
+    measure() {
+        perf stat -x, -e instructions:u -r "$RUNS" "$1" 2>&1 > /dev/null |
+            awk -F, '/instructions/ { print $1 }'
+    }
+else
+    UNIT="ns"
+    measure() {
+        local start end
+        start=$(date +%s%N)
+        for ((i = 0; i < RUNS; i++)); do
+            "$1" > /dev/null
+        done
+        end=$(date +%s%N)
+        echo $(((end - start) / RUNS))
+    }
+fi
+
+baseline=$(measure "$WORK/baseline")
+obfuscated=$(measure "$WORK/obfuscated")
+guided=$(measure "$WORK/guided")
+
+awk -v base="$baseline" -v plain="$obfuscated" -v guided="$guided" -v unit="$UNIT" 'BEGIN {
+    printf "%-22s %14s %10s\n", "binary", unit "/run", "overhead"
+    printf "%-22s %14d %9s\n", "baseline", base, "-"
+    printf "%-22s %14d %9.1f%%\n", "obfuscated", plain, (plain - base) * 100 / base
+    printf "%-22s %14d %9.1f%%\n", "obfuscated --profile", guided, (guided - base) * 100 / base
+}'
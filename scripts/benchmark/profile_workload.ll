@@ -0,0 +1,109 @@
+; Profile benchmark workload for profile_overhead.sh: an FNV-style hashing
+; kernel (20000 rounds over 4096 words, about 82M inner-loop iterations)
+; with a rare fix-up call, plus cold setup, argument checking and reporting.
+; Written in IR so the training and obfuscated builds see the same module
+; without depending on the C front end's version.
+target datalayout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128"
+target triple = "x86_64-pc-linux-gnu"
+@buf = internal global [4096 x i32] zeroinitializer
+@.fmt = private unnamed_addr constant [18 x i8] c"checksum %llx %d\0A\00"
+@.bad = private unnamed_addr constant [13 x i8] c"bad seed %d\0A\00"
+declare i32 @printf(i8*, ...)
+
+define internal void @init(i32 %seed) {
+entry:
+  br label %loop
+loop:
+  %i = phi i64 [ 0, %entry ], [ %in, %loop ]
+  %s = phi i32 [ %seed, %entry ], [ %s2, %loop ]
+  %m = mul i32 %s, 1103515245
+  %s2 = add i32 %m, 12345
+  %p = getelementptr [4096 x i32], [4096 x i32]* @buf, i64 0, i64 %i
+  store i32 %s2, i32* %p
+  %in = add i64 %i, 1
+  %c = icmp ult i64 %in, 4096
+  br i1 %c, label %loop, label %done
+done:
+  ret void
+}
+
+define internal i64 @fixup(i64 %acc, i32 %v) noinline {
+entry:
+  %neg = icmp slt i32 %v, 0
+  br i1 %neg, label %a, label %b
+a:
+  %x = xor i64 %acc, 6148914691236517205
+  br label %m
+b:
+  %vz = zext i32 %v to i64
+  %y = mul i64 %acc, %vz
+  br label %m
+m:
+  %r = phi i64 [ %x, %a ], [ %y, %b ]
+  %r2 = add i64 %r, 977
+  ret i64 %r2
+}
+
+define internal i64 @kernel(i32 %rounds) noinline {
+entry:
+  br label %outer
+outer:
+  %r = phi i32 [ 0, %entry ], [ %rn, %outer.latch ]
+  %acc0 = phi i64 [ 1469598103934665603, %entry ], [ %accx, %outer.latch ]
+  br label %inner
+inner:
+  %i = phi i64 [ 0, %outer ], [ %in, %inner.latch ]
+  %acc = phi i64 [ %acc0, %outer ], [ %acc3, %inner.latch ]
+  %p = getelementptr [4096 x i32], [4096 x i32]* @buf, i64 0, i64 %i
+  %v = load i32, i32* %p
+  %vx = zext i32 %v to i64
+  %a1 = xor i64 %acc, %vx
+  %a2 = mul i64 %a1, 1099511628211
+  %sh = lshr i64 %a2, 29
+  %a3 = xor i64 %a2, %sh
+  %low = and i32 %v, 4095
+  %rare = icmp eq i32 %low, 0
+  br i1 %rare, label %slow, label %inner.latch
+slow:
+  %f = call i64 @fixup(i64 %a3, i32 %v)
+  br label %inner.latch
+inner.latch:
+  %acc3 = phi i64 [ %a3, %inner ], [ %f, %slow ]
+  %in = add i64 %i, 1
+  %c = icmp ult i64 %in, 4096
+  br i1 %c, label %inner, label %outer.latch
+outer.latch:
+  %rot = shl i64 %acc3, 1
+  %accx = xor i64 %rot, %acc3
+  %rn = add i32 %r, 1
+  %oc = icmp slt i32 %rn, %rounds
+  br i1 %oc, label %outer, label %exit
+exit:
+  ret i64 %accx
+}
+
+define internal i32 @report(i64 %sum, i32 %rounds) noinline {
+entry:
+  %z = icmp eq i64 %sum, 0
+  br i1 %z, label %zero, label %ok
+zero:
+  ret i32 1
+ok:
+  %c = call i32 (i8*, ...) @printf(i8* getelementptr ([18 x i8], [18 x i8]* @.fmt, i64 0, i64 0), i64 %sum, i32 %rounds)
+  ret i32 0
+}
+
+define i32 @main(i32 %argc, i8** %argv) {
+entry:
+  %seed = add i32 %argc, 41
+  %bad = icmp sgt i32 %seed, 1000
+  br i1 %bad, label %fail, label %go
+fail:
+  %e = call i32 (i8*, ...) @printf(i8* getelementptr ([13 x i8], [13 x i8]* @.bad, i64 0, i64 0), i32 %seed)
+  ret i32 2
+go:
+  call void @init(i32 %seed)
+  %s = call i64 @kernel(i32 20000)
+  %r = call i32 @report(i64 %s, i32 20000)
+  ret i32 %r
+}
@@ -7,12 +7,33 @@
 
 #include "CLIParser.h"
 #include "ConfigParser.h"
+#include "ProfileLoader.h"
+#include "llvm/ADT/StringRef.h"
 #include <iostream>
 #include <cstring>
 
 namespace obfuscator {
 
-CLIParser::CLIParser() : showHelp_(false), showVersion_(false), 
+namespace {
+
+/**
+ * @brief Parse the decimal value of a numeric option
+ * @return false, with a message, if the value is not a number in range
+ */
+template <typename T>
+bool parseNumber(const std::string& option, llvm::StringRef value, T& result) {
+    // getAsInteger returns true on error
+    if (value.getAsInteger(10, result)) {
+        std::cerr << "Error: " << option << " expects a number, got '" << value.str() << "'\n";
+        return false;
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+CLIParser::CLIParser() : sendInput_(false), serverStatus_(false),
+                         showHelp_(false), showVersion_(false), 
                          autoTuneEnabled_(false), autoTuneIterations_(5),
                          autoTuneGoal_("balanced") {
     setDefaults();
@@ -32,6 +53,9 @@ bool CLIParser::parse(int argc, char* argv[]) {
         return false;
     }
     
+    std::vector<std::string> positional;
+    bool seedGiven = false;
+    
     for (int i = 1; i < argc; ++i) {
         std::string arg = argv[i];
         
@@ -47,7 +71,7 @@ bool CLIParser::parse(int argc, char* argv[]) {
         
         if (arg == "-i" || arg == "--input") {
             if (i + 1 < argc) {
-                inputFile_ = argv[++i];
+                inputFiles_.push_back(argv[++i]);
             }
         } else if (arg == "-o" || arg == "--output") {
             if (i + 1 < argc) {
@@ -63,7 +87,10 @@ bool CLIParser::parse(int argc, char* argv[]) {
                 } else if (level == "2" || level == "high") {
                     config_.applyPreset(ObfuscationLevel::HIGH);
                 } else {
-                    int levelNum = std::stoi(level);
+                    int levelNum = 0;
+                    if (!parseNumber(arg, level, levelNum)) {
+                        return false;
+                    }
                     if (levelNum <= 0) {
                         config_.applyPreset(ObfuscationLevel::LOW);
                     } else if (levelNum == 1) {
@@ -75,7 +102,10 @@ bool CLIParser::parse(int argc, char* argv[]) {
             }
         } else if (arg == "-C" || arg == "--complexity") {
             if (i + 1 < argc) {
-                int complexity = std::stoi(argv[++i]);
+                int complexity = 0;
+                if (!parseNumber(arg, argv[++i], complexity)) {
+                    return false;
+                }
                 // Use complexity to adjust obfuscation intensity
                 config_.flatteningComplexity = std::min(100, std::max(10, complexity * 30));
                 config_.constantObfuscationComplexity = std::min(100, std::max(10, complexity * 30));
@@ -86,20 +116,107 @@ bool CLIParser::parse(int argc, char* argv[]) {
                 configFile_ = argv[++i];
                 // Parse config file here
                 ConfigParser parser;
+                uint32_t seed = config_.seed;
                 if (!parser.parseFile(configFile_, config_)) {
                     std::cerr << "Warning: Failed to parse config file, using defaults\n";
                 }
+                seedGiven |= config_.seed != seed;
             }
         } else if (arg == "--cycles") {
             if (i + 1 < argc) {
-                config_.obfuscationCycles = std::stoi(argv[++i]);
+                if (!parseNumber(arg, argv[++i], config_.obfuscationCycles)) {
+                    return false;
+                }
             }
         } else if (arg == "--seed") {
             if (i + 1 < argc) {
-                config_.seed = std::stoul(argv[++i]);
+                if (!parseNumber(arg, argv[++i], config_.seed)) {
+                    return false;
+                }
+                seedGiven = true;
+            }
+        } else if (arg == "-j" || arg == "--jobs") {
+            if (i + 1 < argc) {
+                if (!parseNumber(arg, argv[++i], config_.jobs)) {
+                    return false;
+                }
+            }
+        } else if (arg == "--pass-jobs") {
+            if (i + 1 < argc) {
+                if (!parseNumber(arg, argv[++i], config_.passJobs)) {
+                    return false;
+                }
+            }
+        } else if (arg == "--codegen-jobs") {
+            if (i + 1 < argc) {
+                if (!parseNumber(arg, argv[++i], config_.codegenJobs)) {
+                    return false;
+                }
+            }
+        } else if (arg == "--manifest") {
+            if (i + 1 < argc) {
+                manifestFile_ = argv[++i];
+            }
+        } else if (arg == "--pipeline") {
+            if (i + 1 < argc) {
+                // "<compile>,<obfuscate>,<codegen>,<link>" worker counts
+                std::string counts = argv[++i];
+                size_t begin = 0;
+                config_.pipelineWorkers.clear();
+                while (begin <= counts.size()) {
+                    size_t end = counts.find(',', begin);
+                    if (end == std::string::npos) {
+                        end = counts.size();
+                    }
+                    uint32_t workers = 0;
+                    if (!parseNumber(arg, counts.substr(begin, end - begin), workers)) {
+                        return false;
+                    }
+                    config_.pipelineWorkers.push_back(workers);
+                    begin = end + 1;
+                }
+            }
+        } else if (arg == "--results") {
+            if (i + 1 < argc) {
+                resultsFile_ = argv[++i];
+            }
+        } else if (arg == "--serve") {
+            if (i + 1 < argc) {
+                serveSocket_ = argv[++i];
+            }
+        } else if (arg == "--connect") {
+            if (i + 1 < argc) {
+                connectSocket_ = argv[++i];
+            }
+        } else if (arg == "--send-input") {
+            sendInput_ = true;
+        } else if (arg == "--server-status") {
+            serverStatus_ = true;
+        } else if (arg == "--low-memory") {
+            config_.lowMemory = true;
+        } else if (arg == "--batch-size") {
+            if (i + 1 < argc) {
+                if (!parseNumber(arg, argv[++i], config_.batchFunctions)) {
+                    return false;
+                }
+            }
+        } else if (arg == "--cache-dir") {
+            if (i + 1 < argc) {
+                config_.cacheDirectory = argv[++i];
+            }
+        } else if (arg == "--cache-size") {
+            if (i + 1 < argc) {
+                if (!parseNumber(arg, argv[++i], config_.cacheMaxSize)) {
+                    return false;
+                }
+                config_.cacheMaxSize <<= 20;
             }
+        } else if (arg == "--incremental") {
+            config_.incremental = true;
         } else if (arg == "--verbose") {
             config_.verbose = true;
+        } else if (arg == "--in-memory") {
+            config_.inMemoryPipeline = true;
         } else if (arg == "--no-flatten") {
             config_.enableControlFlowFlattening = false;
         } else if (arg == "--no-strings") {
@@ -110,10 +227,75 @@ bool CLIParser::parse(int argc, char* argv[]) {
             config_.enableFunctionVirtualization = true;
         } else if (arg == "--enable-anti-debug") {
             config_.enableAntiDebug = true;
+        } else if (arg == "--link-lib") {
+            if (i + 1 < argc) {
+                config_.linkLibraries.push_back(argv[++i]);
+            }
+        } else if (arg == "--link-object") {
+            if (i + 1 < argc) {
+                config_.linkObjects.push_back(argv[++i]);
+            }
+        } else if (arg == "--link-path") {
+            if (i + 1 < argc) {
+                config_.linkSearchPaths.push_back(argv[++i]);
+            }
         } else if (arg == "--report") {
             if (i + 1 < argc) {
                 config_.reportPath = argv[++i];
             }
+        } else if (arg == "--profile") {
+            if (i + 1 < argc) {
+                config_.profileFile = argv[++i];
+            }
+        } else if (arg == "--hot-loop-threshold") {
+            if (i + 1 < argc) {
+                if (!parseNumber(arg, argv[++i], config_.hotLoopThreshold)) {
+                    return false;
+                }
+            }
+        } else if (arg == "--only-functions") {
+            if (i + 1 < argc) {
+                config_.functionAllowList.push_back(argv[++i]);
+            }
+        } else if (arg == "--skip-functions") {
+            if (i + 1 < argc) {
+                config_.functionDenyList.push_back(argv[++i]);
+            }
+        } else if (arg == "--function-policy") {
+            if (i + 1 < argc) {
+                // The policy never contains ':', the regex may
+                std::string rule = argv[++i];
+                size_t colon = rule.rfind(':');
+                if (colon == std::string::npos) {
+                    std::cerr << "Error: --function-policy expects <regex>:<policy>\n";
+                    return false;
+                }
+                config_.functionPolicies.emplace_back(rule.substr(0, colon), rule.substr(colon + 1));
+            }
+        } else if (arg == "--protect") {
+            if (i + 1 < argc) {
+                config_.protectedRoots.push_back(argv[++i]);
+            }
+        } else if (arg == "--protect-depth") {
+            if (i + 1 < argc) {
+                if (!parseNumber(arg, argv[++i], config_.protectedDepth)) {
+                    return false;
+                }
+            }
+        } else if (arg == "--outside-policy") {
+            if (i + 1 < argc) {
+                config_.outsidePolicy = argv[++i];
+            }
+        } else if (arg == "--trace") {
+            if (i + 1 < argc) {
+                config_.traceFile = argv[++i];
+            }
+        } else if (arg == "--trace-functions") {
+            config_.traceFunctions = true;
+        } else if (arg == "--perf-counters") {
+            config_.perfCounters = true;
+        } else if (arg == "--memory-profile") {
+            config_.memoryProfile = true;
         } else if (arg == "--report-format") {
             if (i + 1 < argc) {
                 config_.reportFormat = argv[++i];
@@ -128,7 +310,9 @@ bool CLIParser::parse(int argc, char* argv[]) {
             }
         } else if (arg == "--auto-tune-iterations") {
             if (i + 1 < argc) {
-                autoTuneIterations_ = std::stoi(argv[++i]);
+                if (!parseNumber(arg, argv[++i], autoTuneIterations_)) {
+                    return false;
+                }
                 if (autoTuneIterations_ < 1) autoTuneIterations_ = 1;
                 if (autoTuneIterations_ > 50) autoTuneIterations_ = 50;
             }
@@ -143,11 +327,47 @@ bool CLIParser::parse(int argc, char* argv[]) {
                     autoTuneGoal_ = "balanced";
                 }
             }
-        } else if (inputFile_.empty()) {
-            inputFile_ = arg;
-        } else if (outputFile_.empty()) {
-            outputFile_ = arg;
+        } else {
+            positional.push_back(arg);
+        }
+    }
+    
+    // "<input> <output>" and "-i <input> <output>" keep their original
+    // meaning; otherwise every positional argument is another translation
+    // unit of the project
+    if (positional.size() == 2 && inputFiles_.empty() && outputFile_.empty()) {
+        inputFiles_.push_back(positional[0]);
+        outputFile_ = positional[1];
+    } else if (!inputFiles_.empty() && outputFile_.empty() && !positional.empty()) {
+        if (positional.size() > 1) {
+            std::cerr << "Error: Ambiguous arguments after -i, give the output with -o\n";
+            return false;
         }
+        outputFile_ = positional[0];
+    } else {
+        inputFiles_.insert(inputFiles_.end(), positional.begin(), positional.end());
+    }
+    
+    if (!inputFiles_.empty()) {
+        inputFile_ = inputFiles_.front();
+    }
+    
+    // The default seed is the start time, so such a cache would never hit
+    if (!config_.cacheDirectory.empty() && !seedGiven) {
+        std::cerr << "Error: --cache-dir needs --seed, results are reused for the same seed only\n";
+        return false;
+    }
+    
+    std::vector<std::string> profileArgs;
+    if (!config_.profileFile.empty() &&
+        !ProfileLoader::getFrontendArgs(config_.profileFile, profileArgs)) {
+        std::cerr << "Error: Cannot use profile " << config_.profileFile << "\n";
+        return false;
+    }
+    
+    // Inputs and outputs come from the manifest or from clients
+    if (isManifestMode() || isServeMode() || (isClientMode() && serverStatus_)) {
+        return config_.validate();
     }
     
     if (inputFile_.empty()) {
@@ -164,17 +384,40 @@ bool CLIParser::parse(int argc, char* argv[]) {
 
 void CLIParser::printHelp() const {
     std::cout << "Phantron LLVM Code Obfuscator v1.0.0\n\n";
-    std::cout << "Usage: phantron-llvm-obfuscator [options] <input-file> [output-file]\n\n";
+    std::cout << "Usage: phantron-llvm-obfuscator [options] <input-file> [output-file]\n";
+    std::cout << "       phantron-llvm-obfuscator [options] -o <output> <input-file>...\n";
+    std::cout << "       phantron-llvm-obfuscator [options] --manifest <file>\n";
+    std::cout << "       phantron-llvm-obfuscator [options] --serve <socket>\n";
+    std::cout << "       phantron-llvm-obfuscator --connect <socket> [options] <input-file> [output-file]\n\n";
     std::cout << "Options:\n";
     std::cout << "  -h, --help                 Show this help message\n";
     std::cout << "  -v, --version              Show version information\n";
-    std::cout << "  -i, --input <file>         Input source file (C/C++)\n";
+    std::cout << "  -i, --input <file>         Input source file (C/C++, repeatable for projects)\n";
     std::cout << "  -o, --output <file>        Output obfuscated binary\n";
     std::cout << "  -l, --level <level>        Obfuscation level: low, medium, high (default: medium)\n";
     std::cout << "  -c, --config <file>        Load configuration from YAML file\n";
     std::cout << "  --cycles <n>               Number of obfuscation cycles (default: 3)\n";
     std::cout << "  --seed <n>                 Random seed for reproducibility\n";
     std::cout << "  --verbose                  Enable verbose output\n";
+    std::cout << "  -j, --jobs <n>             Parallel workers for multi-file projects (default: all cores)\n";
+    std::cout << "  --pass-jobs <n>            Threads for function-local passes (default: 1, 0 = all cores)\n";
+    std::cout << "  --codegen-jobs <n>         Split codegen of large modules over n threads (default: 1)\n";
+    std::cout << "  --in-memory                Keep IR and objects in memory (no temporary files)\n";
+    std::cout << "  --manifest <file>          Obfuscate every \"<input> <output>\" line of <file>\n";
+    std::cout << "  --pipeline <c,o,g,l>       With --manifest, overlap compile/obfuscate/codegen/link stages\n";
+    std::cout << "                             with the given worker counts per stage (e.g. 2,4,2,2)\n";
+    std::cout << "  --results <file>           Write manifest results as JSON lines to <file> (default: stdout)\n";
+    std::cout << "  --serve <socket>           Run as a daemon serving jobs on a Unix socket (-j workers)\n";
+    std::cout << "  --connect <socket>         Run this command on the daemon at <socket>\n";
+    std::cout << "  --send-input               With --connect, send the input and receive the binary over the socket\n";
+    std::cout << "  --server-status            With --connect, print the daemon's queue depth and job counts\n";
+    std::cout << "  --low-memory               Load and compile functions in batches to bound memory use\n";
+    std::cout << "                             (the frontend still builds each source's module whole once)\n";
+    std::cout << "  --batch-size <n>           Functions per batch with --low-memory (default: 256)\n";
+    std::cout << "  --cache-dir <dir>          Reuse results of identical earlier runs from <dir>\n";
+    std::cout << "                             (needs --seed, the default seed changes every run)\n";
+    std::cout << "  --cache-size <MB>          Result cache size bound (default: 1024)\n";
+    std::cout << "  --incremental              Reuse obfuscated unchanged functions (needs --cache-dir)\n";
     std::cout << "\nAuto-Tuning Options:\n";
     std::cout << "  --auto-tune                Enable automatic parameter optimization\n";
     std::cout << "  --auto-tune-iterations <n> Number of optimization iterations (1-50, default: 5)\n";
@@ -188,9 +431,31 @@ void CLIParser::printHelp() const {
     std::cout << "  --no-constants             Disable constant obfuscation\n";
     std::cout << "  --enable-virtualization    Enable function virtualization\n";
     std::cout << "  --enable-anti-debug        Enable anti-debugging features\n";
+    std::cout << "  --profile <file.profdata>  Scale transforms down in blocks the profile shows hot\n";
+    std::cout << "  --hot-loop-threshold <n>   Without a profile, spare innermost-loop blocks estimated\n";
+    std::cout << "                             to run n+ times per call (LoopInfo/BFI, 0 = off)\n";
+    std::cout << "  --only-functions <regex>   Obfuscate only functions whose name matches (repeatable)\n";
+    std::cout << "  --skip-functions <regex>   Never obfuscate functions whose name matches (repeatable)\n";
+    std::cout << "  --function-policy <regex>:<policy>\n";
+    std::cout << "                             Policy of matching functions, e.g. '^lic_:level=high'\n";
+    std::cout << "                             (level=none|low|medium|high, intensity=0-100)\n";
+    std::cout << "  --protect <regex>          Sensitive root function (repeatable): obfuscate only the\n";
+    std::cout << "                             functions it reaches through direct calls\n";
+    std::cout << "  --protect-depth <n>        Call hops from the roots that are obfuscated (default: 2)\n";
+    std::cout << "  --outside-policy <policy>  Policy outside the allowed and protected functions\n";
+    std::cout << "                             (default: level=none)\n";
+    std::cout << "\nLink Options:\n";
+    std::cout << "  --link-lib <name>          Link an additional library (repeatable)\n";
+    std::cout << "  --link-object <file>       Link an additional object or archive (repeatable)\n";
+    std::cout << "  --link-path <dir>          Add a library search directory (repeatable)\n";
     std::cout << "\nReport Options:\n";
     std::cout << "  --report <path>            Report output path (default: obfuscation_report)\n";
     std::cout << "  --report-format <format>   Report format: json, html, both (default: json)\n";
+    std::cout << "  --trace <file>             Write stage/cycle/pass spans as a Chrome/Perfetto trace\n";
+    std::cout << "  --trace-functions          With --trace, add a span per function in parallel passes\n";
+    std::cout << "  --perf-counters            Report cycles, instructions, LLC and branch misses per pass\n";
+    std::cout << "                             and stage (Linux perf_event_open)\n";
+    std::cout << "  --memory-profile           Report peak RSS, allocations and IR growth per pass and cycle\n";
     std::cout << "\nExamples:\n";
     std::cout << "  # Basic obfuscation\n";
     std::cout << "  phantron-llvm-obfuscator input.c output\n\n";
@@ -201,6 +466,8 @@ void CLIParser::printHelp() const {
     std::cout << "                  --auto-tune-goal security input.cpp output\n\n";
     std::cout << "  # Manual high-level obfuscation\n";
     std::cout << "  phantron-llvm-obfuscator -l high --cycles 5 input.cpp output\n\n";
+    std::cout << "  # Obfuscate and link a multi-file project on 8 workers\n";
+    std::cout << "  phantron-llvm-obfuscator -j 8 -o app src/*.c\n\n";
     std::cout << "  # Load config and auto-tune\n";
     std::cout << "  phantron-llvm-obfuscator -c config.yaml --auto-tune --auto-tune-iterations 8 input.c\n\n";
 }
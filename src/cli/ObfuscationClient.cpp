@@ -0,0 +1,173 @@
+/**
+ * @file ObfuscationClient.cpp
+ * @brief Implementation of ObfuscationClient
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "ObfuscationClient.h"
+#include "ServerProtocol.h"
+#include "MetricsCollector.h"
+#include "ReportGenerator.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace obfuscator {
+
+namespace {
+
+constexpr size_t MAX_RESPONSE_SIZE = size_t(1) << 30;
+
+uint64_t toNumber(const std::string& value) {
+    unsigned long long number = 0;
+    llvm::StringRef(value).getAsInteger(10, number);
+    return number;
+}
+
+} // anonymous namespace
+
+ObfuscationClient::ObfuscationClient(const std::string& socketPath)
+    : socketPath_(socketPath) {
+}
+
+std::vector<std::string> ObfuscationClient::forwardedArguments(int argc, char* argv[]) {
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--connect") {
+            ++i;
+        } else if (arg != "--send-input" && arg != "--server-status") {
+            args.push_back(arg);
+        }
+    }
+    return args;
+}
+
+int ObfuscationClient::connectToServer() const {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    std::strncpy(address.sun_path, socketPath_.c_str(), sizeof(address.sun_path) - 1);
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        return -1;
+    }
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        std::cerr << "Cannot connect to server at " << socketPath_ << ": "
+                  << std::strerror(errno) << "\n";
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int ObfuscationClient::obfuscate(const std::vector<std::string>& args,
+                                 const ObfuscationConfig& config, const std::string& inputFile,
+                                 const std::string& outputFile, bool sendInput) {
+    ServerMessage request;
+    request.add("request", "obfuscate");
+
+    llvm::SmallString<256> cwd;
+    llvm::sys::fs::current_path(cwd);
+    request.add("cwd", cwd.str());
+    for (const auto& arg : args) {
+        request.add("arg", arg);
+    }
+
+    if (sendInput) {
+        auto input = llvm::MemoryBuffer::getFile(inputFile, /*IsText=*/false,
+                                                 /*RequiresNullTerminator=*/false);
+        if (!input) {
+            std::cerr << "Cannot read " << inputFile << "\n";
+            return 1;
+        }
+        request.add("input-data", (*input)->getBuffer());
+    }
+
+    int fd = connectToServer();
+    if (fd < 0) {
+        return 1;
+    }
+    ServerMessage response;
+    bool answered = request.write(fd) && response.read(fd, MAX_RESPONSE_SIZE);
+    ::close(fd);
+    if (!answered) {
+        std::cerr << "No response from server at " << socketPath_ << "\n";
+        return 1;
+    }
+
+    if (response.get("status") != "ok") {
+        std::cerr << "Obfuscation failed on server: " << response.get("error") << "\n";
+        return 1;
+    }
+
+    if (sendInput) {
+        std::error_code ec;
+        llvm::raw_fd_ostream out(outputFile, ec, llvm::sys::fs::OF_None);
+        if (ec) {
+            std::cerr << "Cannot write " << outputFile << ": " << ec.message() << "\n";
+            return 1;
+        }
+        out << response.get("output-data");
+        out.close();
+        llvm::sys::fs::setPermissions(outputFile, llvm::sys::fs::all_read |
+                                                  llvm::sys::fs::all_exe |
+                                                  llvm::sys::fs::owner_write);
+    }
+
+    // Same summary a local run prints
+    if (config.generateMetrics) {
+        auto metrics = std::make_shared<MetricsCollector>();
+        metrics->recordFileSizes(toNumber(response.get("original-size")),
+                                 toNumber(response.get("obfuscated-size")));
+        auto& m = metrics->getMetricsMutable();
+        m.stringsEncrypted = static_cast<uint32_t>(toNumber(response.get("strings-encrypted")));
+        m.totalTime = std::chrono::milliseconds(toNumber(response.get("total-ms")));
+
+        ReportGenerator reportGen(config);
+        reportGen.setMetricsCollector(metrics);
+        reportGen.printSummary();
+    }
+
+    if (config.verbose) {
+        std::cout << "Jobs queued ahead: " << response.get("queue-depth") << "\n";
+    }
+    std::cout << "Output written to: " << outputFile << "\n";
+    return 0;
+}
+
+int ObfuscationClient::printStatus() {
+    ServerMessage request;
+    request.add("request", "status");
+
+    int fd = connectToServer();
+    if (fd < 0) {
+        return 1;
+    }
+    ServerMessage response;
+    bool answered = request.write(fd) && response.read(fd, MAX_RESPONSE_SIZE);
+    ::close(fd);
+    if (!answered || response.get("status") != "ok") {
+        std::cerr << "No status from server at " << socketPath_ << "\n";
+        return 1;
+    }
+
+    std::cout << "Workers: " << response.get("workers") << "\n";
+    std::cout << "Queue depth: " << response.get("queue-depth") << "\n";
+    std::cout << "Active jobs: " << response.get("active") << "\n";
+    std::cout << "Completed jobs: " << response.get("completed") << "\n";
+    std::cout << "Failed jobs: " << response.get("failed") << "\n";
+    return 0;
+}
+
+} // namespace obfuscator
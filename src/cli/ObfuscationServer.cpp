@@ -0,0 +1,377 @@
+/**
+ * @file ObfuscationServer.cpp
+ * @brief Implementation of ObfuscationServer
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "ObfuscationServer.h"
+#include "CLIParser.h"
+#include "ProjectBuilder.h"
+#include "Logger.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace obfuscator {
+
+namespace {
+
+constexpr size_t MAX_REQUEST_SIZE = size_t(1) << 30;
+constexpr size_t MAX_ENGINES_PER_WORKER = 4;
+constexpr int REQUEST_TIMEOUT_MS = 30000;
+constexpr size_t MAX_PENDING_CONNECTIONS = 64;
+constexpr int POLL_INTERVAL_MS = 200;
+
+volatile sig_atomic_t stopRequested = 0;
+
+std::string resolvePath(const std::string& cwd, const std::string& path) {
+    if (path.empty() || llvm::sys::path::is_absolute(path)) {
+        return path;
+    }
+    llvm::SmallString<256> resolved(cwd);
+    llvm::sys::path::append(resolved, path);
+    return std::string(resolved.str());
+}
+
+/**
+ * @brief Key of the engine a configuration can reuse
+ */
+std::string engineKey(const ObfuscationConfig& config) {
+    return config.fingerprint() + "cache-dir=" + config.cacheDirectory + "\n" +
+           "cache-size=" + std::to_string(config.cacheMaxSize) + "\n" +
+           "in-memory=" + std::to_string(config.inMemoryPipeline) + "\n" +
+           "low-memory=" + std::to_string(config.lowMemory) + "," +
+           std::to_string(config.batchFunctions) + "\n" +
+           "pass-jobs=" + std::to_string(config.passJobs) + "\n" +
+           "verbose=" + std::to_string(config.verbose) + "\n";
+}
+
+ServerMessage makeError(const std::string& message) {
+    ServerMessage response;
+    response.add("status", "failed");
+    response.add("error", message);
+    return response;
+}
+
+} // anonymous namespace
+
+ObfuscationServer::ObfuscationServer(const ObfuscationConfig& config)
+    : config_(config), draining_(false), readers_(0), activeJobs_(0), completedJobs_(0),
+      failedJobs_(0) {
+    workerCount_ = config_.jobs;
+    if (workerCount_ == 0) {
+        workerCount_ = std::max(1u, std::thread::hardware_concurrency());
+    }
+}
+
+ObfuscationServer::~ObfuscationServer() {
+}
+
+void ObfuscationServer::requestStop() {
+    stopRequested = 1;
+}
+
+size_t ObfuscationServer::getQueueDepth() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return queue_.size();
+}
+
+bool ObfuscationServer::run(const std::string& socketPath) {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (socketPath.size() >= sizeof(address.sun_path)) {
+        Logger::getInstance().error("Socket path too long: " + socketPath);
+        return false;
+    }
+    std::strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+    int listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (listener < 0) {
+        Logger::getInstance().error("Cannot create socket: " + std::string(std::strerror(errno)));
+        return false;
+    }
+
+    // A socket file nobody answers on is left over from a crashed server
+    if (::connect(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0) {
+        Logger::getInstance().error("Another server is listening on " + socketPath);
+        ::close(listener);
+        return false;
+    }
+    ::close(listener);
+    listener = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    ::unlink(socketPath.c_str());
+
+    // Jobs read and write files as this user, so only this user may connect
+    mode_t oldMask = ::umask(0077);
+    int bound = ::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+    ::umask(oldMask);
+    if (bound != 0 || ::listen(listener, SOMAXCONN) != 0) {
+        Logger::getInstance().error("Cannot listen on " + socketPath + ": " +
+                                    std::strerror(errno));
+        ::close(listener);
+        return false;
+    }
+
+    Logger::getInstance().info("Serving on " + socketPath + " with " +
+                               std::to_string(workerCount_) + " workers");
+
+    std::vector<std::thread> workers;
+    for (uint32_t i = 0; i < workerCount_; ++i) {
+        workers.emplace_back(&ObfuscationServer::runWorker, this);
+    }
+
+    while (!stopRequested) {
+        pollfd pending = {listener, POLLIN, 0};
+        int ready = ::poll(&pending, 1, POLL_INTERVAL_MS);
+        if (ready <= 0) {
+            continue;
+        }
+        int fd = ::accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+        if (fd < 0) {
+            continue;
+        }
+
+        // Requests are read off this thread, so a slow client cannot stall accepting
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (readers_ >= MAX_PENDING_CONNECTIONS) {
+                makeError("Server busy").write(fd);
+                ::close(fd);
+                continue;
+            }
+            readers_++;
+        }
+        std::thread(&ObfuscationServer::readRequest, this, fd).detach();
+    }
+
+    Logger::getInstance().info("Shutting down, finishing " + std::to_string(getQueueDepth()) +
+                               " queued jobs");
+    ::close(listener);
+    ::unlink(socketPath.c_str());
+
+    // Readers may still queue jobs; each is done within its request deadline
+    {
+        std::unique_lock<std::mutex> lock(mutex_);
+        readersDone_.wait(lock, [this] { return readers_ == 0; });
+        draining_ = true;
+    }
+    available_.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return true;
+}
+
+void ObfuscationServer::readRequest(int fd) {
+    Job job;
+    job.fd = fd;
+    std::string kind;
+    if (!job.request.read(fd, MAX_REQUEST_SIZE, REQUEST_TIMEOUT_MS)) {
+        makeError("Malformed request").write(fd);
+        ::close(fd);
+    } else if ((kind = job.request.get("request")) == "status") {
+        makeStatus().write(fd);
+        ::close(fd);
+    } else if (kind != "obfuscate") {
+        makeError("Unknown request: " + kind).write(fd);
+        ::close(fd);
+    } else {
+        std::lock_guard<std::mutex> lock(mutex_);
+        job.queueDepth = queue_.size();
+        queue_.push_back(std::move(job));
+        available_.notify_one();
+    }
+
+    // Notified under the lock, so run() cannot return before this thread is done with it
+    std::lock_guard<std::mutex> lock(mutex_);
+    readers_--;
+    readersDone_.notify_all();
+}
+
+void ObfuscationServer::runWorker() {
+    EngineCache engines;
+
+    while (true) {
+        Job job;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            available_.wait(lock, [this] { return draining_ || !queue_.empty(); });
+            if (queue_.empty()) {
+                return;
+            }
+            job = std::move(queue_.front());
+            queue_.pop_front();
+        }
+
+        // One bad job must not take the daemon down with it
+        activeJobs_++;
+        ServerMessage response;
+        try {
+            response = processJob(job, engines);
+        } catch (const std::exception& e) {
+            response = makeError(std::string("Job failed: ") + e.what());
+        }
+        activeJobs_--;
+
+        if (response.get("status") == "ok") {
+            completedJobs_++;
+        } else {
+            failedJobs_++;
+        }
+        response.add("queue-depth", std::to_string(job.queueDepth));
+        response.write(job.fd);
+        ::close(job.fd);
+    }
+}
+
+ServerMessage ObfuscationServer::processJob(const Job& job, EngineCache& engines) {
+    // Arguments are parsed exactly as the command line would be
+    std::vector<std::string> args = job.request.getAll("arg");
+    args.insert(args.begin(), "phantron-llvm-obfuscator");
+    std::vector<char*> argv;
+    for (auto& arg : args) {
+        argv.push_back(&arg[0]);
+    }
+
+    CLIParser parser;
+    if (!parser.parse(static_cast<int>(argv.size()), argv.data())) {
+        return makeError("Invalid arguments");
+    }
+    if (parser.isServeMode() || parser.isManifestMode() || parser.isClientMode() ||
+        parser.isAutoTuneEnabled() || parser.getInputFiles().empty()) {
+        return makeError("Only obfuscation jobs can run on the server");
+    }
+
+    // Relative paths are relative to the client, not to the server
+    std::string cwd = job.request.get("cwd");
+    ObfuscationConfig config = parser.getConfig();
+    config.reportPath = resolvePath(cwd, config.reportPath);
+    config.cacheDirectory = resolvePath(cwd, config.cacheDirectory);
+    for (auto& object : config.linkObjects) {
+        object = resolvePath(cwd, object);
+    }
+    for (auto& path : config.linkSearchPaths) {
+        path = resolvePath(cwd, path);
+    }
+
+    std::string outputFile = resolvePath(cwd, parser.getOutputFile());
+    std::vector<std::string> inputFiles;
+    for (const auto& input : parser.getInputFiles()) {
+        inputFiles.push_back(resolvePath(cwd, input));
+    }
+
+    // Inputs sent as bytes are staged next to a private output file
+    llvm::SmallString<128> stagedInput;
+    llvm::SmallString<128> stagedOutput;
+    bool staged = job.request.has("input-data");
+    if (staged) {
+        if (inputFiles.size() != 1) {
+            return makeError("Only single inputs can be sent as data");
+        }
+        std::string extension = llvm::sys::path::extension(inputFiles.front()).str();
+        if (!extension.empty()) {
+            extension = extension.substr(1);
+        }
+        if (llvm::sys::fs::createTemporaryFile("phantron-job", extension, stagedInput) ||
+            llvm::sys::fs::createTemporaryFile("phantron-job-out", "", stagedOutput)) {
+            return makeError("Cannot stage job input");
+        }
+        std::error_code ec;
+        llvm::raw_fd_ostream out(stagedInput, ec, llvm::sys::fs::OF_None);
+        if (!ec) {
+            out << job.request.get("input-data");
+            out.close();
+        }
+        if (ec || out.has_error()) {
+            out.clear_error();
+            llvm::sys::fs::remove(stagedInput);
+            llvm::sys::fs::remove(stagedOutput);
+            return makeError("Cannot stage job input");
+        }
+        inputFiles = {std::string(stagedInput.str())};
+        outputFile = std::string(stagedOutput.str());
+    }
+
+    bool success = false;
+    std::shared_ptr<ReportGenerator> reportGen;
+    if (inputFiles.size() > 1) {
+        ProjectBuilder builder(config);
+        success = builder.build(inputFiles, outputFile);
+        reportGen = builder.getReportGenerator();
+    } else {
+        std::string key = engineKey(config);
+        auto cached = std::find_if(engines.begin(), engines.end(),
+                                   [&](const auto& entry) { return entry.first == key; });
+        if (cached != engines.end()) {
+            engines.splice(engines.begin(), engines, cached);
+        } else {
+            engines.emplace_front(key, std::make_unique<ObfuscationEngine>(config));
+            if (engines.size() > MAX_ENGINES_PER_WORKER) {
+                engines.pop_back();
+            }
+        }
+
+        ObfuscationEngine& engine = *engines.front().second;
+        success = engine.processFile(inputFiles.front(), outputFile);
+        reportGen = engine.getReportGenerator();
+    }
+
+    ServerMessage response;
+    if (!success) {
+        response = makeError("Obfuscation failed");
+    } else {
+        response.add("status", "ok");
+        if (staged) {
+            auto binary = llvm::MemoryBuffer::getFile(stagedOutput, /*IsText=*/false,
+                                                      /*RequiresNullTerminator=*/false);
+            if (binary) {
+                response.add("output-data", (*binary)->getBuffer());
+            } else {
+                response = makeError("Cannot read obfuscated binary");
+            }
+        }
+        if (config.generateMetrics && !staged) {
+            reportGen->generateReport(config.reportPath);
+        }
+
+        const auto& m = reportGen->getMetricsCollector()->getMetrics();
+        response.add("original-size", std::to_string(m.originalFileSize));
+        response.add("obfuscated-size", std::to_string(m.obfuscatedFileSize));
+        response.add("strings-encrypted", std::to_string(m.stringsEncrypted));
+        response.add("total-ms", std::to_string(m.totalTime.count()));
+    }
+
+    if (staged) {
+        llvm::sys::fs::remove(stagedInput);
+        llvm::sys::fs::remove(stagedOutput);
+    }
+    return response;
+}
+
+ServerMessage ObfuscationServer::makeStatus() const {
+    ServerMessage status;
+    status.add("status", "ok");
+    status.add("workers", std::to_string(workerCount_));
+    status.add("queue-depth", std::to_string(getQueueDepth()));
+    status.add("active", std::to_string(activeJobs_.load()));
+    status.add("completed", std::to_string(completedJobs_.load()));
+    status.add("failed", std::to_string(failedJobs_.load()));
+    return status;
+}
+
+} // namespace obfuscator
@@ -0,0 +1,191 @@
+/**
+ * @file ServerProtocol.cpp
+ * @brief Implementation of ServerMessage
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "ServerProtocol.h"
+#include <chrono>
+#include <cerrno>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+namespace obfuscator {
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Wait until fd has data or the deadline passes (no deadline if null)
+ */
+bool waitReadable(int fd, const Clock::time_point* deadline) {
+    if (!deadline) {
+        return true;
+    }
+    while (true) {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(
+            *deadline - Clock::now()).count();
+        if (remaining <= 0) {
+            return false;
+        }
+        pollfd pending = {fd, POLLIN, 0};
+        int ready = ::poll(&pending, 1, static_cast<int>(remaining));
+        if (ready > 0) {
+            return true;
+        }
+        if (ready < 0 && errno != EINTR) {
+            return false;
+        }
+    }
+}
+
+bool readByte(int fd, char& c, const Clock::time_point* deadline) {
+    while (true) {
+        if (!waitReadable(fd, deadline)) {
+            return false;
+        }
+        ssize_t n = ::read(fd, &c, 1);
+        if (n == 1) {
+            return true;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        return false;
+    }
+}
+
+bool readExact(int fd, char* data, size_t size, const Clock::time_point* deadline) {
+    while (size > 0) {
+        if (!waitReadable(fd, deadline)) {
+            return false;
+        }
+        ssize_t n = ::read(fd, data, size);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool writeAll(int fd, const char* data, size_t size) {
+    while (size > 0) {
+        // No SIGPIPE when the peer is gone, just a failed write
+        ssize_t n = ::send(fd, data, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+void ServerMessage::add(const std::string& name, llvm::StringRef value) {
+    fields_.emplace_back(name, value.str());
+}
+
+std::string ServerMessage::get(llvm::StringRef name) const {
+    for (const auto& field : fields_) {
+        if (field.first == name) {
+            return field.second;
+        }
+    }
+    return std::string();
+}
+
+std::vector<std::string> ServerMessage::getAll(llvm::StringRef name) const {
+    std::vector<std::string> values;
+    for (const auto& field : fields_) {
+        if (field.first == name) {
+            values.push_back(field.second);
+        }
+    }
+    return values;
+}
+
+bool ServerMessage::has(llvm::StringRef name) const {
+    for (const auto& field : fields_) {
+        if (field.first == name) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool ServerMessage::read(int fd, size_t maxSize, int timeoutMs) {
+    fields_.clear();
+    size_t total = 0;
+
+    // One deadline for the whole message, so trickling bytes cannot extend it
+    Clock::time_point deadline = Clock::now() + std::chrono::milliseconds(timeoutMs);
+    const Clock::time_point* limit = timeoutMs >= 0 ? &deadline : nullptr;
+
+    while (true) {
+        // Header: "<name> <length>\n", short enough to read bytewise
+        std::string header;
+        char c = 0;
+        while (readByte(fd, c, limit) && c != '\n') {
+            if (header.size() > 256) {
+                return false;
+            }
+            header += c;
+        }
+        if (c != '\n') {
+            return false;
+        }
+
+        size_t space = header.rfind(' ');
+        if (space == std::string::npos || space == 0) {
+            return false;
+        }
+        std::string name = header.substr(0, space);
+        unsigned long long length = 0;
+        if (llvm::StringRef(header).substr(space + 1).getAsInteger(10, length)) {
+            return false;
+        }
+        if (name == "end") {
+            return true;
+        }
+
+        // Compared before adding, so a huge length cannot wrap the total
+        if (length > maxSize - total) {
+            return false;
+        }
+        total += length;
+
+        std::string value(length, '\0');
+        char newline = 0;
+        if (!readExact(fd, &value[0], length, limit) || !readByte(fd, newline, limit) ||
+            newline != '\n') {
+            return false;
+        }
+        fields_.emplace_back(std::move(name), std::move(value));
+    }
+}
+
+bool ServerMessage::write(int fd) const {
+    std::string data;
+    for (const auto& field : fields_) {
+        data += field.first + " " + std::to_string(field.second.size()) + "\n";
+        data += field.second;
+        data += '\n';
+    }
+    data += "end 0\n";
+    return writeAll(fd, data.data(), data.size());
+}
+
+} // namespace obfuscator
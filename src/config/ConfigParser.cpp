@@ -8,10 +8,91 @@
 #include "ConfigParser.h"
 #include "FileUtils.h"
 #include "Logger.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/YAMLParser.h"
+#include <map>
 #include <sstream>
+#include <utility>
+#include <vector>
 
 namespace obfuscator {
 
+namespace {
+
+/**
+ * @brief Settings of a configuration file, keyed "section.key"
+ */
+struct Settings {
+    std::map<std::string, std::string> scalars;
+    std::map<std::string, std::vector<std::string>> lists;  // Sequences of scalars
+    std::map<std::string, std::vector<std::pair<std::string, std::string>>> tables;  // Mappings, in file order
+};
+
+std::string getValue(llvm::yaml::ScalarNode& scalar) {
+    llvm::SmallString<32> storage;
+    return scalar.getValue(storage).str();
+}
+
+// Flatten a two-level mapping into "section.key" -> value; scalars nested
+// deeper, in sequences or in mappings, are kept as lists and tables
+bool collectSettings(llvm::yaml::MappingNode& mapping, const std::string& prefix,
+                     Settings& settings) {
+    for (auto& entry : mapping) {
+        auto* keyNode = llvm::dyn_cast_or_null<llvm::yaml::ScalarNode>(entry.getKey());
+        llvm::yaml::Node* valueNode = entry.getValue();
+        if (!keyNode || !valueNode) {
+            return false;
+        }
+        std::string key = prefix + getValue(*keyNode);
+
+        if (auto* scalar = llvm::dyn_cast<llvm::yaml::ScalarNode>(valueNode)) {
+            settings.scalars[key] = getValue(*scalar);
+        } else if (auto* sequence = llvm::dyn_cast<llvm::yaml::SequenceNode>(valueNode)) {
+            auto& list = settings.lists[key];
+            for (auto& item : *sequence) {
+                if (auto* scalar = llvm::dyn_cast<llvm::yaml::ScalarNode>(&item)) {
+                    list.push_back(getValue(*scalar));
+                }
+            }
+        } else if (auto* section = llvm::dyn_cast<llvm::yaml::MappingNode>(valueNode)) {
+            if (prefix.empty()) {
+                if (!collectSettings(*section, key + ".", settings)) {
+                    return false;
+                }
+                continue;
+            }
+            auto& table = settings.tables[key];
+            for (auto& row : *section) {
+                auto* rowKey = llvm::dyn_cast_or_null<llvm::yaml::ScalarNode>(row.getKey());
+                auto* rowValue = llvm::dyn_cast_or_null<llvm::yaml::ScalarNode>(row.getValue());
+                if (rowKey && rowValue) {
+                    table.emplace_back(getValue(*rowKey), getValue(*rowValue));
+                }
+            }
+        }
+    }
+    return true;
+}
+
+bool parseBool(const std::string& text, bool& value) {
+    if (text == "true" || text == "yes" || text == "on") {
+        value = true;
+    } else if (text == "false" || text == "no" || text == "off") {
+        value = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+bool parseUnsigned(const std::string& text, uint32_t& value) {
+    // getAsInteger returns true on error
+    return !llvm::StringRef(text).getAsInteger(10, value);
+}
+
+} // anonymous namespace
+
 ConfigParser::ConfigParser() {
 }
 
@@ -25,6 +106,10 @@ bool ConfigParser::parseFile(const std::string& filepath, ObfuscationConfig& con
     }
     
     std::string content = FileUtils::readFile(filepath);
+    llvm::StringRef path(filepath);
+    if (path.endswith(".yaml") || path.endswith(".yml")) {
+        return parseYAML(content, config);
+    }
     return parseJSON(content, config);
 }
 
@@ -38,6 +123,111 @@ bool ConfigParser::parseJSON(const std::string& json, ObfuscationConfig& config)
     return true;
 }
 
+bool ConfigParser::parseYAML(const std::string& yaml, ObfuscationConfig& config) {
+    llvm::SourceMgr sourceManager;
+    llvm::yaml::Stream stream(yaml, sourceManager);
+    Settings parsed;
+    auto& settings = parsed.scalars;
+
+    for (auto& document : stream) {
+        auto* root = llvm::dyn_cast_or_null<llvm::yaml::MappingNode>(document.getRoot());
+        if (root && !collectSettings(*root, "", parsed)) {
+            Logger::getInstance().error("Malformed configuration mapping");
+            return false;
+        }
+    }
+    if (stream.failed()) {
+        Logger::getInstance().error("Configuration is not valid YAML");
+        return false;
+    }
+
+    auto level = settings.find("obfuscation.level");
+    if (level != settings.end()) {
+        if (level->second == "low") {
+            config.applyPreset(ObfuscationLevel::LOW);
+        } else if (level->second == "medium") {
+            config.applyPreset(ObfuscationLevel::MEDIUM);
+        } else if (level->second == "high") {
+            config.applyPreset(ObfuscationLevel::HIGH);
+        } else {
+            Logger::getInstance().error("Invalid obfuscation.level: " + level->second);
+            return false;
+        }
+    }
+
+    bool valid = true;
+    auto flag = [&](const char* key, bool& field) {
+        auto it = settings.find(key);
+        if (it != settings.end() && !parseBool(it->second, field)) {
+            Logger::getInstance().error(std::string("Invalid boolean for ") + key + ": " + it->second);
+            valid = false;
+        }
+    };
+    auto number = [&](const char* key, uint32_t& field) {
+        auto it = settings.find(key);
+        if (it != settings.end() && !parseUnsigned(it->second, field)) {
+            Logger::getInstance().error(std::string("Invalid number for ") + key + ": " + it->second);
+            valid = false;
+        }
+    };
+
+    number("obfuscation.cycles", config.obfuscationCycles);
+    number("obfuscation.seed", config.seed);
+    flag("obfuscation.verbose", config.verbose);
+    number("obfuscation.hot_loop_threshold", config.hotLoopThreshold);
+
+    flag("control_flow.flattening_enabled", config.enableControlFlowFlattening);
+    number("control_flow.flattening_complexity", config.flatteningComplexity);
+    flag("control_flow.opaque_predicates", config.enableOpaquePredicates);
+    number("control_flow.opaque_count", config.opaquePredicateCount);
+    flag("control_flow.bogus_control_flow", config.enableBogusControlFlow);
+    number("control_flow.bogus_probability", config.bogusBlockProbability);
+
+    flag("instructions.substitution", config.enableInstructionSubstitution);
+    number("instructions.substitution_probability", config.substitutionProbability);
+    flag("instructions.dead_code", config.enableDeadCodeInjection);
+    number("instructions.dead_code_ratio", config.deadCodeRatio);
+
+    flag("data_obfuscation.string_encryption", config.enableStringEncryption);
+    auto algorithm = settings.find("data_obfuscation.string_algorithm");
+    if (algorithm != settings.end()) {
+        config.stringEncryptionAlgorithm = algorithm->second;
+    }
+    flag("data_obfuscation.constant_obfuscation", config.enableConstantObfuscation);
+    number("data_obfuscation.constant_complexity", config.constantObfuscationComplexity);
+
+    flag("advanced.function_virtualization", config.enableFunctionVirtualization);
+    flag("advanced.call_graph_obfuscation", config.enableCallGraphObfuscation);
+    flag("advanced.anti_debug", config.enableAntiDebug);
+    flag("advanced.cache_obfuscation", config.enableHardwareCacheObfuscation);
+    number("advanced.cache_obfuscation_intensity", config.cacheObfuscationIntensity);
+
+    auto list = [&](const char* key, std::vector<std::string>& field) {
+        auto it = parsed.lists.find(key);
+        if (it != parsed.lists.end()) {
+            field = it->second;
+        }
+    };
+    list("functions.allow", config.functionAllowList);
+    list("functions.deny", config.functionDenyList);
+    list("functions.protect", config.protectedRoots);
+    number("functions.protect_depth", config.protectedDepth);
+    auto outside = settings.find("functions.outside_policy");
+    if (outside != settings.end()) {
+        config.outsidePolicy = outside->second;
+    }
+    auto policies = parsed.tables.find("functions.policies");
+    if (policies != parsed.tables.end()) {
+        config.functionPolicies = policies->second;
+    }
+
+    if (valid && !config.validate()) {
+        Logger::getInstance().error("Configuration values out of range");
+        valid = false;
+    }
+    return valid;
+}
+
 bool ConfigParser::validateJSON(const std::string& json) {
     return !json.empty();
 }
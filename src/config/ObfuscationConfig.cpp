@@ -6,7 +6,12 @@
  */
 
 #include "ObfuscationConfig.h"
+#include "FunctionPolicy.h"
+#include "llvm/Support/Regex.h"
+#include <algorithm>
 #include <ctime>
+#include <sstream>
+#include <thread>
 
 namespace obfuscator {
 
@@ -16,6 +21,13 @@ ObfuscationConfig::ObfuscationConfig()
       obfuscationCycles(3),
       seed(static_cast<uint32_t>(std::time(nullptr))),
       verbose(false),
+      inMemoryPipeline(false),
+      jobs(0),
+      passJobs(1),
+      codegenJobs(1),
+      lowMemory(false),
+      batchFunctions(256),
+      discardValueNames(false),
       enableControlFlowFlattening(true),
       flatteningComplexity(60),
       enableOpaquePredicates(true),
@@ -37,9 +49,17 @@ ObfuscationConfig::ObfuscationConfig()
       enableCallGraphObfuscation(true),
       enableAntiDebug(true),
       enableAntiTamper(false),
+      hotLoopThreshold(0),
+      protectedDepth(2),
+      outsidePolicy("level=none"),
+      cacheMaxSize(1ull << 30),
+      incremental(false),
       reportFormat("json"),
       reportPath("obfuscation_report"),
-      generateMetrics(true) {
+      generateMetrics(true),
+      traceFunctions(false),
+      perfCounters(false),
+      memoryProfile(false) {
 }
 
 void ObfuscationConfig::applyPreset(ObfuscationLevel preset) {
@@ -158,7 +178,98 @@ bool ObfuscationConfig::validate() const {
         return false;
     }
     
+    // Function bodies are kept in the result cache
+    if (incremental && cacheDirectory.empty()) {
+        return false;
+    }
+    
+    if (lowMemory && batchFunctions == 0) {
+        return false;
+    }
+    
+    // One worker count per pipeline stage, none of them zero
+    if (!pipelineWorkers.empty() &&
+        (pipelineWorkers.size() != 4 ||
+         std::find(pipelineWorkers.begin(), pipelineWorkers.end(), 0u) != pipelineWorkers.end())) {
+        return false;
+    }
+    
+    for (const auto* patterns : {&functionAllowList, &functionDenyList, &protectedRoots}) {
+        for (const auto& pattern : *patterns) {
+            if (!llvm::Regex(pattern).isValid()) {
+                return false;
+            }
+        }
+    }
+    for (const auto& rule : functionPolicies) {
+        FunctionPolicy policy;
+        if (!llvm::Regex(rule.first).isValid() || !FunctionPolicy::parse(rule.second, policy)) {
+            return false;
+        }
+    }
+    FunctionPolicy outside;
+    if (!FunctionPolicy::parse(outsidePolicy, outside)) {
+        return false;
+    }
+    
     return true;
 }
 
+std::string ObfuscationConfig::fingerprint() const {
+    std::ostringstream out;
+    out << "level=" << static_cast<int>(level) << "\n";
+    out << "target=" << static_cast<int>(targetPlatform) << "\n";
+    out << "cycles=" << obfuscationCycles << "\n";
+    out << "seed=" << seed << "\n";
+    // Sharded and incremental runs give the same code up to use-list order,
+    // not bit for bit
+    out << "sharded=" << (passJobs != 1) << "\n";
+    out << "incremental=" << incremental << "\n";
+    // Partitioned codegen lays out and names symbols differently
+    out << "codegen=" << (codegenJobs == 0 ? std::thread::hardware_concurrency() : codegenJobs)
+        << "\n";
+    out << "flatten=" << enableControlFlowFlattening << "," << flatteningComplexity << "\n";
+    out << "opaque=" << enableOpaquePredicates << "," << opaquePredicateCount << "\n";
+    out << "bogus=" << enableBogusControlFlow << "," << bogusBlockProbability << "\n";
+    out << "substitution=" << enableInstructionSubstitution << ","
+        << substitutionProbability << "\n";
+    out << "deadcode=" << enableDeadCodeInjection << "," << deadCodeRatio << "\n";
+    out << "cache=" << enableHardwareCacheObfuscation << "," << cacheObfuscationIntensity << "\n";
+    out << "strings=" << enableStringEncryption << "," << stringEncryptionAlgorithm << "\n";
+    out << "constants=" << enableConstantObfuscation << "," << constantObfuscationComplexity << "\n";
+    out << "virtualization=" << enableFunctionVirtualization << "," << virtualizationThreshold << "\n";
+    out << "callgraph=" << enableCallGraphObfuscation << "\n";
+    out << "antidebug=" << enableAntiDebug << "\n";
+    out << "antitamper=" << enableAntiTamper << "\n";
+    out << "hotloop=" << hotLoopThreshold << "\n";
+    for (const auto& pattern : functionAllowList) {
+        out << "allow=" << pattern << "\n";
+    }
+    for (const auto& pattern : functionDenyList) {
+        out << "deny=" << pattern << "\n";
+    }
+    for (const auto& rule : functionPolicies) {
+        out << "policy=" << rule.first << " " << rule.second << "\n";
+    }
+    for (const auto& pattern : protectedRoots) {
+        out << "protect=" << pattern << "\n";
+    }
+    if (!functionAllowList.empty() || !protectedRoots.empty()) {
+        out << "outside=" << protectedDepth << "," << outsidePolicy << "\n";
+    }
+
+    // Link settings only matter for binaries, but are cheap to include
+    for (const auto& library : linkLibraries) {
+        out << "lib=" << library << "\n";
+    }
+    for (const auto& object : linkObjects) {
+        out << "object=" << object << "\n";
+    }
+    for (const auto& path : linkSearchPaths) {
+        out << "libpath=" << path << "\n";
+    }
+
+    return out.str();
+}
+
 } // namespace obfuscator
@@ -0,0 +1,78 @@
+/**
+ * @file BlockHotness.cpp
+ * @brief Implementation of BlockHotness
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "BlockHotness.h"
+#include "FunctionPolicy.h"
+#include "llvm/Analysis/BlockFrequencyInfo.h"
+#include "llvm/Analysis/LoopInfo.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
+#include "llvm/IR/Module.h"
+#include <algorithm>
+
+namespace obfuscator {
+
+BlockHotness::BlockHotness(llvm::Function& func, llvm::FunctionAnalysisManager& analyses,
+                           uint32_t hotLoopThreshold)
+    : policyIntensity_(FunctionPolicy::getIntensity(func)) {
+    // Flattening folds every block into one dispatch loop, and only happens
+    // to functions without hot blocks, so a flattened function stays cold
+    if (func.getMetadata("obfuscated.ControlFlowFlattening")) {
+        return;
+    }
+
+    auto& moduleProxy = analyses.getResult<llvm::ModuleAnalysisManagerFunctionProxy>(func);
+    auto* summary = moduleProxy.getCachedResult<llvm::ProfileSummaryAnalysis>(*func.getParent());
+
+    // A rarely entered function can still spin in a hot loop, so rate blocks, not entries
+    if (summary && summary->hasProfileSummary() && func.getEntryCount()) {
+        rateByProfile(func, analyses, *summary);
+    } else if (hotLoopThreshold > 0) {
+        rateByLoops(func, analyses, hotLoopThreshold);
+    }
+}
+
+void BlockHotness::rateByProfile(llvm::Function& func, llvm::FunctionAnalysisManager& analyses,
+                                 const llvm::ProfileSummaryInfo& summary) {
+    uint64_t hot = summary.getOrCompHotCountThreshold();
+    uint64_t cold = summary.getOrCompColdCountThreshold();
+    auto& frequencies = analyses.getResult<llvm::BlockFrequencyAnalysis>(func);
+
+    for (const auto& bb : func) {
+        auto count = frequencies.getBlockProfileCount(&bb);
+        if (!count || *count <= cold) {
+            continue;
+        }
+        setIntensity(&bb, *count >= hot || hot <= cold
+            ? 0
+            : static_cast<uint32_t>(100.0 - 100.0 * (*count - cold) / (hot - cold)));
+    }
+}
+
+void BlockHotness::rateByLoops(llvm::Function& func, llvm::FunctionAnalysisManager& analyses,
+                               uint32_t hotLoopThreshold) {
+    auto& loops = analyses.getResult<llvm::LoopAnalysis>(func);
+    if (loops.empty()) {
+        return;
+    }
+    auto& frequencies = analyses.getResult<llvm::BlockFrequencyAnalysis>(func);
+    uint64_t entry = frequencies.getEntryFreq();
+
+    for (const auto& bb : func) {
+        const llvm::Loop* loop = loops.getLoopFor(&bb);
+        if (!loop || frequencies.getBlockFreq(&bb).getFrequency() / entry < hotLoopThreshold) {
+            continue;
+        }
+        setIntensity(&bb, loop->isInnermost() ? 0 : 50);
+    }
+}
+
+void BlockHotness::setIntensity(const llvm::BasicBlock* bb, uint32_t intensity) {
+    intensity_[bb] = intensity;
+    functionIntensity_ = std::min(functionIntensity_, intensity);
+}
+
+} // namespace obfuscator
@@ -0,0 +1,125 @@
+/**
+ * @file ClangFrontend.cpp
+ * @brief Implementation of the in-process clang frontend
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "ClangFrontend.h"
+#include "FileUtils.h"
+#include "Logger.h"
+
+#ifdef PHANTRON_HAVE_CLANG
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/DiagnosticOptions.h"
+#include "clang/CodeGen/CodeGenAction.h"
+#include "clang/Driver/Compilation.h"
+#include "clang/Driver/Driver.h"
+#include "clang/Driver/Job.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/CompilerInvocation.h"
+#include "clang/Frontend/TextDiagnosticPrinter.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/raw_ostream.h"
+#endif
+
+namespace obfuscator {
+
+ClangFrontend::ClangFrontend(const std::vector<std::string>& extraArgs)
+    : extraArgs_(extraArgs) {
+}
+
+bool ClangFrontend::isAvailable() {
+#ifdef PHANTRON_HAVE_CLANG
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool ClangFrontend::isCppSource(const std::string& sourceFile) {
+    std::string ext = FileUtils::getFileExtension(sourceFile);
+    return ext == ".cpp" || ext == ".cxx" || ext == ".cc";
+}
+
+#ifdef PHANTRON_HAVE_CLANG
+
+std::unique_ptr<llvm::Module> ClangFrontend::compile(const std::string& sourceFile,
+                                                     llvm::LLVMContext& context) {
+    bool isCpp = isCppSource(sourceFile);
+
+    // The driver locates the resource directory (builtin headers) relative
+    // to the clang executable, so point it at the installed one if present
+    std::string driverName = isCpp ? "clang++" : "clang";
+    auto clangPath = llvm::sys::findProgramByName(driverName);
+    std::string driverPath = clangPath ? *clangPath : driverName;
+
+    llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions> diagOpts =
+        new clang::DiagnosticOptions();
+    auto* diagPrinter = new clang::TextDiagnosticPrinter(llvm::errs(), &*diagOpts);
+    llvm::IntrusiveRefCntPtr<clang::DiagnosticIDs> diagIDs(new clang::DiagnosticIDs());
+    clang::DiagnosticsEngine diags(diagIDs, &*diagOpts, diagPrinter);
+
+    // Same flags the subprocess frontend used: -emit-llvm -c -O1 -fPIC
+    std::vector<const char*> args = {
+        driverPath.c_str(), "-emit-llvm", "-c", "-O1", "-fPIC"
+    };
+    for (const auto& arg : extraArgs_) {
+        args.push_back(arg.c_str());
+    }
+    args.push_back(sourceFile.c_str());
+
+    // Let the driver expand system include paths and target options into
+    // the equivalent cc1 invocation
+    clang::driver::Driver driver(driverPath, llvm::sys::getDefaultTargetTriple(), diags);
+    driver.setCheckInputsExist(false);
+    std::unique_ptr<clang::driver::Compilation> compilation(driver.BuildCompilation(args));
+    if (!compilation || diags.hasErrorOccurred()) {
+        Logger::getInstance().error("Failed to build clang invocation for: " + sourceFile);
+        return nullptr;
+    }
+
+    const auto& jobs = compilation->getJobs();
+    if (jobs.size() != 1 || !llvm::isa<clang::driver::Command>(*jobs.begin())) {
+        Logger::getInstance().error("Unexpected clang job list for: " + sourceFile);
+        return nullptr;
+    }
+
+    const auto& command = llvm::cast<clang::driver::Command>(*jobs.begin());
+    const llvm::opt::ArgStringList& ccArgs = command.getArguments();
+
+    auto invocation = std::make_shared<clang::CompilerInvocation>();
+    if (!clang::CompilerInvocation::CreateFromArgs(*invocation, ccArgs, diags)) {
+        Logger::getInstance().error("Invalid clang arguments for: " + sourceFile);
+        return nullptr;
+    }
+
+    clang::CompilerInstance compiler;
+    compiler.setInvocation(invocation);
+    compiler.createDiagnostics();
+    if (!compiler.hasDiagnostics()) {
+        return nullptr;
+    }
+
+    // Emit straight into the caller's context instead of to a .bc file
+    clang::EmitLLVMOnlyAction action(&context);
+    if (!compiler.ExecuteAction(action)) {
+        Logger::getInstance().error("clang failed to compile: " + sourceFile);
+        return nullptr;
+    }
+
+    return action.takeModule();
+}
+
+#else
+
+std::unique_ptr<llvm::Module> ClangFrontend::compile(const std::string& /*sourceFile*/,
+                                                     llvm::LLVMContext& /*context*/) {
+    Logger::getInstance().error("In-process clang frontend not available in this build");
+    return nullptr;
+}
+
+#endif
+
+} // namespace obfuscator
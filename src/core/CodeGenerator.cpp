@@ -0,0 +1,236 @@
+/**
+ * @file CodeGenerator.cpp
+ * @brief Implementation of CodeGenerator
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "CodeGenerator.h"
+#include "Logger.h"
+#include "Tracer.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/LegacyPassManager.h"
+#include "llvm/MC/TargetRegistry.h"
+#include "llvm/Support/CodeGen.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/TargetSelect.h"
+#include "llvm/Target/TargetOptions.h"
+#include "llvm/Transforms/Utils/SplitModule.h"
+#include <algorithm>
+#include <mutex>
+#include <thread>
+
+namespace obfuscator {
+
+namespace {
+
+// Below this many instructions per partition, thread startup and the
+// extra link outweigh what parallel codegen saves
+constexpr uint64_t MIN_PARTITION_INSTRUCTIONS = 5000;
+
+} // anonymous namespace
+
+CodeGenerator::CodeGenerator() {
+    initializeTargets();
+}
+
+CodeGenerator::~CodeGenerator() {
+}
+
+void CodeGenerator::initializeTargets() {
+    static std::once_flag initFlag;
+    std::call_once(initFlag, []() {
+        llvm::InitializeNativeTarget();
+        llvm::InitializeNativeTargetAsmPrinter();
+        llvm::InitializeNativeTargetAsmParser();
+    });
+}
+
+llvm::TargetMachine* CodeGenerator::getTargetMachine(llvm::Module& module) {
+    std::string triple = module.getTargetTriple();
+    if (triple.empty()) {
+        triple = llvm::sys::getDefaultTargetTriple();
+        module.setTargetTriple(triple);
+    }
+
+    auto it = targetMachines_.find(triple);
+    if (it != targetMachines_.end()) {
+        return it->second.get();
+    }
+
+    std::string error;
+    const llvm::Target* target = llvm::TargetRegistry::lookupTarget(triple, error);
+    if (!target) {
+        Logger::getInstance().error("Unsupported target " + triple + ": " + error);
+        return nullptr;
+    }
+
+    // Mirror llc defaults: generic CPU/features (per-function attributes from
+    // the frontend still apply), target-default relocation model, -O2 codegen,
+    // and constructors in .init_array rather than .ctors
+    llvm::TargetOptions options;
+    options.UseInitArray = true;
+    std::unique_ptr<llvm::TargetMachine> machine(target->createTargetMachine(
+        triple, "", "", options, llvm::None, llvm::None,
+        llvm::CodeGenOpt::Default));
+    if (!machine) {
+        Logger::getInstance().error("Failed to create target machine for " + triple);
+        return nullptr;
+    }
+
+    llvm::TargetMachine* result = machine.get();
+    targetMachines_[triple] = std::move(machine);
+    return result;
+}
+
+bool CodeGenerator::emitObject(llvm::Module& module, const std::string& objectFile) {
+    std::error_code ec;
+    llvm::raw_fd_ostream dest(objectFile, ec, llvm::sys::fs::OF_None);
+
+    if (ec) {
+        Logger::getInstance().error("Failed to open object file: " + ec.message());
+        return false;
+    }
+
+    if (!emitObject(module, dest)) {
+        return false;
+    }
+
+    dest.flush();
+    return !dest.has_error();
+}
+
+bool CodeGenerator::emitObject(llvm::Module& module, llvm::raw_pwrite_stream& out) {
+    llvm::TargetMachine* machine = getTargetMachine(module);
+    if (!machine) {
+        return false;
+    }
+
+    if (module.getDataLayout().isDefault()) {
+        module.setDataLayout(machine->createDataLayout());
+    }
+
+    llvm::legacy::PassManager codegenPasses;
+    llvm::TargetLibraryInfoImpl tlii(llvm::Triple(module.getTargetTriple()));
+    codegenPasses.add(new llvm::TargetLibraryInfoWrapperPass(tlii));
+
+    if (machine->addPassesToEmitFile(codegenPasses, out, nullptr,
+                                     llvm::CGFT_ObjectFile)) {
+        Logger::getInstance().error("Target cannot emit object files");
+        return false;
+    }
+
+    codegenPasses.run(module);
+    return true;
+}
+
+bool CodeGenerator::emitObject(llvm::Module& module, llvm::SmallVectorImpl<char>& buffer) {
+    llvm::raw_svector_ostream out(buffer);
+    return emitObject(module, out);
+}
+
+bool CodeGenerator::emitPartitions(llvm::Module& module, uint32_t partitions,
+                                   std::vector<llvm::SmallVector<char, 0>>& objects) {
+    llvm::TargetMachine* machine = getTargetMachine(module);
+    if (!machine) {
+        return false;
+    }
+    if (module.getDataLayout().isDefault()) {
+        module.setDataLayout(machine->createDataLayout());
+    }
+
+    // With every symbol global, SplitModule can place functions freely
+    promoteLocals(module);
+
+    // Partitions move to private contexts through bitcode
+    std::vector<llvm::SmallVector<char, 0>> bitcode;
+    llvm::SplitModule(module, partitions, [&](std::unique_ptr<llvm::Module> partition) {
+        bitcode.emplace_back();
+        llvm::raw_svector_ostream stream(bitcode.back());
+        llvm::WriteBitcodeToFile(*partition, stream);
+    }, /*PreserveLocals=*/false);
+
+    if (!pool_ || pool_->getThreadCount() != partitions) {
+        pool_ = std::make_unique<WorkStealingPool>(partitions);
+    }
+
+    objects.assign(bitcode.size(), llvm::SmallVector<char, 0>());
+    std::vector<char> emitted(bitcode.size(), 0);  // Not vector<bool>: written concurrently
+    pool_->parallelFor(bitcode.size(), [&](size_t index) {
+        TraceSpan span("codegen", "partition");
+        span.addArgument("partition", static_cast<int64_t>(index));
+        llvm::LLVMContext context;
+        llvm::MemoryBufferRef buffer(
+            llvm::StringRef(bitcode[index].data(), bitcode[index].size()), "partition");
+        auto partition = llvm::parseBitcodeFile(buffer, context);
+        if (!partition) {
+            Logger::getInstance().error("Failed to load codegen partition: " +
+                                        llvm::toString(partition.takeError()));
+            return;
+        }
+
+        // Target machines are not shared between threads
+        CodeGenerator generator;
+        emitted[index] = generator.emitObject(**partition, objects[index]);
+    });
+
+    Logger::getInstance().debug("Compiled " + std::to_string(bitcode.size()) +
+                                " codegen partitions on " +
+                                std::to_string(pool_->getThreadCount()) + " threads");
+    return std::all_of(emitted.begin(), emitted.end(), [](char ok) { return ok != 0; });
+}
+
+void CodeGenerator::promoteLocals(llvm::Module& module) {
+    llvm::MD5 hasher;
+    hasher.update(module.getSourceFileName());
+    hasher.update(llvm::StringRef("\0", 1));
+    hasher.update(module.getModuleIdentifier());
+    llvm::MD5::MD5Result digest;
+    hasher.final(digest);
+    llvm::SmallString<32> hex = digest.digest();
+    std::string suffix = ".llvm." + hex.substr(0, 16).str();
+
+    for (auto& gv : module.global_values()) {
+        if (!gv.hasLocalLinkage()) {
+            continue;
+        }
+        std::string name = gv.hasName() ? gv.getName().str() : "anon";
+        gv.setName(name + suffix);
+        gv.setLinkage(llvm::GlobalValue::ExternalLinkage);
+        gv.setVisibility(llvm::GlobalValue::HiddenVisibility);
+    }
+}
+
+uint32_t CodeGenerator::getPartitionCount(const llvm::Module& module, uint32_t jobs) {
+    if (jobs == 0) {
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (jobs == 1) {
+        return 1;
+    }
+
+    uint64_t instructions = 0;
+    uint32_t definitions = 0;
+    for (const auto& func : module) {
+        if (func.isDeclaration()) {
+            continue;
+        }
+        ++definitions;
+        for (const auto& bb : func) {
+            instructions += bb.size();
+        }
+    }
+
+    uint64_t partitions = std::min<uint64_t>(jobs, instructions / MIN_PARTITION_INSTRUCTIONS);
+    partitions = std::min<uint64_t>(partitions, definitions);
+    return static_cast<uint32_t>(std::max<uint64_t>(partitions, 1));
+}
+
+} // namespace obfuscator
@@ -0,0 +1,214 @@
+/**
+ * @file FunctionCache.cpp
+ * @brief Implementation of FunctionCache
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "FunctionCache.h"
+#include "FunctionTransplant.h"
+#include "Logger.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/InstrTypes.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Metadata.h"
+#include "llvm/IR/ModuleSlotTracker.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace obfuscator {
+
+namespace {
+
+/**
+ * @brief Collect the named structs reachable from a type
+ */
+void collectStructs(llvm::Type* type, llvm::SetVector<llvm::Type*>& visited,
+                    std::vector<llvm::StructType*>& structs) {
+    if (!visited.insert(type)) {
+        return;
+    }
+    if (auto* structType = llvm::dyn_cast<llvm::StructType>(type)) {
+        if (!structType->isLiteral()) {
+            structs.push_back(structType);
+        }
+    }
+    for (llvm::Type* subtype : type->subtypes()) {
+        collectStructs(subtype, visited, structs);
+    }
+}
+
+} // anonymous namespace
+
+FunctionCache::FunctionCache(ResultCache& storage, const ObfuscationConfig& config)
+    : storage_(storage), config_(config) {
+}
+
+std::string FunctionCache::computeKey(const llvm::Function& func) const {
+    llvm::ModuleSlotTracker slots(func.getParent());
+    return computeKey(func, slots);
+}
+
+std::string FunctionCache::computeKey(const llvm::Function& func,
+                                      llvm::ModuleSlotTracker& slots) const {
+    const llvm::Module& module = *func.getParent();
+
+    std::string text;
+    llvm::raw_string_ostream stream(text);
+    stream << module.getDataLayoutStr() << '\n' << module.getTargetTriple() << '\n';
+    static_cast<const llvm::Value&>(func).print(stream, slots);
+
+    // The printed body only refers to attribute groups, metadata and named
+    // types, so spell out what they stand for
+    llvm::SetVector<llvm::Type*> visited;
+    std::vector<llvm::StructType*> structs;
+    llvm::SetVector<const llvm::MDNode*> nodes;
+    llvm::SmallVector<std::pair<unsigned, llvm::MDNode*>, 4> attachments;
+
+    func.getAttributes().print(stream);
+    collectStructs(func.getFunctionType(), visited, structs);
+    func.getAllMetadata(attachments);
+    for (const auto& attachment : attachments) {
+        nodes.insert(attachment.second);
+    }
+
+    for (const auto& bb : func) {
+        for (const auto& inst : bb) {
+            if (const auto* call = llvm::dyn_cast<llvm::CallBase>(&inst)) {
+                call->getAttributes().print(stream);
+            }
+            if (const auto* alloca = llvm::dyn_cast<llvm::AllocaInst>(&inst)) {
+                collectStructs(alloca->getAllocatedType(), visited, structs);
+            } else if (const auto* gep = llvm::dyn_cast<llvm::GetElementPtrInst>(&inst)) {
+                collectStructs(gep->getSourceElementType(), visited, structs);
+            }
+            collectStructs(inst.getType(), visited, structs);
+            for (const llvm::Value* operand : inst.operands()) {
+                collectStructs(operand->getType(), visited, structs);
+            }
+
+            attachments.clear();
+            inst.getAllMetadata(attachments);
+            for (const auto& attachment : attachments) {
+                nodes.insert(attachment.second);
+            }
+        }
+    }
+
+    for (llvm::StructType* structType : structs) {
+        structType->print(stream);
+        stream << '\n';
+    }
+    for (const llvm::MDNode* node : nodes) {
+        node->printTree(stream, &module);
+        stream << '\n';
+    }
+    stream.flush();
+
+    return ResultCache::computeKey(text, config_, "function");
+}
+
+size_t FunctionCache::prepare(llvm::Module& module) {
+    misses_.clear();
+    hits_.clear();
+
+    if (!FunctionTransplant::canTransplant(module)) {
+        Logger::getInstance().info("Module cannot be rebuilt incrementally, obfuscating all functions");
+        return 0;
+    }
+
+    // Numbering the module once keeps printing linear in the module size
+    llvm::ModuleSlotTracker slots(&module);
+    for (auto& func : module) {
+        if (func.isDeclaration()) {
+            continue;
+        }
+
+        std::string key = computeKey(func, slots);
+        auto cached = storage_.lookup(key);
+        if (!cached) {
+            misses_.push_back({func.getName().str(), key});
+            continue;
+        }
+
+        auto body = llvm::parseBitcodeFile(cached->getMemBufferRef(), module.getContext());
+        if (!body) {
+            Logger::getInstance().warning("Discarding unreadable cached body of " +
+                                          func.getName().str() + ": " +
+                                          llvm::toString(body.takeError()));
+            misses_.push_back({func.getName().str(), key});
+            continue;
+        }
+        llvm::Function* cachedFunc = (*body)->getFunction(func.getName());
+        if (!cachedFunc || cachedFunc->isDeclaration()) {
+            misses_.push_back({func.getName().str(), key});
+            continue;
+        }
+
+        hits_.push_back({func.getName().str(), std::move(*body), func.getLinkage(),
+                         func.getComdat()});
+    }
+
+    // Passes skip declarations, so hits stay untouched until finish()
+    for (const auto& hit : hits_) {
+        llvm::Function* func = module.getFunction(hit.name);
+        func->deleteBody();
+        func->setComdat(nullptr);
+    }
+
+    Logger::getInstance().info("Function cache: " + std::to_string(hits_.size()) + " hits, " +
+                               std::to_string(misses_.size()) + " misses");
+    return hits_.size();
+}
+
+bool FunctionCache::finish(llvm::Module& module) {
+    if (misses_.empty() && hits_.empty()) {
+        return true;
+    }
+
+    // Store fresh bodies first, while the hits are still declarations
+    FunctionTransplant transplant(module);
+    for (const auto& miss : misses_) {
+        llvm::Function* func = module.getFunction(miss.name);
+        if (!func || func->isDeclaration()) {
+            continue;
+        }
+        llvm::Function* functions[] = {func};
+        auto copy = transplant.extract(functions);
+
+        llvm::SmallVector<char, 0> bitcode;
+        llvm::raw_svector_ostream stream(bitcode);
+        llvm::WriteBitcodeToFile(*copy, stream);
+        storage_.store(miss.key, llvm::StringRef(bitcode.data(), bitcode.size()));
+    }
+
+    if (hits_.empty()) {
+        return true;
+    }
+
+    std::vector<llvm::Function*> originals;
+    for (auto& hit : hits_) {
+        if (!transplant.stage(std::move(hit.body))) {
+            return false;
+        }
+        originals.push_back(module.getFunction(hit.name));
+    }
+    if (!transplant.commit(originals)) {
+        return false;
+    }
+    transplant.restore();
+
+    // Cached bodies were stored from an open transplant, with locals externalized
+    for (const auto& hit : hits_) {
+        if (llvm::Function* func = module.getFunction(hit.name)) {
+            func->setLinkage(hit.linkage);
+            func->setComdat(hit.comdat);
+        }
+    }
+    return true;
+}
+
+} // namespace obfuscator
@@ -0,0 +1,245 @@
+/**
+ * @file FunctionPolicy.cpp
+ * @brief Implementation of FunctionPolicy
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "FunctionPolicy.h"
+#include "Logger.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/InstIterator.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/Regex.h"
+#include <algorithm>
+#include <map>
+
+namespace obfuscator {
+
+namespace {
+
+const char* const LEVEL_ATTRIBUTE = "phantron-level";
+const char* const INTENSITY_ATTRIBUTE = "phantron-intensity";
+const llvm::StringLiteral ANNOTATION_PREFIX = "phantron:";
+
+const char* getLevelName(ObfuscationLevel level) {
+    switch (level) {
+        case ObfuscationLevel::LOW:
+            return "low";
+        case ObfuscationLevel::MEDIUM:
+            return "medium";
+        case ObfuscationLevel::HIGH:
+            break;
+    }
+    return "high";
+}
+
+bool matchesAny(const std::vector<std::string>& patterns, llvm::StringRef name) {
+    return std::any_of(patterns.begin(), patterns.end(), [&](const std::string& pattern) {
+        return llvm::Regex(pattern).match(name);
+    });
+}
+
+/**
+ * @brief Policy texts of the "phantron:" annotations, by function, in source order
+ */
+std::map<const llvm::Function*, std::vector<std::string>> collectAnnotations(
+        const llvm::Module& module) {
+    std::map<const llvm::Function*, std::vector<std::string>> annotations;
+    const llvm::GlobalVariable* global = module.getGlobalVariable("llvm.global.annotations");
+    if (!global || !global->hasInitializer()) {
+        return annotations;
+    }
+    auto* entries = llvm::dyn_cast<llvm::ConstantArray>(global->getInitializer());
+    if (!entries) {
+        return annotations;
+    }
+
+    // Each entry is { annotated value, annotation string, file, line, ... }
+    for (const llvm::Use& use : entries->operands()) {
+        auto* entry = llvm::dyn_cast<llvm::ConstantStruct>(use.get());
+        if (!entry || entry->getNumOperands() < 2) {
+            continue;
+        }
+        auto* func = llvm::dyn_cast<llvm::Function>(entry->getOperand(0)->stripPointerCasts());
+        auto* text = llvm::dyn_cast<llvm::GlobalVariable>(entry->getOperand(1)->stripPointerCasts());
+        if (!func || !text || !text->hasInitializer()) {
+            continue;
+        }
+        auto* data = llvm::dyn_cast<llvm::ConstantDataArray>(text->getInitializer());
+        if (!data || !data->isCString()) {
+            continue;
+        }
+        llvm::StringRef annotation = data->getAsCString();
+        if (annotation.consume_front(ANNOTATION_PREFIX)) {
+            annotations[func].push_back(annotation.str());
+        }
+    }
+    return annotations;
+}
+
+/**
+ * @brief Definitions within a number of call hops of the functions matching the roots
+ *
+ * Walks direct calls breadth-first and loads lazily read bodies on the
+ * way, so only the region has to be in memory. Indirect calls are not
+ * followed.
+ */
+llvm::DenseSet<const llvm::Function*> collectRegion(llvm::Module& module,
+                                                    const std::vector<std::string>& roots,
+                                                    uint32_t depth) {
+    llvm::DenseSet<const llvm::Function*> region;
+    std::vector<llvm::Function*> frontier;
+    for (auto& func : module) {
+        if (!func.isDeclaration() && matchesAny(roots, func.getName())) {
+            region.insert(&func);
+            frontier.push_back(&func);
+        }
+    }
+    if (frontier.empty()) {
+        Logger::getInstance().warning("No function matches the protected roots");
+    }
+
+    for (uint32_t hop = 0; hop < depth && !frontier.empty(); ++hop) {
+        std::vector<llvm::Function*> next;
+        for (llvm::Function* func : frontier) {
+            if (llvm::Error error = func->materialize()) {
+                Logger::getInstance().warning("Cannot follow calls of " + func->getName().str() +
+                                              ": " + llvm::toString(std::move(error)));
+                continue;
+            }
+            for (auto& inst : llvm::instructions(*func)) {
+                auto* call = llvm::dyn_cast<llvm::CallBase>(&inst);
+                auto* callee = call ? llvm::dyn_cast<llvm::Function>(
+                                          call->getCalledOperand()->stripPointerCasts())
+                                    : nullptr;
+                if (callee && !callee->isDeclaration() && region.insert(callee).second) {
+                    next.push_back(callee);
+                }
+            }
+        }
+        frontier = std::move(next);
+    }
+    return region;
+}
+
+} // anonymous namespace
+
+bool FunctionPolicy::parse(llvm::StringRef text, FunctionPolicy& policy) {
+    llvm::SmallVector<llvm::StringRef, 4> settings;
+    text.split(settings, ',', -1, false);
+    for (llvm::StringRef setting : settings) {
+        auto [key, value] = setting.split('=');
+        key = key.trim();
+        value = value.trim();
+        if (key == "level") {
+            if (value != "none" && value != "low" && value != "medium" && value != "high") {
+                return false;
+            }
+            policy.level = value.str();
+        } else if (key == "intensity") {
+            uint32_t intensity = 0;
+            // getAsInteger returns true on error
+            if (value.getAsInteger(10, intensity) || intensity > 100) {
+                return false;
+            }
+            policy.intensity = intensity;
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::vector<std::string> FunctionPolicy::resolve(llvm::Module& module,
+                                                 const ObfuscationConfig& config) {
+    std::vector<std::string> levels;
+    auto annotations = collectAnnotations(module);
+    if (annotations.empty() && config.functionAllowList.empty() &&
+        config.functionDenyList.empty() && config.functionPolicies.empty() &&
+        config.protectedRoots.empty()) {
+        return levels;
+    }
+
+    const std::string configured = getLevelName(config.level);
+    llvm::DenseSet<const llvm::Function*> region;
+    if (!config.protectedRoots.empty()) {
+        region = collectRegion(module, config.protectedRoots, config.protectedDepth);
+        Logger::getInstance().info("Protected region: " + std::to_string(region.size()) +
+                                   " functions within " + std::to_string(config.protectedDepth) +
+                                   " calls of the roots");
+    }
+    uint32_t tagged = 0;
+    for (auto& func : module) {
+        if (func.isDeclaration()) {
+            continue;
+        }
+
+        FunctionPolicy policy;
+        bool selected = (config.functionAllowList.empty() && config.protectedRoots.empty()) ||
+                        region.count(&func) ||
+                        matchesAny(config.functionAllowList, func.getName());
+        auto annotated = annotations.find(&func);
+        if (matchesAny(config.functionDenyList, func.getName())) {
+            policy.level = "none";
+        } else if (annotated != annotations.end()) {
+            for (const auto& text : annotated->second) {
+                if (!parse(text, policy)) {
+                    Logger::getInstance().warning("Ignoring invalid policy \"" + text +
+                                                  "\" of function " + func.getName().str());
+                }
+            }
+        } else {
+            auto rule = std::find_if(
+                config.functionPolicies.begin(), config.functionPolicies.end(),
+                [&](const auto& entry) { return llvm::Regex(entry.first).match(func.getName()); });
+            if (rule != config.functionPolicies.end()) {
+                parse(rule->second, policy);
+            } else if (!selected) {
+                parse(config.outsidePolicy, policy);
+            }
+        }
+
+        if (policy.level == configured) {
+            policy.level.clear();
+        }
+        if (policy.level.empty() && policy.intensity == 100) {
+            continue;
+        }
+
+        if (!policy.level.empty()) {
+            func.addFnAttr(LEVEL_ATTRIBUTE, policy.level);
+            if (policy.level != "none" &&
+                std::find(levels.begin(), levels.end(), policy.level) == levels.end()) {
+                levels.push_back(policy.level);
+            }
+        }
+        if (policy.intensity != 100) {
+            func.addFnAttr(INTENSITY_ATTRIBUTE, std::to_string(policy.intensity));
+        }
+        ++tagged;
+    }
+
+    Logger::getInstance().info("Function policies: " + std::to_string(tagged) +
+                               " functions differ from the configured level");
+    return levels;
+}
+
+llvm::StringRef FunctionPolicy::getLevel(const llvm::Function& func) {
+    return func.getFnAttribute(LEVEL_ATTRIBUTE).getValueAsString();
+}
+
+uint32_t FunctionPolicy::getIntensity(const llvm::Function& func) {
+    uint32_t intensity = 100;
+    llvm::Attribute attribute = func.getFnAttribute(INTENSITY_ATTRIBUTE);
+    if (attribute.isStringAttribute()) {
+        attribute.getValueAsString().getAsInteger(10, intensity);
+    }
+    return intensity;
+}
+
+} // namespace obfuscator
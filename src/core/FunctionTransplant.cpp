@@ -0,0 +1,257 @@
+/**
+ * @file FunctionTransplant.cpp
+ * @brief Implementation of FunctionTransplant
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "FunctionTransplant.h"
+#include "Logger.h"
+#include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/IR/Constants.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+
+namespace obfuscator {
+
+namespace {
+
+/**
+ * @brief Put symbols back in their original order, new ones after them
+ */
+template <typename SymbolList>
+void restoreOrder(SymbolList& list, const std::vector<std::string>& order) {
+    using Symbol = typename SymbolList::value_type;
+
+    llvm::StringMap<Symbol*> byName;
+    for (auto& symbol : list) {
+        if (symbol.hasName()) {
+            byName[symbol.getName()] = &symbol;
+        }
+    }
+
+    std::vector<Symbol*> ordered;
+    llvm::DenseSet<Symbol*> placed;
+    for (const auto& name : order) {
+        auto it = byName.find(name);
+        if (it != byName.end() && placed.insert(it->second).second) {
+            ordered.push_back(it->second);
+        }
+    }
+    for (auto& symbol : list) {
+        if (!placed.count(&symbol)) {
+            ordered.push_back(&symbol);
+        }
+    }
+
+    for (Symbol* symbol : ordered) {
+        list.splice(list.end(), list, symbol->getIterator());
+    }
+}
+
+/**
+ * @brief Maps globals a copy refers to onto declarations in the copy's module
+ */
+class DeclarationMaterializer : public llvm::ValueMaterializer {
+public:
+    explicit DeclarationMaterializer(llvm::Module& target) : target_(target) {}
+
+    llvm::Value* materialize(llvm::Value* value) override {
+        auto* global = llvm::dyn_cast<llvm::GlobalValue>(value);
+        if (!global) {
+            return nullptr;
+        }
+
+        llvm::GlobalValue* decl;
+        if (auto* funcType = llvm::dyn_cast<llvm::FunctionType>(global->getValueType())) {
+            auto* funcDecl = llvm::Function::Create(funcType, llvm::GlobalValue::ExternalLinkage,
+                                                    global->getAddressSpace(), global->getName(),
+                                                    &target_);
+            if (auto* func = llvm::dyn_cast<llvm::Function>(global)) {
+                funcDecl->setCallingConv(func->getCallingConv());
+                funcDecl->setAttributes(func->getAttributes());
+            }
+            decl = funcDecl;
+        } else {
+            auto* var = llvm::dyn_cast<llvm::GlobalVariable>(global);
+            decl = new llvm::GlobalVariable(
+                target_, global->getValueType(), var && var->isConstant(),
+                llvm::GlobalValue::ExternalLinkage, nullptr, global->getName(), nullptr,
+                global->getThreadLocalMode(), global->getAddressSpace());
+        }
+
+        // The linker merges visibility, dso_local and unnamed_addr down to
+        // the weakest of both sides, so declarations must match exactly
+        decl->setVisibility(global->getVisibility());
+        decl->setDSOLocal(global->isDSOLocal());
+        decl->setUnnamedAddr(global->getUnnamedAddr());
+        decl->setDLLStorageClass(global->getDLLStorageClass());
+        return decl;
+    }
+
+private:
+    llvm::Module& target_;
+};
+
+} // anonymous namespace
+
+FunctionTransplant::FunctionTransplant(llvm::Module& module)
+    : module_(module), restored_(false) {
+    // Externalize local symbols so copies can refer to them by name
+    for (auto& gv : module_.global_values()) {
+        if (gv.hasLocalLinkage()) {
+            savedLinkage_.push_back({gv.getName().str(), gv.getLinkage()});
+            gv.setLinkage(llvm::GlobalValue::ExternalLinkage);
+        }
+    }
+
+    // The linker appends what it links, so remember the symbol order
+    for (const auto& global : module_.globals()) {
+        globalOrder_.push_back(global.getName().str());
+    }
+    for (const auto& func : module_) {
+        functionOrder_.push_back(func.getName().str());
+        if (!func.isDeclaration() && func.hasComdat()) {
+            savedComdats_.push_back({func.getName().str(),
+                                     const_cast<llvm::Comdat*>(func.getComdat())});
+        }
+    }
+
+    // Clashes between staged modules are resolved here, not in the module
+    staging_ = std::make_unique<llvm::Module>("phantron.transplant", module_.getContext());
+    staging_->setDataLayout(module_.getDataLayout());
+    staging_->setTargetTriple(module_.getTargetTriple());
+    stagingLinker_ = std::make_unique<llvm::Linker>(*staging_);
+}
+
+FunctionTransplant::~FunctionTransplant() {
+    restore();
+}
+
+bool FunctionTransplant::canTransplant(const llvm::Module& module) {
+    // Debug info compile units would be duplicated by the link-back
+    if (module.getNamedMetadata("llvm.dbg.cu") || !module.ifunc_empty()) {
+        return false;
+    }
+
+    // Local symbols are matched up by name across modules
+    for (const auto& gv : module.global_values()) {
+        if (gv.hasLocalLinkage() && !gv.hasName()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::unique_ptr<llvm::Module> FunctionTransplant::extract(
+    llvm::ArrayRef<llvm::Function*> functions) const {
+    return extract(module_, functions);
+}
+
+std::unique_ptr<llvm::Module> FunctionTransplant::extract(
+    const llvm::Module& module, llvm::ArrayRef<llvm::Function*> functions) {
+    auto copyModule = std::make_unique<llvm::Module>(module.getModuleIdentifier(),
+                                                     module.getContext());
+    copyModule->setDataLayout(module.getDataLayout());
+    copyModule->setTargetTriple(module.getTargetTriple());
+
+    llvm::SmallVector<llvm::Module::ModuleFlagEntry, 8> moduleFlags;
+    module.getModuleFlagsMetadata(moduleFlags);
+    for (const auto& flag : moduleFlags) {
+        copyModule->addModuleFlag(flag.Behavior, flag.Key->getString(), flag.Val);
+    }
+
+    llvm::ValueToValueMapTy valueMap;
+    for (llvm::Function* func : functions) {
+        llvm::Function* copy = llvm::Function::Create(func->getFunctionType(), func->getLinkage(),
+                                                      func->getAddressSpace(), func->getName(),
+                                                      copyModule.get());
+        valueMap[func] = copy;
+    }
+
+    // Everything else the bodies refer to becomes a declaration on demand
+    DeclarationMaterializer materializer(*copyModule);
+    for (llvm::Function* func : functions) {
+        auto* copy = llvm::cast<llvm::Function>(valueMap[func]);
+        auto copyArg = copy->arg_begin();
+        for (const auto& arg : func->args()) {
+            copyArg->setName(arg.getName());
+            valueMap[&arg] = &*copyArg++;
+        }
+
+        llvm::SmallVector<llvm::ReturnInst*, 8> returns;
+        llvm::CloneFunctionInto(copy, func, valueMap,
+                                llvm::CloneFunctionChangeType::DifferentModule, returns,
+                                "", nullptr, nullptr, &materializer);
+
+        // Comdat selection would keep the original body over the replacement
+        copy->setComdat(nullptr);
+    }
+
+    // Cloning registers an (empty) llvm.dbg.cu list; debug info is never copied
+    if (llvm::NamedMDNode* compileUnits = copyModule->getNamedMetadata("llvm.dbg.cu")) {
+        copyModule->eraseNamedMetadata(compileUnits);
+    }
+
+    return copyModule;
+}
+
+bool FunctionTransplant::stage(std::unique_ptr<llvm::Module> replacements) {
+    // Linkonce definitions would be dropped until something refers to them
+    if (stagingLinker_->linkInModule(std::move(replacements), llvm::Linker::OverrideFromSrc)) {
+        Logger::getInstance().error("Failed to stage replacement functions");
+        return false;
+    }
+    return true;
+}
+
+bool FunctionTransplant::commit(llvm::ArrayRef<llvm::Function*> originals) {
+    // Detach the original bodies and free their names, then link all
+    // replacements in a single step
+    std::vector<std::pair<llvm::Function*, std::string>> replaced;
+    for (llvm::Function* func : originals) {
+        replaced.push_back({func, func->getName().str()});
+        func->deleteBody();
+        func->setComdat(nullptr);
+        func->setName("");
+    }
+
+    stagingLinker_.reset();
+    if (llvm::Linker::linkModules(module_, std::move(staging_), llvm::Linker::OverrideFromSrc)) {
+        Logger::getInstance().error("Failed to link replacement functions into module");
+        return false;
+    }
+
+    for (const auto& entry : replaced) {
+        llvm::Function* original = entry.first;
+        if (llvm::Function* replacement = module_.getFunction(entry.second)) {
+            original->replaceAllUsesWith(
+                llvm::ConstantExpr::getBitCast(replacement, original->getType()));
+            original->eraseFromParent();
+        }
+    }
+    return true;
+}
+
+void FunctionTransplant::restore() {
+    if (restored_) {
+        return;
+    }
+    restored_ = true;
+
+    for (const auto& entry : savedLinkage_) {
+        if (llvm::GlobalValue* gv = module_.getNamedValue(entry.first)) {
+            gv->setLinkage(entry.second);
+        }
+    }
+    for (const auto& entry : savedComdats_) {
+        if (llvm::Function* func = module_.getFunction(entry.first)) {
+            func->setComdat(entry.second);
+        }
+    }
+
+    restoreOrder(module_.getGlobalList(), globalOrder_);
+    restoreOrder(module_.getFunctionList(), functionOrder_);
+}
+
+} // namespace obfuscator
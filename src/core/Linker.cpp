@@ -0,0 +1,408 @@
+/**
+ * @file Linker.cpp
+ * @brief Implementation of Linker
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "Linker.h"
+#include "FileUtils.h"
+#include "Logger.h"
+#include "MemoryFile.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/Triple.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Host.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <mutex>
+#include <sstream>
+
+#ifdef PHANTRON_HAVE_LLD
+#include "lld/Common/Driver.h"
+#include <cerrno>
+#include <cstring>
+#include <thread>
+#include <unistd.h>
+#endif
+
+namespace obfuscator {
+
+bool Linker::isInProcessAvailable() {
+#ifdef PHANTRON_HAVE_LLD
+    return true;
+#else
+    return false;
+#endif
+}
+
+LinkerOptions Linker::makeOptions(const ObfuscationConfig& config, bool isCpp) {
+    LinkerOptions options;
+    options.isCpp = isCpp;
+    
+    // Math library always, C++ standard library for C++ inputs; MSVC's
+    // link.exe pulls both in from the CRT on its own
+    llvm::Triple triple(llvm::sys::getDefaultTargetTriple());
+    if (triple.isOSBinFormatELF() || triple.isOSBinFormatMachO()) {
+        options.libraries.push_back("m");
+        if (isCpp) {
+            options.libraries.push_back("stdc++");
+        }
+    }
+    options.libraries.insert(options.libraries.end(),
+                             config.linkLibraries.begin(), config.linkLibraries.end());
+    options.runtimeObjects = config.linkObjects;
+    options.librarySearchPaths = config.linkSearchPaths;
+    
+    return options;
+}
+
+bool Linker::link(const LinkerOptions& options) {
+    if (isInProcessAvailable()) {
+        return linkInProcess(options);
+    }
+    return linkWithDriver(options);
+}
+
+bool Linker::linkRelocatable(const std::vector<std::string>& objectFiles,
+                             const std::string& outputFile) {
+    if (isInProcessAvailable()) {
+        return linkRelocatableInProcess(objectFiles, outputFile);
+    }
+
+#ifdef _WIN32
+    Logger::getInstance().error("Relocatable links are not supported on this platform");
+    return false;
+#else
+    std::ostringstream cmd;
+    cmd << "clang -r -nostdlib ";
+    for (const auto& obj : objectFiles) {
+        cmd << "\"" << obj << "\" ";
+    }
+    cmd << "-o \"" << outputFile << "\"";
+
+    int result = std::system(cmd.str().c_str());
+    return result == 0;
+#endif
+}
+
+bool Linker::linkRelocatable(const std::vector<std::string>& objectFiles,
+                             llvm::SmallVectorImpl<char>& output) {
+    if (isInProcessAvailable()) {
+        return linkRelocatableInProcess(objectFiles, output);
+    }
+
+    // The driver's linker seeks in its output, which a memfd allows
+    MemoryFile combined("phantron-combined");
+    if (!combined.isValid() || !linkRelocatable(objectFiles, combined.getPath())) {
+        return false;
+    }
+    auto object = combined.read();
+    if (!object) {
+        return false;
+    }
+    output.assign(object->getBufferStart(), object->getBufferEnd());
+    return true;
+}
+
+#ifdef PHANTRON_HAVE_LLD
+
+namespace {
+
+/**
+ * @brief C runtime pieces the clang driver would normally add to a link
+ */
+struct SystemRuntime {
+    std::vector<std::string> startObjects;  // crt1.o crti.o crtbegin.o
+    std::vector<std::string> endObjects;    // crtend.o crtn.o
+    std::vector<std::string> searchPaths;
+    std::string dynamicLinker;
+    std::string emulation;
+};
+
+std::string findInPaths(const std::vector<std::string>& paths, const std::string& name) {
+    for (const auto& dir : paths) {
+        std::string candidate = dir + "/" + name;
+        if (FileUtils::fileExists(candidate)) {
+            return candidate;
+        }
+    }
+    return "";
+}
+
+/**
+ * @brief Library search path of the system compiler driver
+ *
+ * The "libraries:" line of -print-search-dirs starts with the GCC install
+ * directory (crtbegin.o, libgcc) followed by the multiarch and system
+ * library directories, in the order the driver links with.
+ */
+std::vector<std::string> queryDriverSearchPaths() {
+    std::vector<std::string> paths;
+    for (const char* driver : {"clang", "cc"}) {
+        std::string command = std::string(driver) + " -print-search-dirs 2>/dev/null";
+        FILE* pipe = popen(command.c_str(), "r");
+        if (!pipe) {
+            continue;
+        }
+        std::string output;
+        char buffer[4096];
+        size_t count;
+        while ((count = fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+            output.append(buffer, count);
+        }
+        if (pclose(pipe) != 0) {
+            continue;
+        }
+
+        llvm::SmallVector<llvm::StringRef, 8> lines;
+        llvm::StringRef(output).split(lines, '\n');
+        for (llvm::StringRef line : lines) {
+            if (!line.consume_front("libraries: =")) {
+                continue;
+            }
+            llvm::SmallVector<llvm::StringRef, 16> dirs;
+            line.trim().split(dirs, ':', -1, false);
+            for (llvm::StringRef dir : dirs) {
+                llvm::SmallString<256> path(dir);
+                llvm::sys::path::remove_dots(path, /*remove_dot_dot=*/true);
+                std::string normalized = path.str().str();
+                if (FileUtils::fileExists(normalized) &&
+                    std::find(paths.begin(), paths.end(), normalized) == paths.end()) {
+                    paths.push_back(normalized);
+                }
+            }
+        }
+        if (!paths.empty()) {
+            break;
+        }
+    }
+    return paths;
+}
+
+const SystemRuntime& detectSystemRuntime() {
+    static SystemRuntime runtime;
+    static std::once_flag detectFlag;
+
+    std::call_once(detectFlag, []() {
+        llvm::Triple triple(llvm::sys::getDefaultTargetTriple());
+
+        runtime.searchPaths = queryDriverSearchPaths();
+        if (runtime.searchPaths.empty()) {
+            Logger::getInstance().warning(
+                "No compiler driver to ask for library paths, using the system defaults");
+            std::string multiarch = triple.getArchName().str() + "-linux-gnu";
+            for (const auto& dir : {"/usr/lib/" + multiarch, "/lib/" + multiarch,
+                                    std::string("/usr/lib64"), std::string("/lib64"),
+                                    std::string("/usr/lib"), std::string("/lib")}) {
+                if (FileUtils::fileExists(dir)) {
+                    runtime.searchPaths.push_back(dir);
+                }
+            }
+        }
+
+        for (const char* name : {"crt1.o", "crti.o", "crtbegin.o"}) {
+            std::string path = findInPaths(runtime.searchPaths, name);
+            if (!path.empty()) {
+                runtime.startObjects.push_back(path);
+            }
+        }
+        for (const char* name : {"crtend.o", "crtn.o"}) {
+            std::string path = findInPaths(runtime.searchPaths, name);
+            if (!path.empty()) {
+                runtime.endObjects.push_back(path);
+            }
+        }
+
+        if (triple.getArch() == llvm::Triple::aarch64) {
+            runtime.emulation = "aarch64linux";
+            runtime.dynamicLinker = "/lib/ld-linux-aarch64.so.1";
+        } else {
+            runtime.emulation = "elf_x86_64";
+            runtime.dynamicLinker = "/lib64/ld-linux-x86-64.so.2";
+        }
+    });
+
+    return runtime;
+}
+
+/**
+ * @brief Run the lld ELF driver on a full argument list
+ */
+bool runLld(const std::vector<std::string>& args) {
+    std::vector<const char*> argv;
+    argv.reserve(args.size());
+    for (const auto& arg : args) {
+        argv.push_back(arg.c_str());
+    }
+
+    // lld keeps global driver state, so links in one process are serialized
+    static std::mutex lldMutex;
+    std::lock_guard<std::mutex> lock(lldMutex);
+
+    std::string errors;
+    llvm::raw_string_ostream errorStream(errors);
+    bool ok = lld::elf::link(argv, llvm::outs(), errorStream,
+                             /*exitEarly=*/false, /*disableOutput=*/false);
+    errorStream.flush();
+
+    if (!ok) {
+        Logger::getInstance().error("lld failed: " + errors);
+    }
+    return ok;
+}
+
+} // anonymous namespace
+
+bool Linker::linkInProcess(const LinkerOptions& options) {
+    const SystemRuntime& runtime = detectSystemRuntime();
+
+    // Equivalent of what the clang driver passes for a -no-pie glibc link
+    std::vector<std::string> args = {
+        "ld.lld",
+        "-z", "relro",
+        "--hash-style=gnu",
+        "--eh-frame-hdr",
+        "-m", runtime.emulation,
+        "-dynamic-linker", runtime.dynamicLinker,
+        "-o", options.outputFile
+    };
+
+    args.insert(args.end(), runtime.startObjects.begin(), runtime.startObjects.end());
+    for (const auto& dir : runtime.searchPaths) {
+        args.push_back("-L" + dir);
+    }
+    for (const auto& dir : options.librarySearchPaths) {
+        args.push_back("-L" + dir);
+    }
+
+    args.insert(args.end(), options.objectFiles.begin(), options.objectFiles.end());
+    args.insert(args.end(), options.runtimeObjects.begin(), options.runtimeObjects.end());
+
+    for (const auto& lib : options.libraries) {
+        args.push_back("-l" + lib);
+    }
+    for (int i = 0; i < 2; ++i) {
+        args.push_back("-lgcc");
+        args.push_back("--as-needed");
+        args.push_back("-lgcc_s");
+        args.push_back("--no-as-needed");
+        if (i == 0) {
+            args.push_back("-lc");
+        }
+    }
+
+    args.insert(args.end(), runtime.endObjects.begin(), runtime.endObjects.end());
+
+    return runLld(args);
+}
+
+bool Linker::linkRelocatableInProcess(const std::vector<std::string>& objectFiles,
+                                      const std::string& outputFile) {
+    std::vector<std::string> args = {
+        "ld.lld",
+        "-r",
+        "-m", detectSystemRuntime().emulation,
+        "-o", outputFile
+    };
+    args.insert(args.end(), objectFiles.begin(), objectFiles.end());
+
+    return runLld(args);
+}
+
+bool Linker::linkRelocatableInProcess(const std::vector<std::string>& objectFiles,
+                                      llvm::SmallVectorImpl<char>& output) {
+    // lld replaces a regular output file through a temporary file next to
+    // it, which a memfd has no directory for. Pipes it writes in one go
+    // from memory, so the object comes back through one.
+    int fds[2];
+    if (::pipe(fds) != 0) {
+        Logger::getInstance().error("Cannot create pipe for the combined object: " +
+                                    std::string(std::strerror(errno)));
+        return false;
+    }
+
+    std::thread reader([&]() {
+        char buffer[65536];
+        while (true) {
+            ssize_t count = ::read(fds[0], buffer, sizeof(buffer));
+            if (count < 0 && errno == EINTR) {
+                continue;
+            }
+            if (count <= 0) {
+                break;
+            }
+            output.append(buffer, buffer + count);
+        }
+    });
+
+    output.clear();
+    bool linked = linkRelocatableInProcess(objectFiles, "/proc/self/fd/" + std::to_string(fds[1]));
+    ::close(fds[1]);
+    reader.join();
+    ::close(fds[0]);
+    return linked && !output.empty();
+}
+
+#else
+
+bool Linker::linkInProcess(const LinkerOptions& /*options*/) {
+    Logger::getInstance().error("In-process lld linker not available in this build");
+    return false;
+}
+
+bool Linker::linkRelocatableInProcess(const std::vector<std::string>& /*objectFiles*/,
+                                      const std::string& /*outputFile*/) {
+    Logger::getInstance().error("In-process lld linker not available in this build");
+    return false;
+}
+
+bool Linker::linkRelocatableInProcess(const std::vector<std::string>& /*objectFiles*/,
+                                      llvm::SmallVectorImpl<char>& /*output*/) {
+    Logger::getInstance().error("In-process lld linker not available in this build");
+    return false;
+}
+
+#endif
+
+bool Linker::linkWithDriver(const LinkerOptions& options) {
+    std::ostringstream cmd;
+
+#ifdef _WIN32
+    cmd << "link.exe ";
+    for (const auto& obj : options.objectFiles) {
+        cmd << "\"" << obj << "\" ";
+    }
+    for (const auto& obj : options.runtimeObjects) {
+        cmd << "\"" << obj << "\" ";
+    }
+    for (const auto& lib : options.libraries) {
+        cmd << lib << ".lib ";
+    }
+    cmd << "/OUT:\"" << options.outputFile << "\"";
+#else
+    cmd << (options.isCpp ? "clang++ " : "clang ");
+    cmd << "-no-pie ";  // Disable PIE to avoid relocation issues
+    for (const auto& obj : options.objectFiles) {
+        cmd << "\"" << obj << "\" ";
+    }
+    for (const auto& obj : options.runtimeObjects) {
+        cmd << "\"" << obj << "\" ";
+    }
+    for (const auto& dir : options.librarySearchPaths) {
+        cmd << "-L\"" << dir << "\" ";
+    }
+    for (const auto& lib : options.libraries) {
+        cmd << "-l" << lib << " ";
+    }
+    cmd << "-o \"" << options.outputFile << "\"";
+#endif
+
+    int result = std::system(cmd.str().c_str());
+    return result == 0;
+}
+
+} // namespace obfuscator
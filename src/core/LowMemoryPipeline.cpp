@@ -0,0 +1,232 @@
+/**
+ * @file LowMemoryPipeline.cpp
+ * @brief Implementation of LowMemoryPipeline
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "LowMemoryPipeline.h"
+#include "CodeGenerator.h"
+#include "FileUtils.h"
+#include "FunctionTransplant.h"
+#include "Logger.h"
+#include "Tracer.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+namespace obfuscator {
+
+namespace {
+
+void countCode(const llvm::Module& module, uint32_t& insts, uint32_t& bbs, uint32_t& funcs) {
+    for (const auto& func : module) {
+        if (func.isDeclaration()) {
+            continue;
+        }
+        funcs++;
+        for (const auto& bb : func) {
+            bbs++;
+            insts += bb.size();
+        }
+    }
+}
+
+} // anonymous namespace
+
+LowMemoryPipeline::LowMemoryPipeline(const ObfuscationConfig& config, PassManager& passManager,
+                                     Linker& linker)
+    : config_(config), passManager_(passManager), linker_(linker),
+      stageInMemory_(false), originalInsts_(0), obfuscatedInsts_(0), originalBBs_(0), obfuscatedBBs_(0),
+      obfuscatedFuncs_(0) {
+}
+
+bool LowMemoryPipeline::canRun(const llvm::Module& module) {
+    // Debug info compile units cannot be split across objects this way
+    return !module.getNamedMetadata("llvm.dbg.cu") && module.ifunc_empty();
+}
+
+bool LowMemoryPipeline::run(llvm::Module& module, MetricsCollector& metrics,
+                            const std::string& objectFile) {
+    objectStem_ = objectFile;
+    stageInMemory_ = config_.inMemoryPipeline;
+    bool success = compileBatches(module, metrics);
+    if (success) {
+        Logger::getInstance().info("Combining " + std::to_string(objectFiles_.size()) +
+                                   " batch objects");
+        success = linker_.linkRelocatable(objectFiles_, objectFile);
+    }
+    releaseObjects();
+    return success;
+}
+
+bool LowMemoryPipeline::run(llvm::Module& module, MetricsCollector& metrics,
+                            llvm::SmallVectorImpl<char>& objectBuffer) {
+    // The result lives in memory, so the batch objects do too
+    objectStem_.clear();
+    stageInMemory_ = true;
+    bool success = compileBatches(module, metrics);
+    if (success) {
+        Logger::getInstance().info("Combining " + std::to_string(objectFiles_.size()) +
+                                   " batch objects in memory");
+        success = linker_.linkRelocatable(objectFiles_, objectBuffer);
+    }
+    releaseObjects();
+    return success;
+}
+
+bool LowMemoryPipeline::compileBatches(llvm::Module& module, MetricsCollector& metrics) {
+    memoryObjects_.clear();
+    objectFiles_.clear();
+    originalInsts_ = obfuscatedInsts_ = originalBBs_ = obfuscatedBBs_ = obfuscatedFuncs_ = 0;
+
+    // Batches are separate objects that refer to each other's symbols
+    CodeGenerator::promoteLocals(module);
+
+    // Annotations stay with the module's globals, the tags go with the batches
+    passManager_.resolvePolicies(module);
+
+    std::vector<llvm::Function*> definitions;
+    for (auto& func : module) {
+        if (!func.isDeclaration()) {
+            definitions.push_back(&func);
+        }
+    }
+
+    size_t batchSize = std::max<size_t>(1, config_.batchFunctions);
+    bool success = true;
+    for (size_t begin = 0; begin < definitions.size() && success; begin += batchSize) {
+        llvm::ArrayRef<llvm::Function*> batch = llvm::makeArrayRef(definitions)
+            .slice(begin, std::min(batchSize, definitions.size() - begin));
+        TraceSpan span("stage", "batch");
+        span.addArgument("functions", static_cast<int64_t>(batch.size()));
+
+        for (llvm::Function* func : batch) {
+            if (llvm::Error error = func->materialize()) {
+                Logger::getInstance().error("Failed to load function " + func->getName().str() +
+                                            ": " + llvm::toString(std::move(error)));
+                return false;
+            }
+        }
+
+        // From here on the batch lives in its bitcode only
+        llvm::SmallVector<char, 0> bitcode;
+        {
+            auto batchModule = FunctionTransplant::extract(module, batch);
+            llvm::raw_svector_ostream stream(bitcode);
+            llvm::WriteBitcodeToFile(*batchModule, stream);
+        }
+        for (llvm::Function* func : batch) {
+            func->deleteBody();
+            func->setComdat(nullptr);
+        }
+
+        success = compileBatch(llvm::StringRef(bitcode.data(), bitcode.size()), metrics);
+        Logger::getInstance().debug("Compiled batch of " + std::to_string(batch.size()) +
+                                    " functions (" + std::to_string(begin + batch.size()) +
+                                    "/" + std::to_string(definitions.size()) + ")");
+    }
+
+    // Globals, string tables and module-level helpers go last
+    if (success) {
+        if (llvm::Error error = module.materializeAll()) {
+            Logger::getInstance().error("Failed to load module: " +
+                                        llvm::toString(std::move(error)));
+            success = false;
+        } else {
+            success = obfuscateAndEmit(module, metrics);
+        }
+    }
+
+    auto& m = metrics.getMetricsMutable();
+    metrics.recordCodeMetrics(originalInsts_, obfuscatedInsts_, originalBBs_, obfuscatedBBs_);
+    m.totalObfuscationCycles = config_.obfuscationCycles;
+    m.originalFunctionCount = static_cast<uint32_t>(definitions.size());
+    m.obfuscatedFunctionCount = obfuscatedFuncs_;
+    return success;
+}
+
+void LowMemoryPipeline::releaseObjects() {
+    if (!stageInMemory_) {
+        for (const auto& path : objectFiles_) {
+            FileUtils::deleteFile(path);
+        }
+    }
+    memoryObjects_.clear();
+    objectFiles_.clear();
+}
+
+bool LowMemoryPipeline::compileBatch(llvm::StringRef bitcode, MetricsCollector& metrics) {
+    // A private context takes every constant and type the passes create
+    // with it when the batch is done
+    llvm::LLVMContext context;
+    auto batch = llvm::parseBitcodeFile(llvm::MemoryBufferRef(bitcode, "batch"), context);
+    if (!batch) {
+        Logger::getInstance().error("Failed to load function batch: " +
+                                    llvm::toString(batch.takeError()));
+        return false;
+    }
+    return obfuscateAndEmit(**batch, metrics);
+}
+
+bool LowMemoryPipeline::obfuscateAndEmit(llvm::Module& module, MetricsCollector& metrics) {
+    uint32_t originalFuncs = 0;
+    countCode(module, originalInsts_, originalBBs_, originalFuncs);
+
+    for (uint32_t cycle = 0; cycle < config_.obfuscationCycles; ++cycle) {
+        TraceSpan span("cycle", "cycle " + std::to_string(cycle + 1));
+        passManager_.runPasses(module, metrics, cycle);
+    }
+
+    countCode(module, obfuscatedInsts_, obfuscatedBBs_, obfuscatedFuncs_);
+
+    std::string errorMsg;
+    llvm::raw_string_ostream errorStream(errorMsg);
+    if (llvm::verifyModule(module, &errorStream)) {
+        Logger::getInstance().error("Module verification failed: " + errorStream.str());
+        return false;
+    }
+
+    llvm::SmallVector<char, 0> object;
+    TraceSpan span("stage", "codegen");
+    if (!codeGenerator_.emitObject(module, object)) {
+        return false;
+    }
+    return stageObject(llvm::StringRef(object.data(), object.size()));
+}
+
+bool LowMemoryPipeline::stageObject(llvm::StringRef object) {
+    // Objects wait in memfds, or in numbered files next to the output
+    if (stageInMemory_) {
+        auto file = std::make_unique<MemoryFile>("phantron-batch");
+        if (!file->write(object)) {
+            Logger::getInstance().error("Failed to stage batch object");
+            return false;
+        }
+        objectFiles_.push_back(file->getPath());
+        memoryObjects_.push_back(std::move(file));
+        return true;
+    }
+
+    std::string path = objectStem_ + "." + std::to_string(objectFiles_.size()) + ".o";
+    std::error_code ec;
+    llvm::raw_fd_ostream out(path, ec, llvm::sys::fs::OF_None);
+    if (!ec) {
+        out << object;
+        out.close();
+    }
+    objectFiles_.push_back(path);
+    if (ec || out.has_error()) {
+        out.clear_error();
+        Logger::getInstance().error("Failed to write batch object " + path);
+        return false;
+    }
+    return true;
+}
+
+} // namespace obfuscator
@@ -0,0 +1,236 @@
+/**
+ * @file ManifestRunner.cpp
+ * @brief Implementation of ManifestRunner
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "ManifestRunner.h"
+#include "ObfuscationEngine.h"
+#include "StagedPipeline.h"
+#include "Logger.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+namespace obfuscator {
+
+namespace {
+
+std::string escapeJson(const std::string& text) {
+    std::ostringstream out;
+    for (char c : text) {
+        switch (c) {
+            case '"':  out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\t': out << "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out << "\\u00" << "0123456789abcdef"[(c >> 4) & 0xf]
+                        << "0123456789abcdef"[c & 0xf];
+                } else {
+                    out << c;
+                }
+        }
+    }
+    return out.str();
+}
+
+/**
+ * @brief Format the JSON result line of one entry
+ * @param extra Further fields, each starting with ", "
+ */
+std::string formatResult(size_t index, const ManifestEntry& entry, bool success,
+                         std::chrono::milliseconds elapsed, const MetricsCollector* metrics,
+                         const std::string& extra) {
+    std::ostringstream line;
+    line << "{\"index\": " << index
+         << ", \"input\": \"" << escapeJson(entry.inputFile) << "\""
+         << ", \"output\": \"" << escapeJson(entry.outputFile) << "\""
+         << ", \"status\": \"" << (success ? "ok" : "failed") << "\""
+         << ", \"time_ms\": " << elapsed.count();
+    if (success && metrics) {
+        const auto& m = metrics->getMetrics();
+        line << ", \"original_size\": " << m.originalFileSize
+             << ", \"obfuscated_size\": " << m.obfuscatedFileSize
+             << ", \"cache_hit\": " << (m.cacheHits > 0 ? "true" : "false");
+    }
+    line << extra << "}\n";
+    return line.str();
+}
+
+} // anonymous namespace
+
+ManifestRunner::ManifestRunner(const ObfuscationConfig& config)
+    : config_(config), failures_(0) {
+    // Names of locals only cost memory in a context that outlives many modules
+    config_.discardValueNames = true;
+}
+
+bool ManifestRunner::parseManifest(const std::string& manifestFile,
+                                   std::vector<ManifestEntry>& entries) {
+    std::ifstream in(manifestFile);
+    if (!in) {
+        Logger::getInstance().error("Cannot read manifest: " + manifestFile);
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(in, line)) {
+        size_t begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string::npos || line[begin] == '#') {
+            continue;
+        }
+        size_t end = line.find_last_not_of(" \t\r") + 1;
+        line = line.substr(begin, end - begin);
+
+        // Tabs separate paths that contain spaces
+        size_t split = line.find('\t');
+        if (split == std::string::npos) {
+            split = line.find(' ');
+        }
+
+        ManifestEntry entry;
+        entry.inputFile = line.substr(0, split);
+        if (split != std::string::npos) {
+            size_t output = line.find_first_not_of(" \t", split);
+            entry.outputFile = line.substr(output);
+        } else {
+            entry.outputFile = entry.inputFile + ".obf";
+        }
+        entries.push_back(entry);
+    }
+    return true;
+}
+
+bool ManifestRunner::run(const std::string& manifestFile, std::ostream& results) {
+    std::vector<ManifestEntry> entries;
+    if (!parseManifest(manifestFile, entries)) {
+        return false;
+    }
+
+    if (!config_.pipelineWorkers.empty()) {
+        return runPipelined(entries, results);
+    }
+
+    uint32_t workerCount = config_.jobs;
+    if (workerCount == 0) {
+        workerCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    workerCount = static_cast<uint32_t>(
+        std::min<size_t>(workerCount, std::max<size_t>(entries.size(), 1)));
+
+    Logger::getInstance().info("Obfuscating " + std::to_string(entries.size()) +
+                               " manifest entries with " + std::to_string(workerCount) +
+                               " workers");
+
+    failures_ = 0;
+    std::atomic<size_t> nextEntry(0);
+    std::vector<std::thread> workers;
+    workers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&ManifestRunner::runWorker, this, std::cref(entries),
+                             std::ref(nextEntry), std::ref(results));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    if (failures_ > 0) {
+        Logger::getInstance().error(std::to_string(failures_) + " of " +
+                                    std::to_string(entries.size()) +
+                                    " manifest entries failed");
+    }
+    return failures_ == 0;
+}
+
+void ManifestRunner::runWorker(const std::vector<ManifestEntry>& entries,
+                               std::atomic<size_t>& nextEntry, std::ostream& results) {
+    // One engine, and with it one context, for every entry this worker takes
+    ObfuscationEngine engine(config_);
+
+    while (true) {
+        size_t index = nextEntry.fetch_add(1);
+        if (index >= entries.size()) {
+            break;
+        }
+
+        const ManifestEntry& entry = entries[index];
+        auto start = std::chrono::steady_clock::now();
+        bool success = engine.processFile(entry.inputFile, entry.outputFile);
+        auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - start);
+
+        if (!success) {
+            failures_++;
+        }
+
+        // A failed entry may leave the metrics of the one before behind
+        std::string line = formatResult(
+            index, entry, success, elapsed,
+            success ? engine.getReportGenerator()->getMetricsCollector().get() : nullptr, "");
+
+        std::lock_guard<std::mutex> lock(resultsMutex_);
+        results << line << std::flush;
+    }
+}
+
+bool ManifestRunner::runPipelined(const std::vector<ManifestEntry>& entries,
+                                  std::ostream& results) {
+    StagedPipeline pipeline(config_, config_.pipelineWorkers);
+
+    failures_ = 0;
+    bool success = pipeline.run(entries, [&](const StagedPipeline::Result& result) {
+        if (!result.success) {
+            failures_++;
+        }
+
+        std::ostringstream stages;
+        stages << ", \"stages\": {";
+        for (int stage = 0; stage < StagedPipeline::STAGE_COUNT; ++stage) {
+            stages << (stage ? ", " : "") << "\""
+                   << StagedPipeline::getStageName(static_cast<StagedPipeline::Stage>(stage))
+                   << "\": {\"wait_ms\": " << result.wait[stage].count() / 1000.0
+                   << ", \"run_ms\": " << result.run[stage].count() / 1000.0 << "}";
+        }
+        stages << "}";
+        if (!result.success) {
+            stages << ", \"failed_stage\": \"" << result.failedStage << "\"";
+        }
+
+        results << formatResult(result.index, entries[result.index], result.success,
+                                result.metrics->getMetrics().totalTime, result.metrics.get(),
+                                stages.str())
+                << std::flush;
+    });
+
+    // One closing line describes the load of every stage
+    std::ostringstream summary;
+    summary << "{\"pipeline\": [";
+    const auto& stats = pipeline.getStageStats();
+    for (size_t stage = 0; stage < stats.size(); ++stage) {
+        summary << (stage ? ", " : "") << "{\"stage\": \""
+                << StagedPipeline::getStageName(static_cast<StagedPipeline::Stage>(stage))
+                << "\", \"workers\": " << stats[stage].workers
+                << ", \"jobs\": " << stats[stage].jobs
+                << ", \"utilization\": " << stats[stage].utilization
+                << ", \"busy_ms\": " << stats[stage].busy.count() / 1000.0
+                << ", \"wait_ms\": " << stats[stage].wait.count() / 1000.0
+                << ", \"max_queue_depth\": " << stats[stage].maxQueueDepth << "}";
+    }
+    summary << "]}\n";
+    results << summary.str() << std::flush;
+
+    if (!success) {
+        Logger::getInstance().error(std::to_string(failures_) + " of " +
+                                    std::to_string(entries.size()) +
+                                    " manifest entries failed");
+    }
+    return success;
+}
+
+} // namespace obfuscator
+
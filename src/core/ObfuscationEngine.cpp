@@ -9,11 +9,20 @@
 #include "PassManager.h"
 #include "Logger.h"
 #include "FileUtils.h"
+#include "MemoryFile.h"
+#include "LowMemoryPipeline.h"
+#include "Tracer.h"
+#include "PerfCounters.h"
+#include "ProfileLoader.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IRReader/IRReader.h"
+#include "llvm/Support/Error.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/SmallVectorMemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
-#include "llvm/Bitcode/BitcodeWriter.h"
 #include "llvm/IR/Verifier.h"
 #include <chrono>
 #include <cstdlib>
@@ -24,9 +33,27 @@ namespace obfuscator {
 ObfuscationEngine::ObfuscationEngine(const ObfuscationConfig& config)
     : config_(config) {
     context_ = std::make_unique<llvm::LLVMContext>();
+    context_->setDiscardValueNames(config_.discardValueNames);
     passManager_ = std::make_unique<PassManager>(config_);
+    if (!config_.profileFile.empty() &&
+        !ProfileLoader::getFrontendArgs(config_.profileFile, frontendArgs_)) {
+        Logger::getInstance().warning("Compiling without profile: " + config_.profileFile);
+    }
+    frontend_ = std::make_unique<ClangFrontend>(frontendArgs_);
+    codeGenerator_ = std::make_unique<CodeGenerator>();
+    linker_ = std::make_unique<Linker>();
     reportGenerator_ = std::make_shared<ReportGenerator>(config_);
     
+    // Cache keys print the whole module, which lazy loading avoids
+    if (!config_.cacheDirectory.empty() && config_.lowMemory) {
+        Logger::getInstance().warning("Result cache is not used in low-memory mode");
+    } else if (!config_.cacheDirectory.empty()) {
+        cache_ = std::make_unique<ResultCache>(config_.cacheDirectory, config_.cacheMaxSize);
+        if (config_.incremental) {
+            functionCache_ = std::make_unique<FunctionCache>(*cache_, config_);
+        }
+    }
+    
     Logger::getInstance().setVerbose(config_.verbose);
     Logger::getInstance().info("Obfuscation engine initialized");
 }
@@ -37,55 +64,103 @@ ObfuscationEngine::~ObfuscationEngine() {
 bool ObfuscationEngine::processFile(const std::string& inputFile, 
                                     const std::string& outputFile) {
     Logger::getInstance().info("Processing file: " + inputFile);
+    TraceSpan span("file", inputFile);
     
     auto startTime = std::chrono::high_resolution_clock::now();
     
-    // Generate temporary IR file
-    std::string irFile = inputFile + ".bc";
     std::string objectFile = outputFile + ".o";
     
-    // Step 1: Compile to IR
+    // Step 1-2: Compile source into a module in our context
     auto compileStart = std::chrono::high_resolution_clock::now();
-    if (!compileToIR(inputFile, irFile)) {
+    auto compileStartCounters = readCounters();
+    auto module = compileToIR(inputFile, *context_);
+    if (!module) {
         Logger::getInstance().error("Failed to compile source to IR");
         return false;
     }
     auto compileEnd = std::chrono::high_resolution_clock::now();
-    
-    // Step 2: Load module
-    auto module = loadModule(irFile);
-    if (!module) {
-        Logger::getInstance().error("Failed to load LLVM module");
-        return false;
+    auto compileEndCounters = readCounters();
+    
+    // A cached binary for the same input and settings ends the run here
+    std::string cacheKey;
+    if (cache_) {
+        cacheKey = computeCacheKey(*module, "binary", inputFile);
+        if (auto cached = cache_->lookup(cacheKey)) {
+            if (!writeCachedBinary(*cached, outputFile)) {
+                return false;
+            }
+            
+            auto metrics = std::make_shared<MetricsCollector>();
+            reportGenerator_->setMetricsCollector(metrics);
+            auto& m = metrics->getMetricsMutable();
+            m.cacheHits = 1;
+            m.compilationTime =
+                std::chrono::duration_cast<std::chrono::milliseconds>(compileEnd - compileStart);
+            m.totalTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+                std::chrono::high_resolution_clock::now() - startTime);
+            metrics->recordFileSizes(FileUtils::getFileSize(inputFile),
+                                     FileUtils::getFileSize(outputFile));
+            
+            Logger::getInstance().info("Obfuscated binary restored from result cache");
+            return true;
+        }
     }
     
     // Step 3: Apply obfuscation
     auto obfStart = std::chrono::high_resolution_clock::now();
-    if (!applyObfuscation(*module)) {
-        Logger::getInstance().error("Failed to apply obfuscation");
-        return false;
+    auto obfStartCounters = readCounters();
+    llvm::SmallVector<char, 0> objectBuffer;
+    bool compiled = false;
+    if (config_.lowMemory) {
+        // Obfuscation and codegen go hand in hand, one batch at a time
+        compiled = config_.inMemoryPipeline
+            ? compileInBatches(*module, objectBuffer)
+            : compileInBatches(*module, objectFile);
+    } else {
+        if (!applyObfuscation(*module)) {
+            Logger::getInstance().error("Failed to apply obfuscation");
+            return false;
+        }
     }
     auto obfEnd = std::chrono::high_resolution_clock::now();
+    auto obfEndCounters = readCounters();
     
-    // Step 4: Compile to object file
-    if (!compileToObject(*module, objectFile)) {
+    // Step 4: Compile to object file (kept in memory in in-memory mode)
+    if (!config_.lowMemory) {
+        compiled = config_.inMemoryPipeline
+            ? compileToObject(*module, objectBuffer)
+            : compileToObject(*module, objectFile);
+    }
+    if (!compiled) {
         Logger::getInstance().error("Failed to compile to object file");
         return false;
     }
     
     // Step 5: Link to final binary
     auto linkStart = std::chrono::high_resolution_clock::now();
-    if (!linkToBinary(objectFile, outputFile, inputFile)) {
+    auto linkStartCounters = readCounters();
+    bool linked = config_.inMemoryPipeline
+        ? linkToBinary(llvm::StringRef(objectBuffer.data(), objectBuffer.size()),
+                       outputFile, inputFile)
+        : linkToBinary(objectFile, outputFile, inputFile);
+    if (!linked) {
         Logger::getInstance().error("Failed to link binary");
         return false;
     }
     auto linkEnd = std::chrono::high_resolution_clock::now();
+    auto linkEndCounters = readCounters();
+    
+    if (cache_) {
+        if (auto binary = llvm::MemoryBuffer::getFile(outputFile, /*IsText=*/false,
+                                                      /*RequiresNullTerminator=*/false)) {
+            cache_->store(cacheKey, (*binary)->getBuffer());
+        }
+    }
     
     auto endTime = std::chrono::high_resolution_clock::now();
     
-    // Record timing metrics
-    auto metrics = std::make_shared<MetricsCollector>();
-    reportGenerator_->setMetricsCollector(metrics);
+    // Add timings to the collector the obfuscation step filled in
+    auto metrics = reportGenerator_->getMetricsCollector();
     if (metrics) {
         metrics->getMetricsMutable().compilationTime = 
             std::chrono::duration_cast<std::chrono::milliseconds>(compileEnd - compileStart);
@@ -95,6 +170,19 @@ bool ObfuscationEngine::processFile(const std::string& inputFile,
             std::chrono::duration_cast<std::chrono::milliseconds>(linkEnd - linkStart);
         metrics->getMetricsMutable().totalTime = 
             std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime);
+        metrics->getMetricsMutable().cacheMisses = cache_ ? 1 : 0;
+        
+        // Counters only see this thread: not clang, the linker or codegen partitions
+        if (config_.perfCounters) {
+            metrics->recordStageCounters("compile", compileEndCounters - compileStartCounters);
+            if (config_.lowMemory) {
+                metrics->recordStageCounters("obfuscate+codegen", linkStartCounters - obfStartCounters);
+            } else {
+                metrics->recordStageCounters("obfuscate", obfEndCounters - obfStartCounters);
+                metrics->recordStageCounters("codegen", linkStartCounters - obfEndCounters);
+            }
+            metrics->recordStageCounters("link", linkEndCounters - linkStartCounters);
+        }
         
         // Record file sizes
         metrics->recordFileSizes(
@@ -104,26 +192,188 @@ bool ObfuscationEngine::processFile(const std::string& inputFile,
     }
     
     // Clean up temporary files
-    FileUtils::deleteFile(irFile);
-    FileUtils::deleteFile(objectFile);
+    if (!config_.inMemoryPipeline) {
+        FileUtils::deleteFile(objectFile);
+    }
     
     Logger::getInstance().info("Obfuscation completed successfully");
     return true;
 }
 
-bool ObfuscationEngine::compileToIR(const std::string& sourceFile, 
-                                    const std::string& irFile) {
+bool ObfuscationEngine::processToObject(const std::string& inputFile,
+                                        llvm::SmallVectorImpl<char>& objectBuffer) {
+    Logger::getInstance().info("Processing translation unit: " + inputFile);
+    TraceSpan span("file", inputFile);
+    
+    auto compileStartCounters = readCounters();
+    auto module = compileToIR(inputFile, *context_);
+    if (!module) {
+        Logger::getInstance().error("Failed to compile source to IR: " + inputFile);
+        return false;
+    }
+    
+    auto compileEndCounters = readCounters();
+    
+    std::string cacheKey;
+    if (cache_) {
+        cacheKey = computeCacheKey(*module, "object", inputFile);
+        if (auto cached = cache_->lookup(cacheKey)) {
+            objectBuffer.assign(cached->getBufferStart(), cached->getBufferEnd());
+            
+            auto metrics = std::make_shared<MetricsCollector>();
+            metrics->getMetricsMutable().cacheHits = 1;
+            reportGenerator_->setMetricsCollector(metrics);
+            return true;
+        }
+    }
+    
+    if (config_.lowMemory) {
+        if (!compileInBatches(*module, objectBuffer)) {
+            Logger::getInstance().error("Failed to compile to object file: " + inputFile);
+            return false;
+        }
+        if (config_.perfCounters) {
+            auto metrics = reportGenerator_->getMetricsCollector();
+            metrics->recordStageCounters("compile", compileEndCounters - compileStartCounters);
+            metrics->recordStageCounters("obfuscate+codegen", readCounters() - compileEndCounters);
+        }
+        return true;
+    }
+    
+    if (!applyObfuscation(*module)) {
+        Logger::getInstance().error("Failed to apply obfuscation: " + inputFile);
+        return false;
+    }
+    auto obfEndCounters = readCounters();
+    
+    if (!compileToObject(*module, objectBuffer)) {
+        Logger::getInstance().error("Failed to compile to object file: " + inputFile);
+        return false;
+    }
+    
+    if (config_.perfCounters) {
+        auto metrics = reportGenerator_->getMetricsCollector();
+        metrics->recordStageCounters("compile", compileEndCounters - compileStartCounters);
+        metrics->recordStageCounters("obfuscate", obfEndCounters - compileEndCounters);
+        metrics->recordStageCounters("codegen", readCounters() - obfEndCounters);
+    }
+    
+    if (cache_) {
+        cache_->store(cacheKey, llvm::StringRef(objectBuffer.data(), objectBuffer.size()));
+        reportGenerator_->getMetricsCollector()->getMetricsMutable().cacheMisses = 1;
+    }
+    
+    return true;
+}
+
+std::unique_ptr<llvm::Module> ObfuscationEngine::compileStage(const std::string& inputFile,
+                                                              llvm::LLVMContext& context) {
+    auto module = compileToIR(inputFile, context);
+    if (!module) {
+        Logger::getInstance().error("Failed to compile source to IR: " + inputFile);
+    }
+    return module;
+}
+
+std::shared_ptr<MetricsCollector> ObfuscationEngine::obfuscateStage(llvm::Module& module) {
+    if (!applyObfuscation(module)) {
+        Logger::getInstance().error("Failed to apply obfuscation: " + module.getName().str());
+        return nullptr;
+    }
+    return reportGenerator_->getMetricsCollector();
+}
+
+bool ObfuscationEngine::codegenStage(llvm::Module& module,
+                                     llvm::SmallVectorImpl<char>& objectBuffer) {
+    if (!compileToObject(module, objectBuffer)) {
+        Logger::getInstance().error("Failed to compile to object file: " + module.getName().str());
+        return false;
+    }
+    return true;
+}
+
+bool ObfuscationEngine::linkStage(llvm::StringRef objectData, const std::string& outputFile,
+                                  const std::string& inputFile) {
+    if (!linkToBinary(objectData, outputFile, inputFile)) {
+        Logger::getInstance().error("Failed to link binary: " + outputFile);
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<llvm::Module> ObfuscationEngine::compileToIR(const std::string& sourceFile,
+                                                             llvm::LLVMContext& context) {
     Logger::getInstance().info("Compiling source to LLVM IR");
+    TraceSpan span("stage", "compile");
+    
+    std::unique_ptr<llvm::Module> module;
+    if (ClangFrontend::isAvailable()) {
+        module = frontend_->compile(sourceFile, context);
+        if (module && config_.lowMemory) {
+            // The frontend builds the module whole; round-trip it through
+            // bitcode so obfuscation and codegen load bodies batch by batch
+            llvm::SmallVector<char, 0> bitcode;
+            llvm::raw_svector_ostream stream(bitcode);
+            llvm::WriteBitcodeToFile(*module, stream);
+            module.reset();
+            module = loadModule(std::make_unique<llvm::SmallVectorMemoryBuffer>(
+                std::move(bitcode), sourceFile, /*RequiresNullTerminator=*/false), context);
+        }
+    } else if (config_.inMemoryPipeline) {
+        // No frontend linked in: go through clang, handing bitcode back
+        // through an in-memory file
+        auto bitcode = compileToIRBuffer(sourceFile);
+        if (bitcode) {
+            module = loadModule(std::move(bitcode), context);
+        }
+    } else {
+        module = compileToIRThroughFile(sourceFile, context);
+    }
+    
+    // Named after the source rather than the file or memfd the bitcode
+    // came through, so names derived from it (promoted locals) are stable
+    if (module) {
+        module->setModuleIdentifier(sourceFile);
+    }
+    return module;
+}
+
+std::unique_ptr<llvm::Module> ObfuscationEngine::compileToIRThroughFile(
+    const std::string& sourceFile, llvm::LLVMContext& context) {
+    
+    // Unique, so concurrent jobs on the same source do not collide
+    llvm::SmallString<128> irPath;
+    int irFD = -1;
+    if (std::error_code ec = llvm::sys::fs::createUniqueFile(sourceFile + ".%%%%%%.bc",
+                                                            irFD, irPath)) {
+        Logger::getInstance().error("Cannot create bitcode file: " + ec.message());
+        return nullptr;
+    }
+    llvm::sys::Process::SafelyCloseFileDescriptor(irFD);
+    std::string irFile(irPath.str());
+    if (!compileToIRFile(sourceFile, irFile)) {
+        FileUtils::deleteFile(irFile);
+        return nullptr;
+    }
     
+    auto module = loadModule(irFile, context);
+    FileUtils::deleteFile(irFile);
+    return module;
+}
+
+bool ObfuscationEngine::compileToIRFile(const std::string& sourceFile, 
+                                        const std::string& irFile) {
     std::ostringstream cmd;
     
     // Determine if C or C++
-    std::string ext = FileUtils::getFileExtension(sourceFile);
-    bool isCpp = (ext == ".cpp" || ext == ".cxx" || ext == ".cc");
+    bool isCpp = ClangFrontend::isCppSource(sourceFile);
     
     // Build clang command
     cmd << (isCpp ? "clang++ " : "clang ");
     cmd << "-emit-llvm -c -O1 -fPIC ";
+    for (const auto& arg : frontendArgs_) {
+        cmd << "\"" << arg << "\" ";
+    }
     cmd << "\"" << sourceFile << "\" ";
     cmd << "-o \"" << irFile << "\"";
     
@@ -131,11 +381,57 @@ bool ObfuscationEngine::compileToIR(const std::string& sourceFile,
     return result == 0;
 }
 
-std::unique_ptr<llvm::Module> ObfuscationEngine::loadModule(const std::string& irFile) {
+std::unique_ptr<llvm::MemoryBuffer> ObfuscationEngine::compileToIRBuffer(
+    const std::string& sourceFile) {
+    MemoryFile irFile("phantron-ir");
+    if (!irFile.isValid()) {
+        return nullptr;
+    }
+    
+    bool isCpp = ClangFrontend::isCppSource(sourceFile);
+    
+    // clang writes bitcode to stdout, which the shell points at the memfd
+    std::ostringstream cmd;
+    cmd << (isCpp ? "clang++ " : "clang ");
+    cmd << "-emit-llvm -c -O1 -fPIC ";
+    for (const auto& arg : frontendArgs_) {
+        cmd << "\"" << arg << "\" ";
+    }
+    cmd << "\"" << sourceFile << "\" ";
+    cmd << "-o - > \"" << irFile.getPath() << "\"";
+    
+    if (std::system(cmd.str().c_str()) != 0) {
+        return nullptr;
+    }
+    
+    return irFile.read();
+}
+
+std::unique_ptr<llvm::Module> ObfuscationEngine::loadModule(
+    std::unique_ptr<llvm::MemoryBuffer> buffer, llvm::LLVMContext& context) {
+    Logger::getInstance().info("Loading LLVM module");
+    
+    llvm::SMDiagnostic err;
+    auto module = config_.lowMemory
+        ? llvm::getLazyIRModule(std::move(buffer), err, context)
+        : llvm::parseIR(buffer->getMemBufferRef(), err, context);
+    
+    if (!module) {
+        Logger::getInstance().error("Failed to load IR: " + err.getMessage().str());
+        return nullptr;
+    }
+    
+    return module;
+}
+
+std::unique_ptr<llvm::Module> ObfuscationEngine::loadModule(const std::string& irFile,
+                                                            llvm::LLVMContext& context) {
     Logger::getInstance().info("Loading LLVM module");
     
     llvm::SMDiagnostic err;
-    auto module = llvm::parseIRFile(irFile, err, *context_);
+    auto module = config_.lowMemory
+        ? llvm::getLazyIRFileModule(irFile, err, context)
+        : llvm::parseIRFile(irFile, err, context);
     
     if (!module) {
         std::string errMsg = "Failed to load IR: " + err.getMessage().str();
@@ -148,6 +444,7 @@ std::unique_ptr<llvm::Module> ObfuscationEngine::loadModule(const std::string& i
 
 bool ObfuscationEngine::applyObfuscation(llvm::Module& module) {
     Logger::getInstance().info("Applying obfuscation transformations");
+    TraceSpan span("stage", "obfuscate");
     
     // Create metrics collector
     auto metrics = std::make_shared<MetricsCollector>();
@@ -168,13 +465,23 @@ bool ObfuscationEngine::applyObfuscation(llvm::Module& module) {
         }
     }
     
+    // Policies are part of the functions the cache compares
+    passManager_->resolvePolicies(module);
+    
+    // Unchanged functions keep their obfuscated bodies from an earlier run
+    if (functionCache_) {
+        TraceSpan cacheSpan("stage", "function cache lookup");
+        functionCache_->prepare(module);
+    }
+    
     // Run obfuscation passes multiple times
     for (uint32_t cycle = 0; cycle < config_.obfuscationCycles; ++cycle) {
         Logger::getInstance().info("Running obfuscation cycle " + 
                                   std::to_string(cycle + 1) + "/" + 
                                   std::to_string(config_.obfuscationCycles));
+        TraceSpan cycleSpan("cycle", "cycle " + std::to_string(cycle + 1));
         
-        if (!passManager_->runPasses(module, *metrics)) {
+        if (!passManager_->runPasses(module, *metrics, cycle)) {
             Logger::getInstance().warning("No transformations made in cycle " + 
                                         std::to_string(cycle + 1));
         }
@@ -182,6 +489,16 @@ bool ObfuscationEngine::applyObfuscation(llvm::Module& module) {
     
     metrics->getMetricsMutable().totalObfuscationCycles = config_.obfuscationCycles;
     
+    if (functionCache_) {
+        TraceSpan cacheSpan("stage", "function cache restore");
+        if (!functionCache_->finish(module)) {
+            Logger::getInstance().error("Failed to restore cached function bodies");
+            return false;
+        }
+        metrics->getMetricsMutable().functionCacheHits = functionCache_->getHitCount();
+        metrics->getMetricsMutable().functionCacheMisses = functionCache_->getMissCount();
+    }
+    
     // Count obfuscated code metrics
     uint32_t obfuscatedInsts = 0;
     uint32_t obfuscatedBBs = 0;
@@ -202,6 +519,7 @@ bool ObfuscationEngine::applyObfuscation(llvm::Module& module) {
     metrics->getMetricsMutable().obfuscatedFunctionCount = obfuscatedFuncs;
     
     // Verify module integrity
+    TraceSpan verifySpan("stage", "verify");
     std::string errorMsg;
     llvm::raw_string_ostream errorStream(errorMsg);
     if (llvm::verifyModule(module, &errorStream)) {
@@ -215,59 +533,181 @@ bool ObfuscationEngine::applyObfuscation(llvm::Module& module) {
 bool ObfuscationEngine::compileToObject(llvm::Module& module, 
                                        const std::string& objectFile) {
     Logger::getInstance().info("Compiling IR to object file");
+    TraceSpan span("stage", "codegen");
     
-    // Write module to temporary IR file
-    std::string tempIR = objectFile + ".tmp.bc";
-    std::error_code ec;
-    llvm::raw_fd_ostream dest(tempIR, ec, llvm::sys::fs::OF_None);
-    
-    if (ec) {
-        Logger::getInstance().error("Failed to open temporary file: " + ec.message());
+    uint32_t partitions = CodeGenerator::getPartitionCount(module, config_.codegenJobs);
+    if (partitions > 1) {
+        return compilePartitions(module, partitions, [&](const std::vector<std::string>& paths) {
+            return linker_->linkRelocatable(paths, objectFile);
+        });
+    }
+    return codeGenerator_->emitObject(module, objectFile);
+}
+
+bool ObfuscationEngine::compileToObject(llvm::Module& module,
+                                       llvm::SmallVectorImpl<char>& objectBuffer) {
+    Logger::getInstance().info("Compiling IR to in-memory object");
+    TraceSpan span("stage", "codegen");
+    
+    uint32_t partitions = CodeGenerator::getPartitionCount(module, config_.codegenJobs);
+    if (partitions > 1) {
+        return compilePartitions(module, partitions, [&](const std::vector<std::string>& paths) {
+            return linker_->linkRelocatable(paths, objectBuffer);
+        });
+    }
+    return codeGenerator_->emitObject(module, objectBuffer);
+}
+
+bool ObfuscationEngine::compilePartitions(
+        llvm::Module& module, uint32_t partitions,
+        const std::function<bool(const std::vector<std::string>&)>& combine) {
+    std::vector<llvm::SmallVector<char, 0>> objects;
+    if (!codeGenerator_->emitPartitions(module, partitions, objects)) {
         return false;
     }
     
-    llvm::WriteBitcodeToFile(module, dest);
-    dest.flush();
+    // Partition objects reach the linker through memfds
+    std::vector<std::unique_ptr<MemoryFile>> files;
+    std::vector<std::string> paths;
+    for (const auto& object : objects) {
+        auto file = std::make_unique<MemoryFile>("phantron-part");
+        if (!file->write(llvm::StringRef(object.data(), object.size()))) {
+            Logger::getInstance().error("Failed to stage codegen partition for linking");
+            return false;
+        }
+        paths.push_back(file->getPath());
+        files.push_back(std::move(file));
+    }
     
-    // Compile IR to object file using llc
-    std::ostringstream cmd;
-    cmd << "llc -filetype=obj ";
-    cmd << "\"" << tempIR << "\" ";
-    cmd << "-o \"" << objectFile << "\"";
+    Logger::getInstance().info("Combining " + std::to_string(objects.size()) +
+                               " codegen partitions");
+    return combine(paths);
+}
+
+bool ObfuscationEngine::compileInBatches(llvm::Module& module, const std::string& objectFile) {
+    if (!LowMemoryPipeline::canRun(module)) {
+        return obfuscateWhole(module) && compileToObject(module, objectFile);
+    }
     
-    int result = std::system(cmd.str().c_str());
-    FileUtils::deleteFile(tempIR);
+    TraceSpan span("stage", "obfuscate and codegen in batches");
+    LowMemoryPipeline pipeline(config_, *passManager_, *linker_);
+    return pipeline.run(module, startBatchMetrics(), objectFile);
+}
+
+bool ObfuscationEngine::compileInBatches(llvm::Module& module,
+                                         llvm::SmallVectorImpl<char>& objectBuffer) {
+    if (!LowMemoryPipeline::canRun(module)) {
+        return obfuscateWhole(module) && compileToObject(module, objectBuffer);
+    }
     
-    return result == 0;
+    TraceSpan span("stage", "obfuscate and codegen in batches");
+    LowMemoryPipeline pipeline(config_, *passManager_, *linker_);
+    return pipeline.run(module, startBatchMetrics(), objectBuffer);
+}
+
+bool ObfuscationEngine::obfuscateWhole(llvm::Module& module) {
+    Logger::getInstance().warning("Module cannot be compiled in batches, loading it whole");
+    if (llvm::Error error = module.materializeAll()) {
+        Logger::getInstance().error("Failed to load module: " +
+                                    llvm::toString(std::move(error)));
+        return false;
+    }
+    return applyObfuscation(module);
+}
+
+MetricsCollector& ObfuscationEngine::startBatchMetrics() {
+    Logger::getInstance().info("Obfuscating and compiling in batches of " +
+                               std::to_string(config_.batchFunctions) + " functions");
+    auto metrics = std::make_shared<MetricsCollector>();
+    reportGenerator_->setMetricsCollector(metrics);
+    return *metrics;
 }
 
 bool ObfuscationEngine::linkToBinary(const std::string& objectFile, 
                                      const std::string& binaryFile,
                                      const std::string& inputFile) {
     Logger::getInstance().info("Linking object file to binary");
+    TraceSpan span("stage", "link");
     
-    std::ostringstream cmd;
+    LinkerOptions options = Linker::makeOptions(
+        config_, ClangFrontend::isCppSource(inputFile));
+    options.objectFiles.push_back(objectFile);
+    options.outputFile = binaryFile;
+    
+    return linker_->link(options);
+}
+
+bool ObfuscationEngine::linkToBinary(llvm::StringRef objectData,
+                                     const std::string& binaryFile,
+                                     const std::string& inputFile) {
+    // The linker needs a path, so expose the object through a memfd
+    MemoryFile objectFile("phantron-obj");
+    if (!objectFile.write(objectData)) {
+        Logger::getInstance().error("Failed to stage object data for linking");
+        return false;
+    }
     
-#ifdef _WIN32
-    cmd << "link.exe ";
-    cmd << "\"" << objectFile << "\" ";
-    cmd << "/OUT:\"" << binaryFile << "\"";
-#else
-    // Detect C++ files by extension
-    bool isCpp = (inputFile.substr(inputFile.find_last_of(".") + 1) == "cpp");
+    return linkToBinary(objectFile.getPath(), binaryFile, inputFile);
+}
+
+std::string ObfuscationEngine::computeCacheKey(const llvm::Module& module, llvm::StringRef kind,
+                                              const std::string& inputFile) const {
+    // The frontend's IR stands in for the preprocessed source, so header
+    // and compiler changes are covered too. Textual IR, because bitcode
+    // also carries context state such as every metadata kind registered
+    // by earlier units. The ModuleID line names a temporary file.
+    TraceSpan span("stage", "cache key");
+    llvm::SmallVector<char, 0> input;
+    llvm::raw_svector_ostream stream(input);
+    module.print(stream, nullptr);
+    llvm::StringRef text(input.data(), input.size());
+    if (text.startswith("; ModuleID")) {
+        input.erase(input.begin(), input.begin() + text.find('\n') + 1);
+    }
     
-    cmd << (isCpp ? "clang++ " : "clang ");
-    cmd << "-no-pie ";  // Disable PIE to avoid relocation issues
-    cmd << "\"" << objectFile << "\" ";
-    cmd << "-lm ";  // Link math library
-    if (isCpp) {
-        cmd << "-lstdc++ ";  // Link C++ standard library for C++ files
+    std::string resultKind = kind.str();
+    if (kind == "binary") {
+        resultKind += ClangFrontend::isCppSource(inputFile) ? "/c++" : "/c";
+        
+        // Extra link inputs are named in the config; their contents count too
+        for (const auto& objectPath : config_.linkObjects) {
+            auto object = llvm::MemoryBuffer::getFile(objectPath, /*IsText=*/false,
+                                                      /*RequiresNullTerminator=*/false);
+            stream << "\n" << objectPath << "\n";
+            if (object) {
+                stream << (*object)->getBuffer();
+            }
+        }
     }
-    cmd << "-o \"" << binaryFile << "\"";
-#endif
     
-    int result = std::system(cmd.str().c_str());
-    return result == 0;
+    return ResultCache::computeKey(llvm::StringRef(input.data(), input.size()), config_,
+                                   resultKind);
+}
+
+bool ObfuscationEngine::writeCachedBinary(const llvm::MemoryBuffer& binary,
+                                          const std::string& binaryFile) {
+    std::error_code ec;
+    llvm::raw_fd_ostream out(binaryFile, ec, llvm::sys::fs::OF_None);
+    if (ec) {
+        Logger::getInstance().error("Cannot write " + binaryFile + ": " + ec.message());
+        return false;
+    }
+    out << binary.getBuffer();
+    out.close();
+    if (out.has_error()) {
+        out.clear_error();
+        Logger::getInstance().error("Cannot write " + binaryFile);
+        return false;
+    }
+    
+    // Cache entries are plain files; restore what the linker would have set
+    llvm::sys::fs::setPermissions(binaryFile, llvm::sys::fs::all_read | llvm::sys::fs::all_exe |
+                                                  llvm::sys::fs::owner_write);
+    return true;
+}
+
+PerfCounterValues ObfuscationEngine::readCounters() const {
+    return config_.perfCounters ? PerfCounters::forThread().read() : PerfCounterValues();
 }
 
 std::shared_ptr<ReportGenerator> ObfuscationEngine::getReportGenerator() const {
@@ -6,12 +6,17 @@
  */
 
 #include "ObfuscationPass.h"
+#include "PassAdaptors.h"
+#include "MetricsCollector.h"
+#include "FunctionPolicy.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
 #include "llvm/IR/Function.h"
+#include "llvm/IR/Metadata.h"
 
 namespace obfuscator {
 
 ObfuscationPass::ObfuscationPass(const std::string& name, bool enabled)
-    : name_(name), enabled_(enabled), seed_(0) {
+    : name_(name), enabled_(enabled), seed_(0), cycle_(0), hotLoopThreshold_(0) {
 }
 
 bool ObfuscationPass::shouldObfuscateFunction(llvm::Function& func) const {
@@ -30,7 +35,10 @@ bool ObfuscationPass::shouldObfuscateFunction(llvm::Function& func) const {
         return false;
     }
     
-    // Skip functions with specific annotations
+    // Skip functions a policy excludes, or (legacy) placed in a "noobf" section
+    if (FunctionPolicy::isExcluded(func)) {
+        return false;
+    }
     if (func.hasSection() && func.getSection().contains("noobf")) {
         return false;
     }
@@ -38,4 +46,59 @@ bool ObfuscationPass::shouldObfuscateFunction(llvm::Function& func) const {
     return true;
 }
 
+bool ObfuscationPass::run(llvm::Module& module, MetricsCollector& metrics,
+                          llvm::ModuleAnalysisManager& analyses) {
+    bool modified = false;
+    llvm::ModulePassManager passes;
+    passes.addPass(ModulePassAdaptor(*this, metrics, modified));
+    passes.run(module, analyses);
+    return modified;
+}
+
+bool FunctionObfuscationPass::runOnModule(llvm::Module& module, MetricsCollector& metrics) {
+    AnalysisManagers analyses;
+    return run(module, metrics, analyses.getModuleManager());
+}
+
+bool FunctionObfuscationPass::run(llvm::Module& module, MetricsCollector& metrics,
+                                  llvm::ModuleAnalysisManager& analyses) {
+    uint32_t transformations = 0;
+    llvm::ModulePassManager passes;
+    // Function passes can only read module analyses that are already cached
+    passes.addPass(llvm::RequireAnalysisPass<llvm::ProfileSummaryAnalysis, llvm::Module>());
+    passes.addPass(llvm::createModuleToFunctionPassAdaptor(
+        FunctionPassAdaptor(*this, transformations)));
+    passes.run(module, analyses);
+    
+    recordTransformations(metrics, transformations);
+    return transformations > 0;
+}
+
+uint32_t FunctionObfuscationPass::obfuscateFunction(llvm::Function& func,
+                                                    llvm::FunctionAnalysisManager& analyses) {
+    std::string marker = "obfuscated." + name_;
+    // Functions a policy gave another level are left to that level's passes
+    if (func.getMetadata(marker) || FunctionPolicy::getLevel(func) != policyLevel_ ||
+        !shouldObfuscateFunction(func)) {
+        return 0;
+    }
+    
+    uint32_t transformations = runOnFunction(func, analyses);
+    if (transformations > 0) {
+        llvm::LLVMContext& ctx = func.getContext();
+        func.setMetadata(marker, llvm::MDNode::get(ctx, llvm::MDString::get(ctx, name_)));
+    }
+    return transformations;
+}
+
+bool FunctionObfuscationPass::preservesCFG() const {
+    PassTraits traits = getTraits();
+    return !(traits.produced & IR_BASIC_BLOCKS) && !(traits.invalidated & IR_STRUCTURED_CFG);
+}
+
+void FunctionObfuscationPass::recordTransformations(MetricsCollector& metrics,
+                                                    uint32_t count) const {
+    metrics.incrementTransformations(name_, count);
+}
+
 } // namespace obfuscator
@@ -0,0 +1,208 @@
+/**
+ * @file ParallelPassRunner.cpp
+ * @brief Implementation of ParallelPassRunner
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "ParallelPassRunner.h"
+#include "FunctionTransplant.h"
+#include "PassAdaptors.h"
+#include "Logger.h"
+#include "Tracer.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+
+namespace obfuscator {
+
+namespace {
+
+uint64_t countInstructions(const llvm::Function& func) {
+    uint64_t count = 0;
+    for (const auto& bb : func) {
+        count += bb.size();
+    }
+    return count;
+}
+
+} // anonymous namespace
+
+ParallelPassRunner::ParallelPassRunner(uint32_t threadCount, bool countEvents,
+                                       bool measureMemory)
+    : pool_(threadCount), countEvents_(countEvents), measureMemory_(measureMemory) {
+}
+
+bool ParallelPassRunner::canShard(const llvm::Module& module) {
+    if (!FunctionTransplant::canTransplant(module)) {
+        return false;
+    }
+
+    size_t definitions = 0;
+    for (const auto& func : module) {
+        if (!func.isDeclaration()) {
+            ++definitions;
+        }
+    }
+    return definitions >= 2;
+}
+
+bool ParallelPassRunner::run(llvm::Module& module, const std::vector<ObfuscationPass*>& passes,
+                             MetricsCollector& metrics, std::vector<PassOutcome>& outcomes) {
+    if (passes.empty() || !canShard(module)) {
+        return false;
+    }
+
+    // Step 1: Extract shards (serial, cloning touches the shared context)
+    FunctionTransplant transplant(module);
+    auto shards = partition(module);
+    for (auto& shard : shards) {
+        auto shardModule = transplant.extract(shard->functions);
+        llvm::raw_svector_ostream stream(shard->bitcode);
+        llvm::WriteBitcodeToFile(*shardModule, stream);
+    }
+
+    // Step 2: Transform every shard in its own context
+    pool_.parallelFor(shards.size(), [&](size_t index) {
+        runShard(*shards[index], passes);
+    });
+
+    // Step 3: Stage the shards, in order, back in the main context
+    for (auto& shard : shards) {
+        if (!shard->success) {
+            return false;
+        }
+        llvm::MemoryBufferRef buffer(
+            llvm::StringRef(shard->bitcode.data(), shard->bitcode.size()), "shard");
+        auto result = llvm::parseBitcodeFile(buffer, module.getContext());
+        if (!result) {
+            Logger::getInstance().error("Failed to reload shard: " +
+                                        llvm::toString(result.takeError()));
+            return false;
+        }
+        // Nothing was committed yet, so the transplant restores the module
+        if (!transplant.stage(std::move(*result))) {
+            return false;
+        }
+    }
+
+    // Step 4: Commit phase. All new declarations, intrinsics and globals
+    // enter the module here, in one link
+    std::vector<llvm::Function*> originals;
+    for (const auto& shard : shards) {
+        originals.insert(originals.end(), shard->functions.begin(), shard->functions.end());
+    }
+    transplant.commit(originals);
+    transplant.restore();
+
+    outcomes.assign(passes.size(), PassOutcome());
+    for (const auto& shard : shards) {
+        metrics.merge(shard->metrics);
+        for (size_t i = 0; i < passes.size(); ++i) {
+            outcomes[i].modified |= shard->outcomes[i].modified;
+            outcomes[i].cpuTime += shard->outcomes[i].cpuTime;
+            outcomes[i].counters += shard->outcomes[i].counters;
+            outcomes[i].irDelta += shard->outcomes[i].irDelta;
+            outcomes[i].allocatedBytes += shard->outcomes[i].allocatedBytes;
+        }
+    }
+
+    Logger::getInstance().debug("Ran " + std::to_string(passes.size()) + " passes over " +
+                                std::to_string(shards.size()) + " shards on " +
+                                std::to_string(pool_.getThreadCount()) + " threads");
+    return true;
+}
+
+std::vector<std::unique_ptr<ParallelPassRunner::Shard>>
+ParallelPassRunner::partition(llvm::Module& module) const {
+    std::vector<llvm::Function*> functions;
+    for (auto& func : module) {
+        if (!func.isDeclaration()) {
+            functions.push_back(&func);
+        }
+    }
+
+    // A few shards per thread leaves room for stealing; per-function
+    // tracing wants every function in a shard of its own
+    size_t shardCount = Tracer::getInstance().tracesFunctions()
+        ? functions.size()
+        : std::min<size_t>(functions.size(), pool_.getThreadCount() * 4);
+    std::vector<std::unique_ptr<Shard>> shards;
+    for (size_t i = 0; i < shardCount; ++i) {
+        shards.push_back(std::make_unique<Shard>());
+    }
+
+    // Largest function first onto the lightest shard
+    std::vector<std::pair<uint64_t, llvm::Function*>> sized;
+    for (auto* func : functions) {
+        sized.push_back({countInstructions(*func), func});
+    }
+    std::stable_sort(sized.begin(), sized.end(),
+                     [](const auto& a, const auto& b) { return a.first > b.first; });
+
+    for (const auto& entry : sized) {
+        Shard* lightest = shards.front().get();
+        for (auto& shard : shards) {
+            if (shard->instructionCount < lightest->instructionCount) {
+                lightest = shard.get();
+            }
+        }
+        lightest->functions.push_back(entry.second);
+        lightest->instructionCount += entry.first;
+    }
+
+    return shards;
+}
+
+void ParallelPassRunner::runShard(Shard& shard, const std::vector<ObfuscationPass*>& passes) const {
+    llvm::LLVMContext context;
+    llvm::MemoryBufferRef buffer(
+        llvm::StringRef(shard.bitcode.data(), shard.bitcode.size()), "shard");
+
+    auto shardModule = llvm::parseBitcodeFile(buffer, context);
+    if (!shardModule) {
+        Logger::getInstance().error("Failed to load shard: " +
+                                    llvm::toString(shardModule.takeError()));
+        return;
+    }
+
+    // The passes of the batch share the shard's cached analyses
+    AnalysisManagers analyses;
+    shard.outcomes.assign(passes.size(), PassOutcome());
+    for (size_t i = 0; i < passes.size(); ++i) {
+        // The main module is not modified while shards run
+        TraceSpan span("shard", passes[i]->getName());
+        if (shard.functions.size() == 1) {
+            span.addArgument("function", shard.functions.front()->getName().str());
+        } else {
+            span.addArgument("functions", static_cast<int64_t>(shard.functions.size()));
+        }
+        span.addArgument("instructions", static_cast<int64_t>(shard.instructionCount));
+        PerfCounters* counters = countEvents_ ? &PerfCounters::forThread() : nullptr;
+        PerfCounterValues countersBefore = counters ? counters->read() : PerfCounterValues();
+        IRSize sizeBefore = measureMemory_ ? IRSize::measure(**shardModule) : IRSize();
+        uint64_t allocatedBefore = MemoryTracker::getThreadAllocatedBytes();
+        auto startTime = std::chrono::high_resolution_clock::now();
+        shard.outcomes[i].modified =
+            passes[i]->run(**shardModule, shard.metrics, analyses.getModuleManager());
+        shard.outcomes[i].cpuTime = std::chrono::high_resolution_clock::now() - startTime;
+        if (counters) {
+            shard.outcomes[i].counters = counters->read() - countersBefore;
+        }
+        if (measureMemory_) {
+            shard.outcomes[i].allocatedBytes =
+                MemoryTracker::getThreadAllocatedBytes() - allocatedBefore;
+            shard.outcomes[i].irDelta = IRSize::measure(**shardModule) - sizeBefore;
+        }
+    }
+
+    shard.bitcode.clear();
+    llvm::raw_svector_ostream stream(shard.bitcode);
+    llvm::WriteBitcodeToFile(**shardModule, stream);
+    shard.success = true;
+}
+
+} // namespace obfuscator
@@ -0,0 +1,50 @@
+/**
+ * @file PassAdaptors.cpp
+ * @brief Implementation of the new pass manager adaptors
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "PassAdaptors.h"
+#include "llvm/Analysis/CGSCCPassManager.h"
+#include "llvm/Analysis/LoopAnalysisManager.h"
+
+namespace obfuscator {
+
+AnalysisManagers::AnalysisManagers() {
+    builder_.registerModuleAnalyses(moduleManager_);
+    builder_.registerCGSCCAnalyses(cgsccManager_);
+    builder_.registerFunctionAnalyses(functionManager_);
+    builder_.registerLoopAnalyses(loopManager_);
+    builder_.crossRegisterProxies(loopManager_, functionManager_, cgsccManager_, moduleManager_);
+}
+
+void AnalysisManagers::clear() {
+    loopManager_.clear();
+    functionManager_.clear();
+    cgsccManager_.clear();
+    moduleManager_.clear();
+}
+
+llvm::PreservedAnalyses FunctionPassAdaptor::run(llvm::Function& func,
+                                                 llvm::FunctionAnalysisManager& analyses) {
+    uint32_t transformations = pass_->obfuscateFunction(func, analyses);
+    if (transformations == 0) {
+        return llvm::PreservedAnalyses::all();
+    }
+    *transformations_ += transformations;
+
+    llvm::PreservedAnalyses preserved;
+    if (pass_->preservesCFG()) {
+        preserved.preserveSet<llvm::CFGAnalyses>();
+    }
+    return preserved;
+}
+
+llvm::PreservedAnalyses ModulePassAdaptor::run(llvm::Module& module,
+                                               llvm::ModuleAnalysisManager&) {
+    *modified_ = pass_->runOnModule(module, *metrics_);
+    return *modified_ ? llvm::PreservedAnalyses::none() : llvm::PreservedAnalyses::all();
+}
+
+} // namespace obfuscator
@@ -6,6 +6,8 @@
  */
 
 #include "PassManager.h"
+#include "PassScheduler.h"
+#include "FunctionPolicy.h"
 #include "passes/MBAObfuscation.h"
 #include "passes/QuantumOpaquePredicates.h"
 #include "passes/HardwareCacheObfuscation.h"
@@ -17,13 +19,68 @@
 #include "passes/ConstantObfuscation.h"
 #include "passes/AntiDebug.h"
 #include "Logger.h"
-#include "RandomGenerator.h"
+#include "Tracer.h"
+#include "PerfCounters.h"
+#include "MemoryTracker.h"
+#include <algorithm>
 
 namespace obfuscator {
 
+namespace {
+
+/**
+ * @brief IR size and memory use of a module from construction to finish()
+ */
+class MemoryProbe {
+public:
+    MemoryProbe(bool enabled, const llvm::Module& module) : enabled_(enabled) {
+        if (!enabled_) {
+            return;
+        }
+        irBefore_ = IRSize::measure(module);
+        residentBefore_ = MemoryTracker::getResidentBytes();
+        MemoryTracker::resetPeakResident();
+        allocatedBefore_ = MemoryTracker::getThreadAllocatedBytes();
+    }
+
+    bool isEnabled() const { return enabled_; }
+
+    PassMemoryStats finish(const llvm::Module& module) const {
+        PassMemoryStats stats;
+        stats.allocatedBytes = MemoryTracker::getThreadAllocatedBytes() - allocatedBefore_;
+        stats.peakResidentBytes = MemoryTracker::getPeakResidentBytes();
+        stats.peakResidentGrowth = static_cast<int64_t>(stats.peakResidentBytes) -
+                                   static_cast<int64_t>(residentBefore_);
+        stats.residentDelta = static_cast<int64_t>(MemoryTracker::getResidentBytes()) -
+                              static_cast<int64_t>(residentBefore_);
+        IRSize delta = IRSize::measure(module) - irBefore_;
+        stats.instructionDelta = delta.instructions;
+        stats.basicBlockDelta = delta.basicBlocks;
+        stats.functionDelta = delta.functions;
+        stats.globalDelta = delta.globals;
+        return stats;
+    }
+
+private:
+    bool enabled_;
+    IRSize irBefore_;
+    uint64_t residentBefore_ = 0;
+    uint64_t allocatedBefore_ = 0;
+};
+
+} // anonymous namespace
+
 PassManager::PassManager(const ObfuscationConfig& config)
     : config_(config) {
     initializePasses();
+    
+    if (config_.passJobs != 1) {
+        parallelRunner_ = std::make_unique<ParallelPassRunner>(
+            config_.passJobs, config_.perfCounters, config_.memoryProfile);
+        Logger::getInstance().info("Function-local passes run on " +
+                                   std::to_string(parallelRunner_->getThreadCount()) +
+                                   " threads");
+    }
 }
 
 PassManager::~PassManager() {
@@ -31,34 +88,192 @@ PassManager::~PassManager() {
 
 void PassManager::addPass(std::unique_ptr<ObfuscationPass> pass) {
     passes_.push_back(std::move(pass));
+    scheduled_ = false;
+}
+
+const std::vector<std::string>& PassManager::getSchedule() {
+    if (!scheduled_) {
+        schedulePasses();
+    }
+    return schedule_;
 }
 
-bool PassManager::runPasses(llvm::Module& module, MetricsCollector& metrics) {
+void PassManager::schedulePasses() {
+    std::vector<const ObfuscationPass*> registered;
+    for (const auto& pass : passes_) {
+        registered.push_back(pass.get());
+    }
+    
+    PassScheduler scheduler;
+    std::vector<size_t> order = scheduler.schedule(registered);
+    for (const auto& decision : scheduler.getDecisions()) {
+        Logger::getInstance().debug("Schedule: " + decision);
+    }
+    if (scheduler.hadConflict()) {
+        Logger::getInstance().warning("Pass constraints conflict, part of the schedule "
+                                      "follows registration order");
+    }
+    
+    std::vector<std::unique_ptr<ObfuscationPass>> ordered;
+    schedule_.clear();
+    for (size_t index : order) {
+        schedule_.push_back(passes_[index]->getName());
+        ordered.push_back(std::move(passes_[index]));
+    }
+    passes_ = std::move(ordered);
+    scheduled_ = true;
+    
+    std::string summary;
+    for (const auto& name : schedule_) {
+        summary += (summary.empty() ? "" : " -> ") + name;
+    }
+    Logger::getInstance().info("Pass schedule: " + (summary.empty() ? "(empty)" : summary));
+}
+
+bool PassManager::runPasses(llvm::Module& module, MetricsCollector& metrics, uint32_t cycle) {
     bool modified = false;
     
-    // Set random seed
-    RandomGenerator::getInstance().seed(config_.seed);
+    metrics.recordPassSchedule(getSchedule());
+    
+    // Analyses are shared by all passes of this cycle; the passes'
+    // PreservedAnalyses decide what has to be recomputed
+    AnalysisManagers analyses;
     
-    for (auto& pass : passes_) {
-        if (!pass->isEnabled()) {
+    size_t index = 0;
+    while (index < passes_.size()) {
+        ObfuscationPass& pass = *passes_[index];
+        if (!pass.isEnabled()) {
+            ++index;
             continue;
         }
         
-        Logger::getInstance().info("Running pass: " + pass->getName());
+        // Passes derive per-function random streams from seed and cycle
+        pass.setCycle(cycle);
         
-        auto startTime = std::chrono::high_resolution_clock::now();
-        bool passModified = pass->runOnModule(module, metrics);
-        auto endTime = std::chrono::high_resolution_clock::now();
+        if (!parallelRunner_ || !pass.isFunctionLocal()) {
+            modified |= runPass(pass, module, metrics, cycle, analyses);
+            ++index;
+            continue;
+        }
         
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(
-            endTime - startTime);
-        metrics.recordTiming(pass->getName(), duration);
+        // Batch this and the following function-local passes so the
+        // module is only split and committed once for all of them
+        std::vector<ObfuscationPass*> batch;
+        for (; index < passes_.size(); ++index) {
+            ObfuscationPass& next = *passes_[index];
+            if (!next.isEnabled()) {
+                continue;
+            }
+            if (!next.isFunctionLocal()) {
+                break;
+            }
+            next.setCycle(cycle);
+            batch.push_back(&next);
+        }
+        modified |= runFunctionLocalPasses(batch, module, metrics, cycle, analyses);
+    }
+    
+    return modified;
+}
+
+bool PassManager::runPass(ObfuscationPass& pass, llvm::Module& module, MetricsCollector& metrics,
+                          uint32_t cycle, AnalysisManagers& analyses) {
+    Logger::getInstance().info("Running pass: " + pass.getName());
+    
+    TraceSpan span("pass", pass.getName());
+    PerfCounters* counters = config_.perfCounters ? &PerfCounters::forThread() : nullptr;
+    PerfCounterValues countersBefore = counters ? counters->read() : PerfCounterValues();
+    MemoryProbe memory(config_.memoryProfile, module);
+    auto startTime = std::chrono::high_resolution_clock::now();
+    bool passModified = pass.run(module, metrics, analyses.getModuleManager());
+    auto endTime = std::chrono::high_resolution_clock::now();
+    span.addArgument("modified", passModified);
+    
+    if (memory.isEnabled()) {
+        PassMemoryStats stats = memory.finish(module);
+        stats.pass = pass.getName();
+        stats.cycle = cycle;
+        metrics.recordPassMemory(stats);
+    }
+    
+    metrics.recordTiming(pass.getName(), endTime - startTime);
+    if (counters) {
+        metrics.recordPassCounters(pass.getName(), counters->read() - countersBefore);
+    }
+    
+    if (passModified) {
+        Logger::getInstance().info("Pass " + pass.getName() + " made transformations");
+    } else {
+        Logger::getInstance().info("Pass " + pass.getName() + " made no changes");
+    }
+    
+    return passModified;
+}
+
+bool PassManager::runFunctionLocalPasses(const std::vector<ObfuscationPass*>& batch,
+                                         llvm::Module& module, MetricsCollector& metrics,
+                                         uint32_t cycle, AnalysisManagers& analyses) {
+    bool modified = false;
+    
+    // One span for the batch; the shards trace their passes themselves
+    TraceSpan span("pass", "parallel batch");
+    span.addArgument("passes", static_cast<int64_t>(batch.size()));
+    MemoryProbe memory(config_.memoryProfile, module);
+    auto startTime = std::chrono::high_resolution_clock::now();
+    std::vector<PassOutcome> outcomes;
+    if (!parallelRunner_->run(module, batch, metrics, outcomes)) {
+        Logger::getInstance().debug("Module cannot be sharded, running passes serially");
+        for (auto* pass : batch) {
+            modified |= runPass(*pass, module, metrics, cycle, analyses);
+        }
+        return modified;
+    }
+    auto endTime = std::chrono::high_resolution_clock::now();
+    
+    // The shards' functions replaced the originals behind the managers' back
+    analyses.clear();
+    
+    // Shards measured each pass's IR growth and allocations; resident
+    // memory can only be told for the batch as a whole
+    PassMemoryStats batchMemory;
+    if (memory.isEnabled()) {
+        batchMemory = memory.finish(module);
+        batchMemory.batched = true;
+        batchMemory.cycle = cycle;
+    }
+    
+    // Split the batch's wall time across passes by their share of CPU time
+    auto wallTime = std::chrono::duration_cast<std::chrono::nanoseconds>(endTime - startTime);
+    std::chrono::nanoseconds totalCpuTime(0);
+    for (const auto& outcome : outcomes) {
+        totalCpuTime += outcome.cpuTime;
+    }
+    
+    for (size_t i = 0; i < batch.size(); ++i) {
+        auto share = totalCpuTime.count() > 0
+            ? wallTime * outcomes[i].cpuTime.count() / totalCpuTime.count()
+            : wallTime / static_cast<int64_t>(batch.size());
+        metrics.recordTiming(batch[i]->getName(), share);
+        if (config_.perfCounters) {
+            metrics.recordPassCounters(batch[i]->getName(), outcomes[i].counters);
+        }
+        if (memory.isEnabled()) {
+            PassMemoryStats stats = batchMemory;
+            stats.pass = batch[i]->getName();
+            stats.instructionDelta = outcomes[i].irDelta.instructions;
+            stats.basicBlockDelta = outcomes[i].irDelta.basicBlocks;
+            stats.functionDelta = outcomes[i].irDelta.functions;
+            stats.globalDelta = outcomes[i].irDelta.globals;
+            stats.allocatedBytes = outcomes[i].allocatedBytes;
+            metrics.recordPassMemory(stats);
+        }
         
-        if (passModified) {
-            Logger::getInstance().info("Pass " + pass->getName() + " made transformations");
+        if (outcomes[i].modified) {
+            Logger::getInstance().info("Pass " + batch[i]->getName() +
+                                       " made transformations (parallel)");
             modified = true;
         } else {
-            Logger::getInstance().info("Pass " + pass->getName() + " made no changes");
+            Logger::getInstance().info("Pass " + batch[i]->getName() + " made no changes (parallel)");
         }
     }
     
@@ -67,91 +282,132 @@ bool PassManager::runPasses(llvm::Module& module, MetricsCollector& metrics) {
 
 void PassManager::clearPasses() {
     passes_.clear();
+    schedule_.clear();
+    scheduled_ = true;
 }
 
 void PassManager::initializePasses() {
     Logger::getInstance().info("Initializing advanced quantum-enhanced obfuscation passes (v2.0)");
     
+    addConfiguredPasses(config_, "");
+    
+    Logger::getInstance().info("Initialized " + std::to_string(passes_.size()) + 
+                               " quantum-enhanced obfuscation passes");
+    schedulePasses();
+}
+
+void PassManager::resolvePolicies(llvm::Module& module) {
+    for (const auto& level : FunctionPolicy::resolve(module, config_)) {
+        if (std::find(policyLevels_.begin(), policyLevels_.end(), level) != policyLevels_.end()) {
+            continue;
+        }
+        policyLevels_.push_back(level);
+        
+        // The level's preset decides its passes and their settings; the
+        // module-wide passes still run once, for the configured level
+        ObfuscationConfig levelConfig = config_;
+        levelConfig.applyPreset(level == "low" ? ObfuscationLevel::LOW
+                                : level == "medium" ? ObfuscationLevel::MEDIUM
+                                : ObfuscationLevel::HIGH);
+        size_t before = passes_.size();
+        addConfiguredPasses(levelConfig, level);
+        Logger::getInstance().info("Added " + std::to_string(passes_.size() - before) +
+                                   " passes for functions at level " + level);
+    }
+}
+
+void PassManager::addConfiguredPasses(const ObfuscationConfig& config,
+                                      const std::string& policyLevel) {
+    // The layers are registered in their classic order, which only breaks
+    // ties: schedulePasses() decides the run order from the passes' traits
+    std::vector<std::unique_ptr<ObfuscationPass>> passes;
+    
     // LAYER 1: MBA Expression Substitution (defeats SMT solvers)
-    if (config_.enableInstructionSubstitution) {
+    if (config.enableInstructionSubstitution) {
         auto pass = std::make_unique<MBAObfuscation>(
-            config_.substitutionProbability);
-        pass->setSeed(config_.seed);
-        addPass(std::move(pass));
+            config.substitutionProbability);
+        pass->setSeed(config.seed);
+        passes.push_back(std::move(pass));
     }
     
     // LAYER 2: String Encryption with Runtime Decryption
-    if (config_.enableStringEncryption) {
+    if (config.enableStringEncryption) {
         auto pass = std::make_unique<StringEncryption>(
-            config_.stringEncryptionAlgorithm);
-        pass->setSeed(config_.seed);
-        addPass(std::move(pass));
+            config.stringEncryptionAlgorithm);
+        pass->setSeed(config.seed);
+        passes.push_back(std::move(pass));
     }
     
     // LAYER 3: Constant Obfuscation
-    if (config_.enableConstantObfuscation) {
+    if (config.enableConstantObfuscation) {
         auto pass = std::make_unique<ConstantObfuscation>(
-            config_.constantObfuscationComplexity);
-        pass->setSeed(config_.seed);
-        addPass(std::move(pass));
+            config.constantObfuscationComplexity);
+        pass->setSeed(config.seed);
+        passes.push_back(std::move(pass));
     }
     
     // LAYER 4: Quantum-Inspired Opaque Predicates (exponential complexity)
-    if (config_.enableOpaquePredicates) {
+    if (config.enableOpaquePredicates) {
         auto pass = std::make_unique<QuantumOpaquePredicates>(
-            config_.opaquePredicateCount);
-        pass->setSeed(config_.seed);
-        addPass(std::move(pass));
+            config.opaquePredicateCount);
+        pass->setSeed(config.seed);
+        passes.push_back(std::move(pass));
     }
     
     // LAYER 5: Dead Code Injection
-    if (config_.enableDeadCodeInjection) {
+    if (config.enableDeadCodeInjection) {
         auto pass = std::make_unique<DeadCodeInjection>(
-            config_.deadCodeRatio);
-        pass->setSeed(config_.seed);
-        addPass(std::move(pass));
+            config.deadCodeRatio);
+        pass->setSeed(config.seed);
+        passes.push_back(std::move(pass));
     }
     
     // LAYER 6: Grammar-Based Metamorphic Code (structural unpredictability)
-    if (config_.enableInstructionSubstitution) {  // Reuse same config flag
+    if (config.enableInstructionSubstitution) {  // Reuse same config flag
         auto pass = std::make_unique<GrammarMetamorphic>(
-            config_.substitutionProbability / 2);  // Lower rate for grammar transforms
-        pass->setSeed(config_.seed);
-        addPass(std::move(pass));
+            config.substitutionProbability / 2);  // Lower rate for grammar transforms
+        pass->setSeed(config.seed);
+        passes.push_back(std::move(pass));
     }
     
     // LAYER 7: Quantum Control Flow Flattening
-    if (config_.enableControlFlowFlattening) {
+    if (config.enableControlFlowFlattening) {
         auto pass = std::make_unique<ControlFlowFlattening>(
-            config_.flatteningComplexity);
-        pass->setSeed(config_.seed);
-        addPass(std::move(pass));
+            config.flatteningComplexity);
+        pass->setSeed(config.seed);
+        passes.push_back(std::move(pass));
     }
     
     // LAYER 8: Hardware Cache-Based Obfuscation (hardware-locked)
-    if (config_.enableHardwareCacheObfuscation) {
+    if (config.enableHardwareCacheObfuscation) {
         auto pass = std::make_unique<HardwareCacheObfuscation>(
-            config_.cacheObfuscationIntensity);
-        pass->setSeed(config_.seed);
-        addPass(std::move(pass));
+            config.cacheObfuscationIntensity);
+        pass->setSeed(config.seed);
+        passes.push_back(std::move(pass));
     }
     
     // LAYER 9: Call Graph Obfuscation
-    if (config_.enableCallGraphObfuscation) {
+    if (config.enableCallGraphObfuscation) {
         auto pass = std::make_unique<CallGraphObfuscation>();
-        pass->setSeed(config_.seed);
-        addPass(std::move(pass));
+        pass->setSeed(config.seed);
+        passes.push_back(std::move(pass));
     }
     
     // LAYER 10: Anti-Debugging Protections
-    if (config_.enableAntiDebug) {
+    if (config.enableAntiDebug) {
         auto pass = std::make_unique<AntiDebug>();
-        pass->setSeed(config_.seed);
-        addPass(std::move(pass));
+        pass->setSeed(config.seed);
+        passes.push_back(std::move(pass));
     }
     
-    Logger::getInstance().info("Initialized " + std::to_string(passes_.size()) + 
-                               " quantum-enhanced obfuscation passes");
+    for (auto& pass : passes) {
+        if (!policyLevel.empty() && !pass->isFunctionLocal()) {
+            continue;
+        }
+        pass->setHotLoopThreshold(config_.hotLoopThreshold);
+        pass->setPolicyLevel(policyLevel);
+        addPass(std::move(pass));
+    }
 }
 
 } // namespace obfuscator
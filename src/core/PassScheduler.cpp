@@ -0,0 +1,156 @@
+/**
+ * @file PassScheduler.cpp
+ * @brief Implementation of PassScheduler
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "PassScheduler.h"
+#include <cstdint>
+
+namespace obfuscator {
+
+namespace {
+
+std::string describeProperties(uint32_t properties) {
+    static const struct {
+        IRProperty property;
+        const char* name;
+    } names[] = {
+        {IR_INSTRUCTIONS, "instructions"},
+        {IR_ARITHMETIC, "arithmetic"},
+        {IR_CONSTANT_OPERANDS, "constant operands"},
+        {IR_BASIC_BLOCKS, "basic blocks"},
+        {IR_STRUCTURED_CFG, "structured control flow"},
+        {IR_DIRECT_CALLS, "direct calls"},
+        {IR_PLAIN_STRINGS, "plain strings"},
+        {IR_RUNTIME_HELPERS, "runtime helpers"},
+    };
+
+    std::string result;
+    for (const auto& entry : names) {
+        if (properties & entry.property) {
+            result += (result.empty() ? "" : ", ") + std::string(entry.name);
+        }
+    }
+    return result;
+}
+
+} // anonymous namespace
+
+std::vector<size_t> PassScheduler::schedule(const std::vector<const ObfuscationPass*>& passes) {
+    const size_t count = passes.size();
+    decisions_.clear();
+    conflict_ = false;
+
+    std::vector<PassTraits> traits;
+    traits.reserve(count);
+    for (const auto* pass : passes) {
+        traits.push_back(pass->getTraits());
+    }
+
+    // hard[a][b]: a must run before b; soft[a][b]: how much a would rather
+    // run before b (zero if indifferent)
+    std::vector<std::vector<bool>> hard(count, std::vector<bool>(count, false));
+    std::vector<std::vector<uint64_t>> soft(count, std::vector<uint64_t>(count, 0));
+    // Function-local passes of different policy levels never see the same
+    // function, so their order does not matter
+    auto related = [&](size_t a, size_t b) {
+        return a != b && (!passes[a]->isFunctionLocal() || !passes[b]->isFunctionLocal() ||
+                          passes[a]->getPolicyLevel() == passes[b]->getPolicyLevel());
+    };
+    for (size_t a = 0; a < count; ++a) {
+        for (size_t b = 0; b < count; ++b) {
+            if (!related(a, b)) {
+                continue;
+            }
+            uint32_t destroyed = traits[a].required & traits[b].invalidated;
+            if (destroyed) {
+                hard[a][b] = true;
+                decisions_.push_back(passes[a]->getName() + " before " + passes[b]->getName() +
+                                     ": the latter destroys " + describeProperties(destroyed));
+            }
+            uint32_t supplied = traits[b].required & traits[a].produced & ~IR_INPUT_PROPERTIES;
+            if (supplied) {
+                hard[a][b] = true;
+                decisions_.push_back(passes[a]->getName() + " before " + passes[b]->getName() +
+                                     ": the former adds " + describeProperties(supplied));
+            }
+        }
+    }
+    for (size_t a = 0; a < count; ++a) {
+        for (size_t b = 0; b < count; ++b) {
+            if (related(a, b) && !hard[b][a] &&
+                (traits[a].required & traits[b].produced & IR_INPUT_PROPERTIES)) {
+                soft[a][b] = traits[a].growth;
+            }
+        }
+    }
+
+    std::vector<size_t> order;
+    order.reserve(count);
+    std::vector<bool> done(count, false);
+    const ObfuscationPass* previous = nullptr;
+
+    while (order.size() < count) {
+        size_t best = count;
+        uint64_t bestPenalty = 0;
+        bool bestSplits = false;
+
+        for (size_t p = 0; p < count; ++p) {
+            if (done[p]) {
+                continue;
+            }
+            bool ready = true;
+            uint64_t penalty = 0;
+            for (size_t q = 0; q < count; ++q) {
+                if (q == p || done[q]) {
+                    continue;
+                }
+                ready = ready && !hard[q][p];
+                penalty += soft[q][p];
+            }
+            if (!ready) {
+                continue;
+            }
+
+            // A change between module and function-local passes costs a
+            // split and commit in the parallel runner
+            bool splits = previous && previous->isFunctionLocal() != passes[p]->isFunctionLocal();
+            if (best == count || penalty < bestPenalty ||
+                (penalty == bestPenalty && bestSplits && !splits)) {
+                best = p;
+                bestPenalty = penalty;
+                bestSplits = splits;
+            }
+        }
+
+        if (best == count) {
+            // Every remaining pass waits for another: keep registration order
+            for (best = 0; done[best]; ++best) {
+            }
+            conflict_ = true;
+            decisions_.push_back("Conflicting constraints, " + passes[best]->getName() +
+                                 " runs in registration order");
+        }
+
+        for (size_t q = 0; q < count; ++q) {
+            if (!done[q] && q != best && soft[q][best] > 0) {
+                decisions_.push_back(
+                    passes[best]->getName() + " before " + passes[q]->getName() + " although " +
+                    "the latter rewrites the " +
+                    describeProperties(traits[q].required & traits[best].produced &
+                                       IR_INPUT_PROPERTIES) +
+                    " it adds (weight " + std::to_string(soft[q][best]) + ")");
+            }
+        }
+
+        done[best] = true;
+        order.push_back(best);
+        previous = passes[best];
+    }
+
+    return order;
+}
+
+} // namespace obfuscator
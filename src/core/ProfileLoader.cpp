@@ -0,0 +1,38 @@
+/**
+ * @file ProfileLoader.cpp
+ * @brief Implementation of ProfileLoader
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "ProfileLoader.h"
+#include "Logger.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/ProfileData/InstrProfReader.h"
+#include "llvm/ProfileData/SampleProfReader.h"
+#include "llvm/Support/Error.h"
+
+namespace obfuscator {
+
+bool ProfileLoader::getFrontendArgs(const std::string& path, std::vector<std::string>& args) {
+    // clang tells front-end and IR-level instrumentation profiles apart itself
+    auto instrumentation = llvm::IndexedInstrProfReader::create(path);
+    if (instrumentation) {
+        args = {"-fprofile-use=" + path};
+        return true;
+    }
+    llvm::consumeError(instrumentation.takeError());
+
+    llvm::LLVMContext context;
+    if (llvm::sampleprof::SampleProfileReader::create(path, context)) {
+        // Samples are matched by source line; line tables carry no names or types
+        args = {"-fprofile-sample-use=" + path, "-gline-tables-only"};
+        return true;
+    }
+
+    Logger::getInstance().error("Not an llvm-profdata profile (merge .profraw files first): " +
+                                path);
+    return false;
+}
+
+} // namespace obfuscator
@@ -0,0 +1,184 @@
+/**
+ * @file ProjectBuilder.cpp
+ * @brief Implementation of ProjectBuilder
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "ProjectBuilder.h"
+#include "ObfuscationEngine.h"
+#include "ClangFrontend.h"
+#include "MemoryFile.h"
+#include "FileUtils.h"
+#include "Logger.h"
+#include "Tracer.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace obfuscator {
+
+ProjectBuilder::ProjectBuilder(const ObfuscationConfig& config)
+    : config_(config) {
+    reportGenerator_ = std::make_shared<ReportGenerator>(config_);
+}
+
+uint32_t ProjectBuilder::getWorkerCount(size_t unitCount) const {
+    uint32_t jobs = config_.jobs;
+    if (jobs == 0) {
+        jobs = std::max(1u, std::thread::hardware_concurrency());
+    }
+    return static_cast<uint32_t>(std::min<size_t>(jobs, std::max<size_t>(unitCount, 1)));
+}
+
+bool ProjectBuilder::build(const std::vector<std::string>& inputFiles,
+                           const std::string& outputFile) {
+    if (inputFiles.empty()) {
+        Logger::getInstance().error("No input files for project build");
+        return false;
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+
+    std::vector<TranslationUnit> units(inputFiles.size());
+    for (size_t i = 0; i < inputFiles.size(); ++i) {
+        units[i].inputFile = inputFiles[i];
+    }
+
+    uint32_t workerCount = getWorkerCount(units.size());
+    Logger::getInstance().info("Obfuscating " + std::to_string(units.size()) +
+                               " translation units with " +
+                               std::to_string(workerCount) + " workers");
+
+    // Step 1: Obfuscate every unit to an in-memory object
+    auto obfStart = std::chrono::high_resolution_clock::now();
+    std::atomic<size_t> nextUnit(0);
+    std::atomic<bool> failed(false);
+    std::vector<std::thread> workers;
+    workers.reserve(workerCount);
+    for (uint32_t i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&ProjectBuilder::runWorker, this,
+                             std::ref(units), std::ref(nextUnit), std::ref(failed));
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    auto obfEnd = std::chrono::high_resolution_clock::now();
+
+    if (failed) {
+        for (const auto& unit : units) {
+            if (!unit.success) {
+                Logger::getInstance().error("Translation unit not built: " + unit.inputFile);
+            }
+        }
+        return false;
+    }
+
+    // Step 2: Link everything once
+    auto linkStart = std::chrono::high_resolution_clock::now();
+    {
+        TraceSpan span("stage", "link");
+        if (!linkUnits(units, outputFile)) {
+            Logger::getInstance().error("Failed to link project binary");
+            return false;
+        }
+    }
+    auto linkEnd = std::chrono::high_resolution_clock::now();
+
+    // Aggregate per-unit metrics into the project report
+    auto metrics = std::make_shared<MetricsCollector>();
+    uint64_t totalSourceSize = 0;
+    for (const auto& unit : units) {
+        if (unit.metrics) {
+            metrics->merge(*unit.metrics);
+        }
+        totalSourceSize += FileUtils::getFileSize(unit.inputFile);
+    }
+
+    auto& m = metrics->getMetricsMutable();
+    m.obfuscationTime = std::chrono::duration_cast<std::chrono::milliseconds>(obfEnd - obfStart);
+    m.linkingTime = std::chrono::duration_cast<std::chrono::milliseconds>(linkEnd - linkStart);
+    m.totalTime = std::chrono::duration_cast<std::chrono::milliseconds>(linkEnd - startTime);
+    metrics->recordFileSizes(totalSourceSize, FileUtils::getFileSize(outputFile));
+    reportGenerator_->setMetricsCollector(metrics);
+
+    Logger::getInstance().info("Project build completed successfully");
+    return true;
+}
+
+void ProjectBuilder::runWorker(std::vector<TranslationUnit>& units,
+                               std::atomic<size_t>& nextUnit,
+                               std::atomic<bool>& failed) {
+    // Each worker owns an engine, and with it a private LLVMContext
+    ObfuscationEngine engine(config_);
+
+    while (!failed) {
+        size_t index = nextUnit.fetch_add(1);
+        if (index >= units.size()) {
+            break;
+        }
+
+        TranslationUnit& unit = units[index];
+        unit.success = engine.processToObject(unit.inputFile, unit.object);
+        unit.metrics = engine.getReportGenerator()->getMetricsCollector();
+
+        if (!unit.success) {
+            failed = true;
+        }
+    }
+}
+
+bool ProjectBuilder::linkUnits(const std::vector<TranslationUnit>& units,
+                               const std::string& outputFile) {
+    bool isCpp = std::any_of(units.begin(), units.end(), [](const TranslationUnit& unit) {
+        return ClangFrontend::isCppSource(unit.inputFile);
+    });
+
+    LinkerOptions options = Linker::makeOptions(config_, isCpp);
+    options.outputFile = outputFile;
+
+    // Hand objects to the linker through memfds, or through numbered
+    // object files next to the output that are removed afterwards
+    std::vector<std::unique_ptr<MemoryFile>> memoryObjects;
+    std::vector<std::string> diskObjects;
+    bool staged = true;
+
+    for (size_t i = 0; i < units.size() && staged; ++i) {
+        llvm::StringRef data(units[i].object.data(), units[i].object.size());
+
+        if (config_.inMemoryPipeline) {
+            auto file = std::make_unique<MemoryFile>("phantron-obj");
+            staged = file->write(data);
+            options.objectFiles.push_back(file->getPath());
+            memoryObjects.push_back(std::move(file));
+        } else {
+            std::string objectFile = outputFile + "." + std::to_string(i) + ".o";
+            std::error_code ec;
+            llvm::raw_fd_ostream out(objectFile, ec, llvm::sys::fs::OF_None);
+            if (!ec) {
+                out << data;
+                out.close();
+                diskObjects.push_back(objectFile);
+            }
+            staged = !ec && !out.has_error();
+            out.clear_error();
+            options.objectFiles.push_back(objectFile);
+        }
+
+        if (!staged) {
+            Logger::getInstance().error("Failed to stage object for " + units[i].inputFile);
+        }
+    }
+
+    bool linked = staged && linker_.link(options);
+
+    for (const auto& objectFile : diskObjects) {
+        FileUtils::deleteFile(objectFile);
+    }
+
+    return linked;
+}
+
+} // namespace obfuscator
@@ -0,0 +1,224 @@
+/**
+ * @file StagedPipeline.cpp
+ * @brief Implementation of StagedPipeline
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "StagedPipeline.h"
+#include "ObfuscationEngine.h"
+#include "FileUtils.h"
+#include "Logger.h"
+#include <algorithm>
+#include <thread>
+
+namespace obfuscator {
+
+namespace {
+
+// Modules waiting in front of a stage, per worker of that stage
+constexpr size_t QUEUE_SLOTS_PER_WORKER = 2;
+
+std::chrono::milliseconds toMillis(std::chrono::microseconds duration) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(duration);
+}
+
+} // anonymous namespace
+
+StagedPipeline::StagedPipeline(const ObfuscationConfig& config,
+                               const std::vector<uint32_t>& workers)
+    : config_(config), workers_(workers), report_(nullptr), failures_(0) {
+    workers_.resize(STAGE_COUNT, 1);
+    for (auto& count : workers_) {
+        count = std::max(1u, count);
+    }
+
+    // Stages hand modules across engines, which the caches are not built for
+    if (!config_.cacheDirectory.empty()) {
+        Logger::getInstance().warning("Result cache is not used in pipelined batches");
+        config_.cacheDirectory.clear();
+        config_.incremental = false;
+    }
+    if (config_.lowMemory) {
+        Logger::getInstance().warning("Low-memory mode is not used in pipelined batches");
+        config_.lowMemory = false;
+    }
+}
+
+const char* StagedPipeline::getStageName(Stage stage) {
+    switch (stage) {
+        case COMPILE:   return "compile";
+        case OBFUSCATE: return "obfuscate";
+        case CODEGEN:   return "codegen";
+        case LINK:      return "link";
+        default:        return "unknown";
+    }
+}
+
+bool StagedPipeline::run(const std::vector<ManifestEntry>& entries,
+                         const std::function<void(const Result&)>& report) {
+    report_ = &report;
+    failures_ = 0;
+    stats_.assign(STAGE_COUNT, StageStats());
+    for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+        queues_[stage] = std::make_unique<JobQueue>(workers_[stage] * QUEUE_SLOTS_PER_WORKER);
+        runningWorkers_[stage] = workers_[stage];
+        stats_[stage].workers = workers_[stage];
+    }
+
+    Logger::getInstance().info("Pipelining " + std::to_string(entries.size()) +
+                               " entries with " + std::to_string(workers_[COMPILE]) + "/" +
+                               std::to_string(workers_[OBFUSCATE]) + "/" +
+                               std::to_string(workers_[CODEGEN]) + "/" +
+                               std::to_string(workers_[LINK]) +
+                               " compile/obfuscate/codegen/link workers");
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+        for (uint32_t i = 0; i < workers_[stage]; ++i) {
+            threads.emplace_back(&StagedPipeline::runStageWorker, this,
+                                 static_cast<Stage>(stage));
+        }
+    }
+
+    // The first queue is bounded too, so this thread paces the frontend
+    for (size_t i = 0; i < entries.size(); ++i) {
+        auto job = std::make_unique<Job>();
+        job->index = i;
+        job->entry = &entries[i];
+        job->result.index = i;
+        job->startedAt = job->queuedAt = std::chrono::steady_clock::now();
+        queues_[COMPILE]->push(std::move(job));
+    }
+    queues_[COMPILE]->close();
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    auto wall = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - start);
+    for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+        StageStats& stats = stats_[stage];
+        stats.maxQueueDepth = queues_[stage]->getHighWatermark();
+        if (wall.count() > 0) {
+            stats.utilization = static_cast<double>(stats.busy.count()) /
+                                (static_cast<double>(wall.count()) * stats.workers);
+        }
+        Logger::getInstance().info(std::string("Stage ") + getStageName(static_cast<Stage>(stage)) +
+                                   ": " + std::to_string(stats.jobs) + " jobs, " +
+                                   std::to_string(static_cast<int>(stats.utilization * 100)) +
+                                   "% busy, " + std::to_string(toMillis(stats.wait).count()) +
+                                   " ms queued");
+        queues_[stage].reset();
+    }
+
+    report_ = nullptr;
+    return failures_ == 0;
+}
+
+void StagedPipeline::runStageWorker(Stage stage) {
+    ObfuscationEngine engine(config_);
+    JobQueue& input = *queues_[stage];
+
+    std::unique_ptr<Job> job;
+    while (input.pop(job)) {
+        auto begin = std::chrono::steady_clock::now();
+        PerfCounters* counters = config_.perfCounters ? &PerfCounters::forThread() : nullptr;
+        PerfCounterValues countersBefore = counters ? counters->read() : PerfCounterValues();
+        const ManifestEntry& entry = *job->entry;
+
+        bool success = false;
+        switch (stage) {
+            case COMPILE:
+                job->context = std::make_unique<llvm::LLVMContext>();
+                job->context->setDiscardValueNames(config_.discardValueNames);
+                job->module = engine.compileStage(entry.inputFile, *job->context);
+                success = job->module != nullptr;
+                break;
+            case OBFUSCATE:
+                job->result.metrics = engine.obfuscateStage(*job->module);
+                success = job->result.metrics != nullptr;
+                break;
+            case CODEGEN:
+                success = engine.codegenStage(*job->module, job->object);
+                // Only the object travels on to the linker
+                job->module.reset();
+                job->context.reset();
+                break;
+            case LINK:
+                success = engine.linkStage(llvm::StringRef(job->object.data(), job->object.size()),
+                                           entry.outputFile, entry.inputFile);
+                job->object = llvm::SmallVector<char, 0>();
+                break;
+            default:
+                break;
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        if (counters) {
+            job->counters[stage] = counters->read() - countersBefore;
+        }
+        auto waited = std::chrono::duration_cast<std::chrono::microseconds>(begin - job->queuedAt);
+        auto ran = std::chrono::duration_cast<std::chrono::microseconds>(end - begin);
+        job->result.wait[stage] = waited;
+        job->result.run[stage] = ran;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stats_[stage].jobs++;
+            stats_[stage].busy += ran;
+            stats_[stage].wait += waited;
+        }
+
+        if (!success) {
+            job->result.failedStage = getStageName(stage);
+            finish(std::move(job));
+        } else if (stage == LINK) {
+            job->result.success = true;
+            finish(std::move(job));
+        } else {
+            job->queuedAt = end;
+            queues_[stage + 1]->push(std::move(job));
+        }
+    }
+
+    // The last worker of a stage ends the next one
+    if (--runningWorkers_[stage] == 0 && stage + 1 < STAGE_COUNT) {
+        queues_[stage + 1]->close();
+    }
+}
+
+void StagedPipeline::finish(std::unique_ptr<Job> job) {
+    Result& result = job->result;
+    if (!result.metrics) {
+        result.metrics = std::make_shared<MetricsCollector>();
+    }
+
+    auto& m = result.metrics->getMetricsMutable();
+    m.compilationTime = toMillis(result.run[COMPILE]);
+    m.obfuscationTime = toMillis(result.run[OBFUSCATE]);
+    m.linkingTime = toMillis(result.run[LINK]);
+    m.totalTime = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - job->startedAt);
+    if (config_.perfCounters) {
+        for (int stage = 0; stage < STAGE_COUNT; ++stage) {
+            if (job->counters[stage].available) {
+                result.metrics->recordStageCounters(getStageName(static_cast<Stage>(stage)),
+                                                    job->counters[stage]);
+            }
+        }
+    }
+    if (result.success) {
+        result.metrics->recordFileSizes(FileUtils::getFileSize(job->entry->inputFile),
+                                        FileUtils::getFileSize(job->entry->outputFile));
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!result.success) {
+        failures_++;
+    }
+    (*report_)(result);
+}
+
+} // namespace obfuscator
@@ -6,11 +6,18 @@
  */
 
 #include "ObfuscationEngine.h"
+#include "ProjectBuilder.h"
+#include "ManifestRunner.h"
+#include "ObfuscationServer.h"
+#include "ObfuscationClient.h"
 #include "CLIParser.h"
 #include "AutoTuner.h"
 #include "Logger.h"
+#include "Tracer.h"
 #include <iostream>
 #include <exception>
+#include <fstream>
+#include <csignal>
 
 using namespace obfuscator;
 
@@ -37,6 +44,52 @@ int main(int argc, char* argv[]) {
         
         // Get configuration
         const auto& config = parser.getConfig();
+        
+        // Daemon mode: serve jobs until SIGINT/SIGTERM
+        if (parser.isServeMode()) {
+            Logger::getInstance().setVerbose(config.verbose);
+            std::signal(SIGINT, [](int) { ObfuscationServer::requestStop(); });
+            std::signal(SIGTERM, [](int) { ObfuscationServer::requestStop(); });
+            
+            ObfuscationServer server(config);
+            return server.run(parser.getServeSocket()) ? 0 : 1;
+        }
+        
+        // Client mode: same command line, run by the daemon
+        if (parser.isClientMode()) {
+            ObfuscationClient client(parser.getConnectSocket());
+            if (parser.isServerStatusQuery()) {
+                return client.printStatus();
+            }
+            return client.obfuscate(ObfuscationClient::forwardedArguments(argc, argv), config,
+                                    parser.getInputFile(), parser.getOutputFile(),
+                                    parser.shouldSendInput());
+        }
+        
+        // Spans of everything below go to the trace file when main returns
+        std::unique_ptr<TraceSession> trace;
+        if (!config.traceFile.empty()) {
+            trace = std::make_unique<TraceSession>(config.traceFile, config.traceFunctions);
+        }
+        
+        // Batch mode: many independent programs, results as JSON lines
+        if (parser.isManifestMode()) {
+            // Results may go to stdout, so log lines must not
+            Logger::getInstance().setVerbose(config.verbose);
+            Logger::getInstance().setUseStderr(true);
+            ManifestRunner runner(config);
+            
+            if (parser.getResultsFile().empty()) {
+                return runner.run(parser.getManifestFile(), std::cout) ? 0 : 1;
+            }
+            std::ofstream results(parser.getResultsFile());
+            if (!results) {
+                std::cerr << "Cannot write results to " << parser.getResultsFile() << "\n";
+                return 1;
+            }
+            return runner.run(parser.getManifestFile(), results) ? 0 : 1;
+        }
+        
         const auto& inputFile = parser.getInputFile();
         const auto& outputFile = parser.getOutputFile();
         
@@ -90,17 +143,29 @@ int main(int argc, char* argv[]) {
             std::string(config.level == ObfuscationLevel::LOW ? "LOW" :
                        config.level == ObfuscationLevel::MEDIUM ? "MEDIUM" : "HIGH"));
         
-        // Create obfuscation engine
-        ObfuscationEngine engine(config);
+        std::shared_ptr<ReportGenerator> reportGen;
         
-        // Process file
-        if (!engine.processFile(inputFile, outputFile)) {
-            Logger::getInstance().error("Obfuscation failed");
-            return 1;
+        if (parser.isProjectMode()) {
+            // Multi-file project: obfuscate units in parallel, link once
+            ProjectBuilder builder(config);
+            if (!builder.build(parser.getInputFiles(), outputFile)) {
+                Logger::getInstance().error("Obfuscation failed");
+                return 1;
+            }
+            reportGen = builder.getReportGenerator();
+        } else {
+            // Create obfuscation engine
+            ObfuscationEngine engine(config);
+            
+            // Process file
+            if (!engine.processFile(inputFile, outputFile)) {
+                Logger::getInstance().error("Obfuscation failed");
+                return 1;
+            }
+            reportGen = engine.getReportGenerator();
         }
         
         // Generate report
-        auto reportGen = engine.getReportGenerator();
         if (config.generateMetrics) {
             std::string reportPath = config.reportPath;
             if (reportGen->generateReport(reportPath)) {
@@ -16,6 +16,13 @@ AntiDebug::AntiDebug()
     : ObfuscationPass("AntiDebug", true) {
 }
 
+PassTraits AntiDebug::getTraits() const {
+    // The checks are single-block helpers no other pass rewrites
+    PassTraits traits;
+    traits.produced = IR_RUNTIME_HELPERS;
+    return traits;
+}
+
 bool AntiDebug::runOnModule(llvm::Module& module, MetricsCollector& metrics) {
     uint32_t checks = insertAntiDebugChecks(module);
     
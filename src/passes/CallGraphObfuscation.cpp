@@ -7,7 +7,7 @@
 
 #include "passes/CallGraphObfuscation.h"
 #include "MetricsCollector.h"
-#include "RandomGenerator.h"
+#include "RandomStream.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/IRBuilder.h"
 
@@ -17,6 +17,14 @@ CallGraphObfuscation::CallGraphObfuscation()
     : ObfuscationPass("CallGraphObfuscation", true) {
 }
 
+PassTraits CallGraphObfuscation::getTraits() const {
+    PassTraits traits;
+    traits.required = IR_DIRECT_CALLS;
+    traits.produced = IR_INSTRUCTIONS;
+    traits.growth = 10;
+    return traits;
+}
+
 bool CallGraphObfuscation::runOnModule(llvm::Module& module, MetricsCollector& metrics) {
     uint32_t transformations = obfuscateCalls(module);
     
@@ -28,12 +36,11 @@ bool CallGraphObfuscation::runOnModule(llvm::Module& module, MetricsCollector& m
 
 uint32_t CallGraphObfuscation::obfuscateCalls(llvm::Module& module) {
     uint32_t count = 0;
-    auto& rng = RandomGenerator::getInstance();
-    
-    // Collect direct function calls
-    std::vector<llvm::CallInst*> calls;
     
     for (auto& func : module) {
+        // Collect direct function calls made by this function
+        std::vector<llvm::CallInst*> calls;
+        
         for (auto& bb : func) {
             for (auto& inst : bb) {
                 if (auto* call = llvm::dyn_cast<llvm::CallInst>(&inst)) {
@@ -43,25 +50,26 @@ uint32_t CallGraphObfuscation::obfuscateCalls(llvm::Module& module) {
                 }
             }
         }
-    }
-    
-    // Transform some calls to indirect calls through function pointers
-    for (auto* call : calls) {
-        if (rng.getBool(30)) {  // 30% probability
-            llvm::Function* calledFunc = call->getCalledFunction();
-            
-            llvm::IRBuilder<> builder(call);
-            
-            // Create function pointer
-            llvm::Value* funcPtr = builder.CreateBitCast(
-                calledFunc,
-                calledFunc->getType()
-            );
-            
-            // Create indirect call (simplified - doesn't modify actual call)
-            // Full implementation would replace direct call with indirect
-            
-            count++;
+        
+        // Transform some calls to indirect calls through function pointers
+        RandomStream rng = getRandomStream(func);
+        for (auto* call : calls) {
+            if (rng.getBool(30)) {  // 30% probability
+                llvm::Function* calledFunc = call->getCalledFunction();
+                
+                llvm::IRBuilder<> builder(call);
+                
+                // Create function pointer
+                llvm::Value* funcPtr = builder.CreateBitCast(
+                    calledFunc,
+                    calledFunc->getType()
+                );
+                
+                // Create indirect call (simplified - doesn't modify actual call)
+                // Full implementation would replace direct call with indirect
+                
+                count++;
+            }
         }
     }
     
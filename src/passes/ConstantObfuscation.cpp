@@ -7,49 +7,39 @@
 
 #include "passes/ConstantObfuscation.h"
 #include "MetricsCollector.h"
-#include "RandomGenerator.h"
+#include "RandomStream.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Constants.h"
 
 namespace obfuscator {
 
 ConstantObfuscation::ConstantObfuscation(uint32_t complexity)
-    : ObfuscationPass("ConstantObfuscation", true), complexity_(complexity) {
+    : FunctionObfuscationPass("ConstantObfuscation", true), complexity_(complexity) {
 }
 
-bool ConstantObfuscation::runOnModule(llvm::Module& module, MetricsCollector& metrics) {
-    bool modified = false;
-    uint32_t totalObfuscated = 0;
-    
-    for (auto& func : module) {
-        // Skip if already processed
-        if (func.getMetadata("obfuscated.ConstantObfuscation")) {
-            continue;
-        }
-        
-        if (shouldObfuscateFunction(func)) {
-            uint32_t obfuscated = obfuscateConstants(func);
-            totalObfuscated += obfuscated;
-            if (obfuscated > 0) {
-                // Mark function as obfuscated
-                llvm::LLVMContext& ctx = func.getContext();
-                llvm::MDNode* node = llvm::MDNode::get(ctx, 
-                    llvm::MDString::get(ctx, "ConstantObfuscation"));
-                func.setMetadata("obfuscated.ConstantObfuscation", node);
-                modified = true;
-            }
-        }
-    }
-    
-    metrics.incrementTransformations(name_, totalObfuscated);
-    metrics.getMetricsMutable().constantsObfuscated += totalObfuscated;
-    
-    return modified;
+PassTraits ConstantObfuscation::getTraits() const {
+    PassTraits traits;
+    traits.required = IR_CONSTANT_OPERANDS;
+    traits.invalidated = IR_CONSTANT_OPERANDS;
+    traits.produced = IR_INSTRUCTIONS | IR_ARITHMETIC;
+    traits.growth = complexity_;
+    return traits;
+}
+
+uint32_t ConstantObfuscation::runOnFunction(llvm::Function& func,
+                                            llvm::FunctionAnalysisManager& analyses) {
+    return obfuscateConstants(func, getHotness(func, analyses));
+}
+
+void ConstantObfuscation::recordTransformations(MetricsCollector& metrics, uint32_t count) const {
+    metrics.incrementTransformations(name_, count);
+    metrics.getMetricsMutable().constantsObfuscated += count;
 }
 
-uint32_t ConstantObfuscation::obfuscateConstants(llvm::Function& func) {
+uint32_t ConstantObfuscation::obfuscateConstants(llvm::Function& func,
+                                                 const BlockHotness& hotness) {
     uint32_t count = 0;
-    auto& rng = RandomGenerator::getInstance();
+    RandomStream rng = getRandomStream(func);
     
     std::vector<std::pair<llvm::Instruction*, llvm::ConstantInt*>> constantUsers;
     
@@ -61,7 +51,7 @@ uint32_t ConstantObfuscation::obfuscateConstants(llvm::Function& func) {
                     if (constInt->getBitWidth() == 32 || constInt->getBitWidth() == 64) {
                         int64_t value = constInt->getSExtValue();
                         // Skip small constants and special values
-                        if (value > 10 && value < 1000000 && rng.getBool(complexity_)) {
+                        if (value > 10 && value < 1000000 && rng.getBool(hotness.scale(complexity_, &bb))) {
                             constantUsers.push_back({&inst, constInt});
                         }
                     }
@@ -7,50 +7,58 @@
 
 #include "passes/ControlFlowFlattening.h"
 #include "MetricsCollector.h"
-#include "RandomGenerator.h"
 #include "Logger.h"
 #include "llvm/IR/Function.h"
 #include "llvm/IR/BasicBlock.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Constants.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Transforms/Utils/Local.h"
 #include <vector>
 
 namespace obfuscator {
 
+namespace {
+
+// Functions with more blocks get one dispatcher per region of 2^REGION_BITS
+// blocks; 64-block regions compiled fastest with llc at 10k and 50k blocks
+constexpr size_t MAX_FLAT_DISPATCH = 256;
+constexpr unsigned REGION_BITS = 6;
+
+} // anonymous namespace
+
 ControlFlowFlattening::ControlFlowFlattening(uint32_t complexity)
-    : ObfuscationPass("ControlFlowFlattening", true), complexity_(complexity) {
+    : FunctionObfuscationPass("ControlFlowFlattening", true), complexity_(complexity) {
 }
 
-bool ControlFlowFlattening::runOnModule(llvm::Module& module, MetricsCollector& metrics) {
-    bool modified = false;
-    uint32_t transformationCount = 0;
-    
-    for (auto& func : module) {
-        // Skip if already flattened
-        if (func.getMetadata("obfuscated.ControlFlowFlattening")) {
-            continue;
-        }
-        
-        if (shouldObfuscateFunction(func) && canFlatten(func)) {
-            if (flattenFunction(func)) {
-                // Mark function as flattened
-                llvm::LLVMContext& ctx = func.getContext();
-                llvm::MDNode* node = llvm::MDNode::get(ctx, 
-                    llvm::MDString::get(ctx, "ControlFlowFlattening"));
-                func.setMetadata("obfuscated.ControlFlowFlattening", node);
-                
-                modified = true;
-                transformationCount++;
-            }
-        }
+PassTraits ControlFlowFlattening::getTraits() const {
+    // Every block gets a state store and a branch back to the dispatcher;
+    // the state values are plain constants
+    PassTraits traits;
+    traits.required = IR_BASIC_BLOCKS | IR_STRUCTURED_CFG;
+    traits.invalidated = IR_STRUCTURED_CFG;
+    traits.produced = IR_INSTRUCTIONS | IR_BASIC_BLOCKS | IR_CONSTANT_OPERANDS;
+    traits.growth = 100;
+    return traits;
+}
+
+uint32_t ControlFlowFlattening::runOnFunction(llvm::Function& func,
+                                              llvm::FunctionAnalysisManager& analyses) {
+    if (!canFlatten(func)) {
+        return 0;
     }
-    
-    metrics.incrementTransformations(name_, transformationCount);
-    metrics.getMetricsMutable().controlFlowTransformations += transformationCount;
-    
-    return modified;
+    // Flattening routes every edge through the dispatcher, hot loops included
+    if (getHotness(func, analyses).getFunctionIntensity() < 50) {
+        return 0;
+    }
+    return flattenFunction(func) ? 1 : 0;
+}
+
+void ControlFlowFlattening::recordTransformations(MetricsCollector& metrics, uint32_t count) const {
+    metrics.incrementTransformations(name_, count);
+    metrics.getMetricsMutable().controlFlowTransformations += count;
 }
 
 bool ControlFlowFlattening::canFlatten(llvm::Function& func) const {
@@ -59,119 +67,153 @@ bool ControlFlowFlattening::canFlatten(llvm::Function& func) const {
         return false;
     }
     
-    // Don't flatten if too complex (too many blocks)
-    if (func.size() > 100) {
-        return false;
+    // Exception handling and computed jumps cannot be routed through a switch
+    for (auto& bb : func) {
+        llvm::Instruction* terminator = bb.getTerminator();
+        if (bb.isEHPad() || !terminator || llvm::isa<llvm::IndirectBrInst>(terminator) ||
+            llvm::isa<llvm::CallBrInst>(terminator) || llvm::isa<llvm::InvokeInst>(terminator)) {
+            return false;
+        }
     }
     
     return true;
 }
 
+void ControlFlowFlattening::demoteToStack(llvm::Function& func) {
+    llvm::BasicBlock& entryBlock = func.getEntryBlock();
+    
+    // Values of the entry block still dominate their uses afterwards
+    std::vector<llvm::PHINode*> phis;
+    std::vector<llvm::Instruction*> values;
+    for (auto& bb : func) {
+        for (auto& inst : bb) {
+            if (auto* phi = llvm::dyn_cast<llvm::PHINode>(&inst)) {
+                phis.push_back(phi);
+            } else if (&bb != &entryBlock && inst.isUsedOutsideOfBlock(&bb)) {
+                values.push_back(&inst);
+            }
+        }
+    }
+    
+    llvm::Instruction* allocaPoint = &*entryBlock.getFirstInsertionPt();
+    for (auto* phi : phis) {
+        llvm::DemotePHIToStack(phi, allocaPoint);
+    }
+    for (auto* value : values) {
+        llvm::DemoteRegToStack(*value, false, allocaPoint);
+    }
+}
+
 bool ControlFlowFlattening::flattenFunction(llvm::Function& func) {
     Logger::getInstance().debug("Flattening function: " + func.getName().str());
     
-    // Get entry block
+    // The entry block keeps the allocas and only jumps to the first state,
+    // so a branching entry terminator moves into a block of its own
     llvm::BasicBlock& entryBlock = func.getEntryBlock();
+    llvm::Instruction* entryTerm = entryBlock.getTerminator();
+    if (!llvm::isa<llvm::BranchInst>(entryTerm) && !llvm::isa<llvm::SwitchInst>(entryTerm)) {
+        return false;
+    }
+    if (entryTerm->getNumSuccessors() > 1) {
+        entryBlock.splitBasicBlock(entryTerm, "flatten.first");
+    }
+    llvm::BasicBlock* firstBlock = entryBlock.getTerminator()->getSuccessor(0);
+    
+    demoteToStack(func);
     
-    // Collect all basic blocks except entry
+    // Collect all basic blocks except entry; a block's state is its index
     std::vector<llvm::BasicBlock*> originalBlocks;
+    llvm::DenseMap<llvm::BasicBlock*, uint32_t> states;
     for (auto& bb : func) {
         if (&bb != &entryBlock) {
+            states[&bb] = static_cast<uint32_t>(originalBlocks.size());
             originalBlocks.push_back(&bb);
         }
     }
     
-    if (originalBlocks.empty()) {
-        return false;
-    }
+    // Large functions get a dispatcher per region of consecutive blocks
+    // below the top one, which keeps the switches small enough for codegen,
+    // and branches within a region skip the top level
+    const size_t blockCount = originalBlocks.size();
+    const unsigned regionBits = blockCount > MAX_FLAT_DISPATCH ? REGION_BITS : 0;
+    const size_t regionCount = regionBits ? ((blockCount - 1) >> regionBits) + 1 : 1;
     
-    // Create switch variable
+    llvm::LLVMContext& ctx = func.getContext();
     llvm::IRBuilder<> builder(&entryBlock, entryBlock.begin());
     llvm::AllocaInst* switchVar = builder.CreateAlloca(
         builder.getInt32Ty(), nullptr, "switch.var");
     
-    // Initialize switch variable with first block index
-    builder.CreateStore(builder.getInt32(1), switchVar);
-    
     // Create dispatch block with switch statement
-    llvm::BasicBlock* dispatchBlock = llvm::BasicBlock::Create(
-        func.getContext(), "dispatch", &func);
+    llvm::BasicBlock* dispatchBlock = llvm::BasicBlock::Create(ctx, "dispatch", &func);
     
     // Create default block
-    llvm::BasicBlock* defaultBlock = llvm::BasicBlock::Create(
-        func.getContext(), "default", &func);
+    llvm::BasicBlock* defaultBlock = llvm::BasicBlock::Create(ctx, "default", &func);
     llvm::IRBuilder<> defaultBuilder(defaultBlock);
     defaultBuilder.CreateUnreachable();
     
-    // Build switch instruction
     llvm::IRBuilder<> dispatchBuilder(dispatchBlock);
     llvm::LoadInst* switchValue = dispatchBuilder.CreateLoad(
         builder.getInt32Ty(), switchVar, "switch.val");
-    llvm::SwitchInst* switchInst = dispatchBuilder.CreateSwitch(
-        switchValue, defaultBlock, originalBlocks.size());
     
-    // Assign case numbers to blocks and update terminators
-    for (size_t i = 0; i < originalBlocks.size(); ++i) {
-        llvm::BasicBlock* bb = originalBlocks[i];
-        uint32_t caseNum = i + 1;
-        
-        // Add case to switch
-        switchInst->addCase(builder.getInt32(caseNum), bb);
+    std::vector<llvm::BasicBlock*> regionDispatch(regionCount, dispatchBlock);
+    std::vector<llvm::SwitchInst*> regionSwitch(regionCount);
+    if (regionCount == 1) {
+        regionSwitch[0] = dispatchBuilder.CreateSwitch(switchValue, defaultBlock, blockCount);
+    } else {
+        llvm::SwitchInst* topSwitch = dispatchBuilder.CreateSwitch(
+            dispatchBuilder.CreateLShr(switchValue, regionBits, "switch.region"),
+            defaultBlock, regionCount);
+        for (size_t r = 0; r < regionCount; ++r) {
+            regionDispatch[r] = llvm::BasicBlock::Create(ctx, "dispatch.region", &func);
+            topSwitch->addCase(builder.getInt32(r), regionDispatch[r]);
+            llvm::IRBuilder<> regionBuilder(regionDispatch[r]);
+            llvm::LoadInst* regionValue = regionBuilder.CreateLoad(
+                builder.getInt32Ty(), switchVar, "switch.val");
+            regionSwitch[r] = regionBuilder.CreateSwitch(regionValue, defaultBlock,
+                                                         size_t(1) << regionBits);
+        }
+    }
+    
+    auto regionOf = [&](uint32_t state) -> size_t {
+        return regionCount == 1 ? 0 : state >> regionBits;
+    };
+    
+    // Add a case per block and route its branches through the dispatchers
+    for (llvm::BasicBlock* bb : originalBlocks) {
+        uint32_t state = states[bb];
+        regionSwitch[regionOf(state)]->addCase(builder.getInt32(state), bb);
         
-        // Update terminator to go back to dispatch
-        llvm::Instruction* terminator = bb->getTerminator();
-        if (!terminator) continue;
+        // Switches, returns and unreachable stay as they are
+        auto* br = llvm::dyn_cast<llvm::BranchInst>(bb->getTerminator());
+        if (!br) {
+            continue;
+        }
         
-        if (auto* br = llvm::dyn_cast<llvm::BranchInst>(terminator)) {
-            llvm::IRBuilder<> bbBuilder(bb);
-            bbBuilder.SetInsertPoint(terminator);
-            
-            if (br->isUnconditional()) {
-                // Find destination block index
-                llvm::BasicBlock* dest = br->getSuccessor(0);
-                auto it = std::find(originalBlocks.begin(), originalBlocks.end(), dest);
-                if (it != originalBlocks.end()) {
-                    uint32_t destCase = std::distance(originalBlocks.begin(), it) + 1;
-                    bbBuilder.CreateStore(builder.getInt32(destCase), switchVar);
-                }
-                bbBuilder.CreateBr(dispatchBlock);
-                terminator->eraseFromParent();
-            } else {
-                // Conditional branch - keep condition but update destinations
-                llvm::Value* cond = br->getCondition();
-                llvm::BasicBlock* trueDest = br->getSuccessor(0);
-                llvm::BasicBlock* falseDest = br->getSuccessor(1);
-                
-                auto trueIt = std::find(originalBlocks.begin(), originalBlocks.end(), trueDest);
-                auto falseIt = std::find(originalBlocks.begin(), originalBlocks.end(), falseDest);
-                
-                if (trueIt != originalBlocks.end() && falseIt != originalBlocks.end()) {
-                    uint32_t trueCase = std::distance(originalBlocks.begin(), trueIt) + 1;
-                    uint32_t falseCase = std::distance(originalBlocks.begin(), falseIt) + 1;
-                    
-                    llvm::Value* selectedCase = bbBuilder.CreateSelect(
-                        cond, builder.getInt32(trueCase), builder.getInt32(falseCase));
-                    bbBuilder.CreateStore(selectedCase, switchVar);
-                }
-                bbBuilder.CreateBr(dispatchBlock);
-                terminator->eraseFromParent();
-            }
-        } else if (llvm::isa<llvm::ReturnInst>(terminator)) {
-            // Leave return instructions as is
+        llvm::IRBuilder<> bbBuilder(br);
+        llvm::Value* nextState;
+        bool local;
+        if (br->isUnconditional()) {
+            uint32_t dest = states[br->getSuccessor(0)];
+            nextState = builder.getInt32(dest);
+            local = regionOf(dest) == regionOf(state);
+        } else {
+            uint32_t trueDest = states[br->getSuccessor(0)];
+            uint32_t falseDest = states[br->getSuccessor(1)];
+            nextState = bbBuilder.CreateSelect(br->getCondition(), builder.getInt32(trueDest),
+                                               builder.getInt32(falseDest));
+            local = regionOf(trueDest) == regionOf(state) &&
+                    regionOf(falseDest) == regionOf(state);
         }
+        bbBuilder.CreateStore(nextState, switchVar);
+        bbBuilder.CreateBr(local ? regionDispatch[regionOf(state)] : dispatchBlock);
+        br->eraseFromParent();
     }
     
-    // Update entry block to jump to dispatch
-    llvm::Instruction* entryTerm = entryBlock.getTerminator();
-    if (entryTerm) {
-        llvm::IRBuilder<> entryBuilder(&entryBlock);
-        entryBuilder.SetInsertPoint(entryTerm);
-        entryBuilder.CreateBr(dispatchBlock);
-        entryTerm->eraseFromParent();
-    } else {
-        builder.SetInsertPoint(&entryBlock, entryBlock.end());
-        builder.CreateBr(dispatchBlock);
-    }
+    // Start at the entry block's successor
+    builder.SetInsertPoint(entryBlock.getTerminator());
+    builder.CreateStore(builder.getInt32(states[firstBlock]), switchVar);
+    builder.CreateBr(dispatchBlock);
+    entryBlock.getTerminator()->eraseFromParent();
     
     return true;
 }
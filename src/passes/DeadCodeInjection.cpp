@@ -7,55 +7,44 @@
 
 #include "passes/DeadCodeInjection.h"
 #include "MetricsCollector.h"
-#include "RandomGenerator.h"
+#include "RandomStream.h"
 #include "llvm/IR/IRBuilder.h"
 
 namespace obfuscator {
 
 DeadCodeInjection::DeadCodeInjection(uint32_t ratio)
-    : ObfuscationPass("DeadCodeInjection", true), ratio_(ratio) {
+    : FunctionObfuscationPass("DeadCodeInjection", true), ratio_(ratio) {
 }
 
-bool DeadCodeInjection::runOnModule(llvm::Module& module, MetricsCollector& metrics) {
-    bool modified = false;
-    uint32_t totalDeadInstructions = 0;
-    
-    for (auto& func : module) {
-        // Skip if already processed
-        if (func.getMetadata("obfuscated.DeadCodeInjection")) {
-            continue;
-        }
-        
-        if (shouldObfuscateFunction(func)) {
-            uint32_t injected = injectDeadCode(func);
-            totalDeadInstructions += injected;
-            if (injected > 0) {
-                // Mark function as obfuscated
-                llvm::LLVMContext& ctx = func.getContext();
-                llvm::MDNode* node = llvm::MDNode::get(ctx, 
-                    llvm::MDString::get(ctx, "DeadCodeInjection"));
-                func.setMetadata("obfuscated.DeadCodeInjection", node);
-                modified = true;
-            }
-        }
-    }
-    
-    metrics.incrementTransformations(name_, totalDeadInstructions);
-    metrics.getMetricsMutable().deadCodeInstructionsAdded += totalDeadInstructions;
-    
-    return modified;
+PassTraits DeadCodeInjection::getTraits() const {
+    // Any instruction is an insertion point for about two dead ones
+    PassTraits traits;
+    traits.required = IR_INSTRUCTIONS;
+    traits.produced = IR_INSTRUCTIONS | IR_ARITHMETIC;
+    traits.growth = ratio_ * 2;
+    return traits;
+}
+
+uint32_t DeadCodeInjection::runOnFunction(llvm::Function& func,
+                                          llvm::FunctionAnalysisManager& analyses) {
+    return injectDeadCode(func, getHotness(func, analyses));
+}
+
+void DeadCodeInjection::recordTransformations(MetricsCollector& metrics, uint32_t count) const {
+    metrics.incrementTransformations(name_, count);
+    metrics.getMetricsMutable().deadCodeInstructionsAdded += count;
 }
 
-uint32_t DeadCodeInjection::injectDeadCode(llvm::Function& func) {
+uint32_t DeadCodeInjection::injectDeadCode(llvm::Function& func, const BlockHotness& hotness) {
     uint32_t count = 0;
-    auto& rng = RandomGenerator::getInstance();
+    RandomStream rng = getRandomStream(func);
     
     std::vector<llvm::Instruction*> insertPoints;
     
     for (auto& bb : func) {
         for (auto& inst : bb) {
             if (!inst.isTerminator()) {
-                if (rng.getBool(ratio_)) {
+                if (rng.getBool(hotness.scale(ratio_, &bb))) {
                     insertPoints.push_back(&inst);
                 }
             }
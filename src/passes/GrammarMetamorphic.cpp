@@ -7,53 +7,40 @@
 
 #include "passes/GrammarMetamorphic.h"
 #include "MetricsCollector.h"
-#include "RandomGenerator.h"
+#include "RandomStream.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Instructions.h"
 
 namespace obfuscator {
 
 GrammarMetamorphic::GrammarMetamorphic(uint32_t transformationRate)
-    : ObfuscationPass("GrammarMetamorphic", true), transformationRate_(transformationRate) {
+    : FunctionObfuscationPass("GrammarMetamorphic", true), transformationRate_(transformationRate) {
 }
 
-bool GrammarMetamorphic::runOnModule(llvm::Module& module, MetricsCollector& metrics) {
-    bool modified = false;
-    uint32_t totalTransformations = 0;
-    
-    for (auto& func : module) {
-        if (func.getMetadata("obfuscated.GrammarMetamorphic")) {
-            continue;
-        }
-        
-        if (shouldObfuscateFunction(func)) {
-            uint32_t transformed = transformFunction(func);
-            totalTransformations += transformed;
-            if (transformed > 0) {
-                llvm::LLVMContext& ctx = func.getContext();
-                llvm::MDNode* node = llvm::MDNode::get(ctx,
-                    llvm::MDString::get(ctx, "GrammarMetamorphic"));
-                func.setMetadata("obfuscated.GrammarMetamorphic", node);
-                modified = true;
-            }
-        }
-    }
-    
-    metrics.incrementTransformations(name_, totalTransformations);
-    
-    return modified;
+PassTraits GrammarMetamorphic::getTraits() const {
+    PassTraits traits;
+    traits.required = IR_ARITHMETIC | IR_BASIC_BLOCKS;
+    traits.produced = IR_INSTRUCTIONS | IR_ARITHMETIC;
+    traits.growth = transformationRate_;
+    return traits;
+}
+
+uint32_t GrammarMetamorphic::runOnFunction(llvm::Function& func,
+                                           llvm::FunctionAnalysisManager& analyses) {
+    return transformFunction(func, getHotness(func, analyses));
 }
 
-uint32_t GrammarMetamorphic::transformFunction(llvm::Function& func) {
+uint32_t GrammarMetamorphic::transformFunction(llvm::Function& func,
+                                               const BlockHotness& hotness) {
     uint32_t transformed = 0;
-    auto& rng = RandomGenerator::getInstance();
+    RandomStream rng = getRandomStream(func);
     
     std::vector<llvm::Instruction*> candidates;
     
     // Collect candidate instructions for grammar transformations
     for (auto& bb : func) {
         for (auto& inst : bb) {
-            if (rng.getUInt32(0, 99) < transformationRate_) {
+            if (rng.getUInt32(0, 99) < hotness.scale(transformationRate_, &bb)) {
                 // Binary operations
                 if (auto* binOp = llvm::dyn_cast<llvm::BinaryOperator>(&inst)) {
                     if (binOp->getType()->isIntegerTy()) {
@@ -7,7 +7,6 @@
 
 #include "passes/HardwareCacheObfuscation.h"
 #include "MetricsCollector.h"
-#include "RandomGenerator.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/InlineAsm.h"
 #include "llvm/IR/Constants.h"
@@ -18,6 +17,20 @@ HardwareCacheObfuscation::HardwareCacheObfuscation(uint32_t intensity)
     : ObfuscationPass("HardwareCacheObfuscation", true), intensity_(intensity) {
 }
 
+PassTraits HardwareCacheObfuscation::getTraits() const {
+    // Rewrites binary operators with a constant operand, at most
+    // intensity / 10 per function, behind a call to the key generator
+    PassTraits traits;
+    if (intensity_ < 20) {
+        return traits;
+    }
+    traits.required = IR_ARITHMETIC | IR_CONSTANT_OPERANDS;
+    traits.produced = IR_RUNTIME_HELPERS | IR_INSTRUCTIONS | IR_ARITHMETIC |
+                      IR_BASIC_BLOCKS | IR_DIRECT_CALLS;
+    traits.growth = intensity_ / 2;
+    return traits;
+}
+
 bool HardwareCacheObfuscation::runOnModule(llvm::Module& module, MetricsCollector& metrics) {
     // Skip if intensity is too low
     if (intensity_ < 20) {
@@ -42,12 +55,18 @@ bool HardwareCacheObfuscation::runOnModule(llvm::Module& module, MetricsCollecto
 llvm::Function* HardwareCacheObfuscation::createCacheKeyGenerator(llvm::Module& module) {
     llvm::LLVMContext& ctx = module.getContext();
     
-    // Create function: i64 obf.cache.key()
+    // Create function: i64 obf.cache.key(), one per cycle. The name must
+    // not depend on what else the module holds: cached function bodies
+    // refer to it by name (see FunctionCache)
+    std::string name = "obf.cache.key";
+    if (cycle_ > 0) {
+        name += "." + std::to_string(cycle_);
+    }
     llvm::FunctionType* funcType = llvm::FunctionType::get(
         llvm::Type::getInt64Ty(ctx), false);
     llvm::Function* func = llvm::Function::Create(
         funcType, llvm::GlobalValue::InternalLinkage,
-        "obf.cache.key", module);
+        name, module);
     
     llvm::BasicBlock* entry = llvm::BasicBlock::Create(ctx, "entry", func);
     llvm::IRBuilder<> builder(entry);
@@ -167,13 +186,14 @@ uint32_t HardwareCacheObfuscation::applyCacheBasedXOR(llvm::Module& module, llvm
         llvm::IRBuilder<> entryBuilder(entryBB, entryBB->getFirstInsertionPt());
         llvm::Value* cacheKey = entryBuilder.CreateCall(cacheKeyFunc);
         
-        // Collect binary operations with constants in this function
+        // Collect binary operations with constants in this function; the
+        // budget is per function so that no function depends on the others
         std::vector<std::pair<llvm::BinaryOperator*, llvm::ConstantInt*>> candidates;
         for (auto& bb : func) {
             for (auto& inst : bb) {
                 if (auto* binOp = llvm::dyn_cast<llvm::BinaryOperator>(&inst)) {
                     if (auto* ci = llvm::dyn_cast<llvm::ConstantInt>(binOp->getOperand(1))) {
-                        if (ci->getBitWidth() <= 64 && count < (intensity_ / 10)) {
+                        if (ci->getBitWidth() <= 64 && candidates.size() < (intensity_ / 10)) {
                             candidates.push_back({binOp, ci});
                         }
                     }
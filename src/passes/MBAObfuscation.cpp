@@ -7,46 +7,34 @@
 
 #include "passes/MBAObfuscation.h"
 #include "MetricsCollector.h"
-#include "RandomGenerator.h"
+#include "RandomStream.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Instructions.h"
 
 namespace obfuscator {
 
 MBAObfuscation::MBAObfuscation(uint32_t probability)
-    : ObfuscationPass("MBAObfuscation", true), probability_(probability) {
+    : FunctionObfuscationPass("MBAObfuscation", true), probability_(probability) {
 }
 
-bool MBAObfuscation::runOnModule(llvm::Module& module, MetricsCollector& metrics) {
-    bool modified = false;
-    uint32_t totalTransformations = 0;
-    
-    for (auto& func : module) {
-        if (func.getMetadata("obfuscated.MBAObfuscation")) {
-            continue;
-        }
-        
-        if (shouldObfuscateFunction(func)) {
-            uint32_t transformed = transformArithmeticOperations(func);
-            totalTransformations += transformed;
-            if (transformed > 0) {
-                llvm::LLVMContext& ctx = func.getContext();
-                llvm::MDNode* node = llvm::MDNode::get(ctx,
-                    llvm::MDString::get(ctx, "MBAObfuscation"));
-                func.setMetadata("obfuscated.MBAObfuscation", node);
-                modified = true;
-            }
-        }
-    }
-    
-    metrics.incrementTransformations(name_, totalTransformations);
-    
-    return modified;
+PassTraits MBAObfuscation::getTraits() const {
+    // Each rewritten operation becomes an expression of about five
+    PassTraits traits;
+    traits.required = IR_ARITHMETIC;
+    traits.produced = IR_INSTRUCTIONS | IR_ARITHMETIC;
+    traits.growth = probability_ * 4;
+    return traits;
 }
 
-uint32_t MBAObfuscation::transformArithmeticOperations(llvm::Function& func) {
+uint32_t MBAObfuscation::runOnFunction(llvm::Function& func,
+                                       llvm::FunctionAnalysisManager& analyses) {
+    return transformArithmeticOperations(func, getHotness(func, analyses));
+}
+
+uint32_t MBAObfuscation::transformArithmeticOperations(llvm::Function& func,
+                                                       const BlockHotness& hotness) {
     uint32_t transformed = 0;
-    auto& rng = RandomGenerator::getInstance();
+    RandomStream rng = getRandomStream(func);
     
     std::vector<llvm::Instruction*> candidates;
     
@@ -71,8 +59,8 @@ uint32_t MBAObfuscation::transformArithmeticOperations(llvm::Function& func) {
     
     // Transform selected candidates
     for (auto* inst : candidates) {
-        // Apply probability
-        if (rng.getUInt32(0, 99) >= probability_) {
+        // Apply probability, lower in hot blocks
+        if (rng.getUInt32(0, 99) >= hotness.scale(probability_, inst->getParent())) {
             continue;
         }
         
@@ -105,7 +93,7 @@ uint32_t MBAObfuscation::transformArithmeticOperations(llvm::Function& func) {
         
         if (mbaResult) {
             // Add noise cancellation for extra complexity
-            mbaResult = addNoiseCancellation(builder, mbaResult);
+            mbaResult = addNoiseCancellation(builder, mbaResult, rng);
             
             binOp->replaceAllUsesWith(mbaResult);
             binOp->eraseFromParent();
@@ -179,9 +167,8 @@ llvm::Value* MBAObfuscation::generateMBAXor(llvm::IRBuilder<>& builder,
 }
 
 llvm::Value* MBAObfuscation::addNoiseCancellation(llvm::IRBuilder<>& builder,
-                                                  llvm::Value* expr) {
-    auto& rng = RandomGenerator::getInstance();
-    
+                                                  llvm::Value* expr,
+                                                  RandomStream& rng) {
     // Generate random noise value
     uint64_t noiseValue = rng.getUInt32(1, 1000);
     llvm::Value* noise = llvm::ConstantInt::get(expr->getType(), noiseValue);
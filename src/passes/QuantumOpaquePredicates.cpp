@@ -7,7 +7,7 @@
 
 #include "passes/QuantumOpaquePredicates.h"
 #include "MetricsCollector.h"
-#include "RandomGenerator.h"
+#include "RandomStream.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Instructions.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
@@ -15,44 +15,37 @@
 namespace obfuscator {
 
 QuantumOpaquePredicates::QuantumOpaquePredicates(uint32_t count)
-    : ObfuscationPass("QuantumOpaquePredicates", true), count_(count) {
+    : FunctionObfuscationPass("QuantumOpaquePredicates", true), count_(count) {
 }
 
-bool QuantumOpaquePredicates::runOnModule(llvm::Module& module, MetricsCollector& metrics) {
-    bool modified = false;
-    uint32_t totalPredicates = 0;
-    
-    for (auto& func : module) {
-        if (func.getMetadata("obfuscated.QuantumOpaquePredicates")) {
-            continue;
-        }
-        
-        if (shouldObfuscateFunction(func)) {
-            uint32_t inserted = insertQuantumPredicates(func);
-            totalPredicates += inserted;
-            if (inserted > 0) {
-                llvm::LLVMContext& ctx = func.getContext();
-                llvm::MDNode* node = llvm::MDNode::get(ctx, 
-                    llvm::MDString::get(ctx, "QuantumOpaquePredicates"));
-                func.setMetadata("obfuscated.QuantumOpaquePredicates", node);
-                modified = true;
-            }
-        }
-    }
-    
-    metrics.incrementTransformations(name_, totalPredicates);
-    metrics.getMetricsMutable().opaquePredicatesAdded += totalPredicates;
-    
-    return modified;
+PassTraits QuantumOpaquePredicates::getTraits() const {
+    // At most eight predicates of about ten instructions per function
+    PassTraits traits;
+    traits.required = IR_BASIC_BLOCKS;
+    traits.produced = IR_INSTRUCTIONS | IR_ARITHMETIC | IR_BASIC_BLOCKS;
+    traits.growth = std::min(count_, 8u) * 10;
+    return traits;
+}
+
+uint32_t QuantumOpaquePredicates::runOnFunction(llvm::Function& func,
+                                                llvm::FunctionAnalysisManager& analyses) {
+    return insertQuantumPredicates(func, getHotness(func, analyses));
 }
 
-uint32_t QuantumOpaquePredicates::insertQuantumPredicates(llvm::Function& func) {
+void QuantumOpaquePredicates::recordTransformations(MetricsCollector& metrics, uint32_t count) const {
+    metrics.incrementTransformations(name_, count);
+    metrics.getMetricsMutable().opaquePredicatesAdded += count;
+}
+
+uint32_t QuantumOpaquePredicates::insertQuantumPredicates(llvm::Function& func,
+                                                          const BlockHotness& hotness) {
     uint32_t inserted = 0;
-    auto& rng = RandomGenerator::getInstance();
+    RandomStream rng = getRandomStream(func);
     
     std::vector<llvm::BasicBlock*> blocks;
     for (auto& bb : func) {
-        if (bb.size() > 5 && !llvm::isa<llvm::ReturnInst>(bb.getTerminator())) {
+        if (bb.size() > 5 && !llvm::isa<llvm::ReturnInst>(bb.getTerminator()) &&
+            hotness.getIntensity(&bb) > 0) {
             blocks.push_back(&bb);
         }
     }
@@ -71,6 +64,10 @@ uint32_t QuantumOpaquePredicates::insertQuantumPredicates(llvm::Function& func)
         
         if (!bb || bb->size() < 6) continue;
         
+        // Warm blocks only get a predicate some of the time
+        uint32_t intensity = hotness.getIntensity(bb);
+        if (intensity < 100 && !rng.getBool(intensity)) continue;
+        
         // Find safe split point (not at terminator, not at PHI)
         auto splitPoint = bb->begin();
         size_t splitPos = bb->size() / 2;
@@ -7,7 +7,7 @@
 
 #include "passes/StringEncryption.h"
 #include "MetricsCollector.h"
-#include "RandomGenerator.h"
+#include "RandomStream.h"
 #include "llvm/IR/IRBuilder.h"
 #include "llvm/IR/Constants.h"
 #include "llvm/IR/GlobalVariable.h"
@@ -18,6 +18,16 @@ StringEncryption::StringEncryption(const std::string& algorithm)
     : ObfuscationPass("StringEncryption", true), algorithm_(algorithm) {
 }
 
+PassTraits StringEncryption::getTraits() const {
+    // The decryption constructor is an ordinary loop that later
+    // function-local passes will rewrite like any other function
+    PassTraits traits;
+    traits.required = IR_PLAIN_STRINGS;
+    traits.invalidated = IR_PLAIN_STRINGS;
+    traits.produced = IR_RUNTIME_HELPERS | IR_INSTRUCTIONS | IR_ARITHMETIC | IR_BASIC_BLOCKS;
+    return traits;
+}
+
 bool StringEncryption::runOnModule(llvm::Module& module, MetricsCollector& metrics) {
     // Skip if already processed (check module-level metadata)
     if (module.getNamedMetadata("obfuscated.StringEncryption")) {
@@ -47,7 +57,6 @@ bool StringEncryption::runOnModule(llvm::Module& module, MetricsCollector& metri
 
 uint32_t StringEncryption::encryptStrings(llvm::Module& module) {
     uint32_t count = 0;
-    auto& rng = RandomGenerator::getInstance();
     
     std::vector<llvm::GlobalVariable*> stringGlobals;
     
@@ -71,7 +80,8 @@ uint32_t StringEncryption::encryptStrings(llvm::Module& module) {
             continue;  // Skip very short or very long strings
         }
         
-        // Generate random key
+        // Generate random key from the string's own stream
+        RandomStream rng = getRandomStream(global->getName());
         uint8_t key = static_cast<uint8_t>(rng.getUInt32(1, 255));
         
         // Encrypt string
@@ -0,0 +1,154 @@
+/**
+ * @file PhantronPass.cpp
+ * @brief Implementation of PhantronPass and its command line options
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "PhantronPass.h"
+#include "ConfigParser.h"
+#include "Logger.h"
+#include "MetricsCollector.h"
+#include "PassManager.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/ErrorHandling.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstdlib>
+
+namespace obfuscator {
+
+namespace {
+
+llvm::cl::OptionCategory pluginCategory("Phantron obfuscation options");
+
+llvm::cl::opt<std::string> levelOption(
+    "phantron-level", llvm::cl::desc("Obfuscation level: low, medium or high"),
+    llvm::cl::value_desc("level"), llvm::cl::cat(pluginCategory));
+
+llvm::cl::opt<std::string> configOption(
+    "phantron-config", llvm::cl::desc("YAML configuration file (overrides PHANTRON_CONFIG)"),
+    llvm::cl::value_desc("file"), llvm::cl::cat(pluginCategory));
+
+llvm::cl::opt<uint32_t> seedOption(
+    "phantron-seed", llvm::cl::desc("Random seed, for reproducible builds"),
+    llvm::cl::cat(pluginCategory));
+
+llvm::cl::opt<uint32_t> cyclesOption(
+    "phantron-cycles", llvm::cl::desc("Obfuscation cycles"), llvm::cl::cat(pluginCategory));
+
+llvm::cl::opt<uint32_t> passJobsOption(
+    "phantron-pass-jobs", llvm::cl::desc("Threads for function-local passes (0 = all cores)"),
+    llvm::cl::cat(pluginCategory));
+
+llvm::cl::opt<uint32_t> hotLoopThresholdOption(
+    "phantron-hot-loop-threshold",
+    llvm::cl::desc("Spare innermost-loop blocks estimated to run this often per call (0 = off)"),
+    llvm::cl::cat(pluginCategory));
+
+llvm::cl::opt<bool> verboseOption(
+    "phantron-verbose", llvm::cl::desc("Log every obfuscation step"),
+    llvm::cl::cat(pluginCategory));
+
+} // anonymous namespace
+
+PhantronPass::PhantronPass(const ObfuscationConfig& config)
+    : config_(config), passManager_(std::make_unique<PassManager>(config)) {
+}
+
+PhantronPass::PhantronPass(PhantronPass&&) = default;
+
+PhantronPass::~PhantronPass() = default;
+
+llvm::PreservedAnalyses PhantronPass::run(llvm::Module& module, llvm::ModuleAnalysisManager&) {
+    MetricsCollector metrics;
+    bool modified = false;
+    passManager_->resolvePolicies(module);
+    for (uint32_t cycle = 0; cycle < config_.obfuscationCycles; ++cycle) {
+        modified |= passManager_->runPasses(module, metrics, cycle);
+    }
+    if (!modified) {
+        return llvm::PreservedAnalyses::all();
+    }
+
+    // A broken module would otherwise surface as a crash somewhere in codegen
+    std::string errorMsg;
+    llvm::raw_string_ostream errorStream(errorMsg);
+    if (llvm::verifyModule(module, &errorStream)) {
+        Logger::getInstance().error("Module verification failed: " + errorStream.str());
+        llvm::report_fatal_error(llvm::Twine("phantron: obfuscation of ") +
+                                 module.getModuleIdentifier() + " produced invalid IR");
+    }
+    return llvm::PreservedAnalyses::none();
+}
+
+bool loadPluginConfig(ObfuscationConfig& config) {
+    config.applyPreset(ObfuscationLevel::MEDIUM);
+    if (levelOption == "low") {
+        config.applyPreset(ObfuscationLevel::LOW);
+    } else if (levelOption == "high") {
+        config.applyPreset(ObfuscationLevel::HIGH);
+    } else if (!levelOption.empty() && levelOption != "medium") {
+        Logger::getInstance().error("Invalid -phantron-level: " + levelOption);
+        return false;
+    }
+
+    ConfigParser parser;
+    const char* environmentConfig = std::getenv("PHANTRON_CONFIG");
+    if (environmentConfig && *environmentConfig &&
+        !parser.parseFile(environmentConfig, config)) {
+        return false;
+    }
+    if (!configOption.empty() && !parser.parseFile(configOption, config)) {
+        return false;
+    }
+
+    if (seedOption.getNumOccurrences()) {
+        config.seed = seedOption;
+    }
+    if (cyclesOption.getNumOccurrences()) {
+        config.obfuscationCycles = cyclesOption;
+    }
+    if (passJobsOption.getNumOccurrences()) {
+        config.passJobs = passJobsOption;
+    }
+    if (hotLoopThresholdOption.getNumOccurrences()) {
+        config.hotLoopThreshold = hotLoopThresholdOption;
+    }
+    if (verboseOption.getNumOccurrences()) {
+        config.verbose = verboseOption;
+    }
+    Logger::getInstance().setVerbose(config.verbose);
+
+    if (!config.validate()) {
+        Logger::getInstance().error("Invalid obfuscation configuration");
+        return false;
+    }
+    return true;
+}
+
+void registerPhantronPass(llvm::PassBuilder& builder) {
+    auto createPass = []() {
+        ObfuscationConfig config;
+        if (!loadPluginConfig(config)) {
+            llvm::report_fatal_error("phantron: cannot load the obfuscation configuration");
+        }
+        return PhantronPass(config);
+    };
+
+    builder.registerOptimizerLastEPCallback(
+        [createPass](llvm::ModulePassManager& passes, llvm::OptimizationLevel) {
+            passes.addPass(createPass());
+        });
+    builder.registerPipelineParsingCallback(
+        [createPass](llvm::StringRef name, llvm::ModulePassManager& passes,
+                     llvm::ArrayRef<llvm::PassBuilder::PipelineElement>) {
+            if (name != "phantron") {
+                return false;
+            }
+            passes.addPass(createPass());
+            return true;
+        });
+}
+
+} // namespace obfuscator
@@ -0,0 +1,23 @@
+/**
+ * @file PhantronPlugin.cpp
+ * @brief Entry point of the phantron LLVM pass plugin
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * clang -O2 -fpass-plugin=libphantron.so foo.c
+ * opt -load-pass-plugin=libphantron.so -passes='default<O2>' foo.ll
+ *
+ * -phantron-* options are parsed before -fpass-plugin/-load-pass-plugin
+ * load the plugin, so using them also needs the plugin loaded early:
+ * clang -Xclang -load -Xclang libphantron.so -mllvm -phantron-level=high ...
+ * or opt -load libphantron.so -phantron-level=high ...
+ */
+
+#include "PhantronPass.h"
+#include "llvm/Config/llvm-config.h"
+#include "llvm/Passes/PassPlugin.h"
+
+extern "C" LLVM_ATTRIBUTE_WEAK ::llvm::PassPluginLibraryInfo llvmGetPassPluginInfo() {
+    return {LLVM_PLUGIN_API_VERSION, "phantron", PHANTRON_VERSION,
+            obfuscator::registerPhantronPass};
+}
@@ -6,6 +6,7 @@
  */
 
 #include "MetricsCollector.h"
+#include <algorithm>
 
 namespace obfuscator {
 
@@ -33,6 +34,10 @@ ObfuscationMetrics::ObfuscationMetrics()
       constantsObfuscated(0),
       antiDebugChecksAdded(0),
       fakeLoopsInserted(0),
+      cacheHits(0),
+      cacheMisses(0),
+      functionCacheHits(0),
+      functionCacheMisses(0),
       compilationTime(0),
       obfuscationTime(0),
       linkingTime(0),
@@ -80,9 +85,79 @@ void MetricsCollector::recordStringEncryption(uint32_t count, uint32_t originalS
 }
 
 void MetricsCollector::recordTiming(const std::string& passName, 
-                                   std::chrono::milliseconds duration) {
-    metrics_.passTimings[passName] = duration;
-    metrics_.totalTime += duration;
+                                   std::chrono::nanoseconds duration) {
+    metrics_.passTimings[passName] += duration;
+}
+
+void MetricsCollector::recordPassCounters(const std::string& passName,
+                                          const PerfCounterValues& counters) {
+    metrics_.passCounters[passName] += counters;
+}
+
+void MetricsCollector::recordStageCounters(const std::string& stageName,
+                                           const PerfCounterValues& counters) {
+    metrics_.stageCounters[stageName] += counters;
+}
+
+void MetricsCollector::recordPassMemory(const PassMemoryStats& stats) {
+    metrics_.passMemory.push_back(stats);
+}
+
+void MetricsCollector::recordPassSchedule(const std::vector<std::string>& schedule) {
+    metrics_.passSchedule = schedule;
+}
+
+void MetricsCollector::merge(const MetricsCollector& other) {
+    const ObfuscationMetrics& o = other.metrics_;
+    
+    metrics_.originalInstructionCount += o.originalInstructionCount;
+    metrics_.obfuscatedInstructionCount += o.obfuscatedInstructionCount;
+    metrics_.originalBasicBlockCount += o.originalBasicBlockCount;
+    metrics_.obfuscatedBasicBlockCount += o.obfuscatedBasicBlockCount;
+    metrics_.originalFunctionCount += o.originalFunctionCount;
+    metrics_.obfuscatedFunctionCount += o.obfuscatedFunctionCount;
+    
+    metrics_.totalObfuscationCycles = std::max(metrics_.totalObfuscationCycles,
+                                               o.totalObfuscationCycles);
+    metrics_.controlFlowTransformations += o.controlFlowTransformations;
+    metrics_.instructionSubstitutions += o.instructionSubstitutions;
+    metrics_.bogusBlocksAdded += o.bogusBlocksAdded;
+    metrics_.opaquePredicatesAdded += o.opaquePredicatesAdded;
+    metrics_.deadCodeInstructionsAdded += o.deadCodeInstructionsAdded;
+    
+    metrics_.stringsEncrypted += o.stringsEncrypted;
+    metrics_.stringsOriginalSize += o.stringsOriginalSize;
+    metrics_.stringsEncryptedSize += o.stringsEncryptedSize;
+    
+    metrics_.functionsVirtualized += o.functionsVirtualized;
+    metrics_.callGraphTransformations += o.callGraphTransformations;
+    metrics_.constantsObfuscated += o.constantsObfuscated;
+    metrics_.antiDebugChecksAdded += o.antiDebugChecksAdded;
+    metrics_.fakeLoopsInserted += o.fakeLoopsInserted;
+    
+    metrics_.cacheHits += o.cacheHits;
+    metrics_.cacheMisses += o.cacheMisses;
+    metrics_.functionCacheHits += o.functionCacheHits;
+    metrics_.functionCacheMisses += o.functionCacheMisses;
+    
+    for (const auto& entry : o.passTransformations) {
+        metrics_.passTransformations[entry.first] += entry.second;
+    }
+    for (const auto& entry : o.passTimings) {
+        metrics_.passTimings[entry.first] += entry.second;
+    }
+    for (const auto& entry : o.passCounters) {
+        metrics_.passCounters[entry.first] += entry.second;
+    }
+    for (const auto& entry : o.stageCounters) {
+        metrics_.stageCounters[entry.first] += entry.second;
+    }
+    metrics_.passMemory.insert(metrics_.passMemory.end(), o.passMemory.begin(),
+                               o.passMemory.end());
+    // Every unit of a run shares one configuration and thus one schedule
+    if (metrics_.passSchedule.empty()) {
+        metrics_.passSchedule = o.passSchedule;
+    }
 }
 
 } // namespace obfuscator
@@ -23,6 +23,51 @@ std::string getCurrentTimestamp() {
     return oss.str();
 }
 
+// Counter deltas by pass or stage, as one JSON object; only counters that
+// could be read are listed
+std::string formatCounters(const std::map<std::string, PerfCounterValues>& counters,
+                           const std::string& indent) {
+    std::ostringstream json;
+    json << "{";
+    bool first = true;
+    for (const auto& entry : counters) {
+        const PerfCounterValues& values = entry.second;
+        json << (first ? "\n" : ",\n") << indent << "  \"" << entry.first << "\": {";
+        bool firstCounter = true;
+        for (int i = 0; i < PerfCounterValues::COUNTER_COUNT; ++i) {
+            auto counter = static_cast<PerfCounterValues::Counter>(i);
+            if (values.has(counter)) {
+                json << (firstCounter ? "" : ", ") << "\""
+                     << PerfCounterValues::getCounterName(counter) << "\": " << values.counts[i];
+                firstCounter = false;
+            }
+        }
+        if (values.has(PerfCounterValues::CYCLES) && values.has(PerfCounterValues::INSTRUCTIONS)) {
+            json << ", \"ipc\": " << values.getIPC();
+        }
+        json << "}";
+        first = false;
+    }
+    json << (first ? "}" : "\n" + indent + "}");
+    return json.str();
+}
+
+// Index of the pass run with the largest value of a field, or -1
+template <typename Field>
+int findLargest(const std::vector<PassMemoryStats>& runs, Field field) {
+    int largest = -1;
+    for (size_t i = 0; i < runs.size(); ++i) {
+        if (largest < 0 || field(runs[i]) > field(runs[largest])) {
+            largest = static_cast<int>(i);
+        }
+    }
+    return largest;
+}
+
+std::string describeRun(const PassMemoryStats& run) {
+    return run.pass + " (cycle " + std::to_string(run.cycle + 1) + ")";
+}
+
 ReportGenerator::ReportGenerator(const ObfuscationConfig& config)
     : config_(config) {
 }
@@ -142,13 +187,103 @@ bool ReportGenerator::generateJSONReport(const std::string& outputPath) {
     json << "      \"anti_debug_checks_added\": " << metrics.antiDebugChecksAdded << "\n";
     json << "    },\n\n";
     
+    // Result cache
+    json << "    \"result_cache\": {\n";
+    json << "      \"enabled\": " << (config_.cacheDirectory.empty() ? "false" : "true") << ",\n";
+    json << "      \"hits\": " << metrics.cacheHits << ",\n";
+    json << "      \"misses\": " << metrics.cacheMisses << ",\n";
+    json << "      \"incremental\": " << (config_.incremental ? "true" : "false") << ",\n";
+    json << "      \"function_hits\": " << metrics.functionCacheHits << ",\n";
+    json << "      \"function_misses\": " << metrics.functionCacheMisses << "\n";
+    json << "    },\n\n";
+    
+    // Pass run order
+    json << "    \"pass_schedule\": [";
+    for (size_t i = 0; i < metrics.passSchedule.size(); ++i) {
+        json << (i ? ", " : "") << "\"" << metrics.passSchedule[i] << "\"";
+    }
+    json << "],\n\n";
+    
     // Timing information
     json << "    \"timing_milliseconds\": {\n";
     json << "      \"compilation_time\": " << metrics.compilationTime.count() << ",\n";
     json << "      \"obfuscation_time\": " << metrics.obfuscationTime.count() << ",\n";
     json << "      \"linking_time\": " << metrics.linkingTime.count() << ",\n";
-    json << "      \"total_time\": " << metrics.totalTime.count() << "\n";
-    json << "    }\n";
+    json << "      \"total_time\": " << metrics.totalTime.count() << ",\n";
+    json << "      \"passes\": {";
+    bool firstPass = true;
+    for (const auto& timing : metrics.passTimings) {
+        json << (firstPass ? "\n" : ",\n") << "        \"" << timing.first << "\": "
+             << std::chrono::duration<double, std::milli>(timing.second).count();
+        firstPass = false;
+    }
+    json << (firstPass ? "}\n" : "\n      }\n");
+    json << "    }";
+    
+    // Hardware counters
+    if (config_.perfCounters) {
+        bool available = false;
+        for (const auto& entry : metrics.stageCounters) {
+            available |= entry.second.available != 0;
+        }
+        for (const auto& entry : metrics.passCounters) {
+            available |= entry.second.available != 0;
+        }
+        json << ",\n\n    \"performance_counters\": {\n";
+        json << "      \"available\": " << (available ? "true" : "false") << ",\n";
+        json << "      \"stages\": " << formatCounters(metrics.stageCounters, "      ") << ",\n";
+        json << "      \"passes\": " << formatCounters(metrics.passCounters, "      ") << "\n";
+        json << "    }";
+    }
+    
+    // Memory use and IR growth per pass run, and the worst offenders
+    if (config_.memoryProfile) {
+        const auto& runs = metrics.passMemory;
+        json << ",\n\n    \"memory_profile\": {\n";
+        json << "      \"passes\": [";
+        for (size_t i = 0; i < runs.size(); ++i) {
+            const auto& run = runs[i];
+            json << (i ? ",\n" : "\n") << "        {\"pass\": \"" << run.pass << "\""
+                 << ", \"cycle\": " << run.cycle + 1
+                 << ", \"instructions_delta\": " << run.instructionDelta
+                 << ", \"basic_blocks_delta\": " << run.basicBlockDelta
+                 << ", \"functions_delta\": " << run.functionDelta
+                 << ", \"globals_delta\": " << run.globalDelta
+                 << ", \"peak_rss_bytes\": " << run.peakResidentBytes
+                 << ", \"peak_rss_growth_bytes\": " << run.peakResidentGrowth
+                 << ", \"rss_delta_bytes\": " << run.residentDelta
+                 << ", \"allocated_bytes\": " << run.allocatedBytes
+                 << ", \"batched\": " << (run.batched ? "true" : "false") << "}";
+        }
+        json << (runs.empty() ? "],\n" : "\n      ],\n");
+        
+        struct Highlight {
+            const char* name;
+            int index;
+        };
+        Highlight highlights[] = {
+            {"peak_rss_growth", findLargest(runs, [](const PassMemoryStats& r) {
+                return r.peakResidentGrowth; })},
+            {"allocated", findLargest(runs, [](const PassMemoryStats& r) {
+                return r.allocatedBytes; })},
+            {"instruction_growth", findLargest(runs, [](const PassMemoryStats& r) {
+                return r.instructionDelta; })},
+        };
+        json << "      \"largest\": {";
+        bool first = true;
+        for (const auto& highlight : highlights) {
+            if (highlight.index < 0) {
+                continue;
+            }
+            const auto& run = runs[highlight.index];
+            json << (first ? "\n" : ",\n") << "        \"" << highlight.name
+                 << "\": {\"pass\": \"" << run.pass << "\", \"cycle\": " << run.cycle + 1 << "}";
+            first = false;
+        }
+        json << (first ? "}\n" : "\n      }\n");
+        json << "    }";
+    }
+    json << "\n";
     
     json << "  }\n";
     json << "}\n";
@@ -240,6 +375,17 @@ bool ReportGenerator::generateHTMLReport(const std::string& outputPath) {
     html << "      <tr><td><strong>Total</strong></td><td><strong>" << metrics.totalTime.count() << "</strong></td></tr>\n";
     html << "    </table>\n";
     
+    if (!metrics.passSchedule.empty()) {
+        html << "    <h2>Pass Schedule</h2>\n";
+        html << "    <table>\n";
+        html << "      <tr><th>#</th><th>Pass</th></tr>\n";
+        for (size_t i = 0; i < metrics.passSchedule.size(); ++i) {
+            html << "      <tr><td>" << i + 1 << "</td><td>" << metrics.passSchedule[i]
+                 << "</td></tr>\n";
+        }
+        html << "    </table>\n";
+    }
+    
     html << "  </div>\n";
     html << "</body>\n";
     html << "</html>\n";
@@ -262,6 +408,27 @@ void ReportGenerator::printSummary() const {
     std::cout << "Strings encrypted: " << metrics.stringsEncrypted << "\n";
     std::cout << "Obfuscation cycles: " << config_.obfuscationCycles << "\n";
     std::cout << "Total time: " << metrics.totalTime.count() << " ms\n";
+    if (!metrics.passSchedule.empty()) {
+        std::cout << "Pass schedule: ";
+        for (size_t i = 0; i < metrics.passSchedule.size(); ++i) {
+            std::cout << (i ? " -> " : "") << metrics.passSchedule[i];
+        }
+        std::cout << "\n";
+    }
+    
+    const auto& runs = metrics.passMemory;
+    int peak = findLargest(runs, [](const PassMemoryStats& r) { return r.peakResidentGrowth; });
+    int allocated = findLargest(runs, [](const PassMemoryStats& r) { return r.allocatedBytes; });
+    int growth = findLargest(runs, [](const PassMemoryStats& r) { return r.instructionDelta; });
+    if (peak >= 0) {
+        std::cout << "Largest peak RSS growth: " << describeRun(runs[peak]) << ", +"
+                  << runs[peak].peakResidentGrowth / 1024 << " KB"
+                  << (runs[peak].batched ? " (parallel batch)" : "") << "\n";
+        std::cout << "Most allocated: " << describeRun(runs[allocated]) << ", "
+                  << runs[allocated].allocatedBytes / 1024 << " KB\n";
+        std::cout << "Largest IR growth: " << describeRun(runs[growth]) << ", "
+                  << runs[growth].instructionDelta << " instructions\n";
+    }
     std::cout << "===========================\n\n";
 }
 
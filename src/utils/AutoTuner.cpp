@@ -448,25 +448,39 @@ bool AutoTuner::saveConfigToYAML(const ObfuscationConfig& config,
          config.level == ObfuscationLevel::MEDIUM ? "medium" : "high") << "\n\n";
     
     file << "obfuscation:\n";
+    file << "  level: " <<
+        (config.level == ObfuscationLevel::LOW ? "low" :
+         config.level == ObfuscationLevel::MEDIUM ? "medium" : "high") << "\n";
     file << "  cycles: " << config.obfuscationCycles << "\n";
     file << "  seed: " << config.seed << "\n";
-    file << "  verbose: " << (config.verbose ? "true" : "false") << "\n\n";
+    file << "  verbose: " << (config.verbose ? "true" : "false") << "\n";
+    file << "  hot_loop_threshold: " << config.hotLoopThreshold << "\n\n";
     
     file << "control_flow:\n";
     file << "  flattening_enabled: " << (config.enableControlFlowFlattening ? "true" : "false") << "\n";
     file << "  flattening_complexity: " << config.flatteningComplexity << "\n";
     file << "  opaque_predicates: " << (config.enableOpaquePredicates ? "true" : "false") << "\n";
     file << "  opaque_count: " << config.opaquePredicateCount << "\n";
-    file << "  bogus_control_flow: " << (config.enableBogusControlFlow ? "true" : "false") << "\n\n";
+    file << "  bogus_control_flow: " << (config.enableBogusControlFlow ? "true" : "false") << "\n";
+    file << "  bogus_probability: " << config.bogusBlockProbability << "\n\n";
+    
+    file << "instructions:\n";
+    file << "  substitution: " << (config.enableInstructionSubstitution ? "true" : "false") << "\n";
+    file << "  substitution_probability: " << config.substitutionProbability << "\n";
+    file << "  dead_code: " << (config.enableDeadCodeInjection ? "true" : "false") << "\n";
+    file << "  dead_code_ratio: " << config.deadCodeRatio << "\n\n";
     
     file << "data_obfuscation:\n";
     file << "  string_encryption: " << (config.enableStringEncryption ? "true" : "false") << "\n";
+    file << "  string_algorithm: " << config.stringEncryptionAlgorithm << "\n";
     file << "  constant_obfuscation: " << (config.enableConstantObfuscation ? "true" : "false") << "\n";
     file << "  constant_complexity: " << config.constantObfuscationComplexity << "\n\n";
     
     file << "advanced:\n";
     file << "  function_virtualization: " << (config.enableFunctionVirtualization ? "true" : "false") << "\n";
+    file << "  call_graph_obfuscation: " << (config.enableCallGraphObfuscation ? "true" : "false") << "\n";
     file << "  anti_debug: " << (config.enableAntiDebug ? "true" : "false") << "\n";
+    file << "  cache_obfuscation: " << (config.enableHardwareCacheObfuscation ? "true" : "false") << "\n";
     file << "  cache_obfuscation_intensity: " << config.cacheObfuscationIntensity << "\n\n";
     
     file.close();
@@ -0,0 +1,67 @@
+/**
+ * @file CountingAllocator.cpp
+ * @brief Global operator new/delete replacements that feed MemoryTracker
+ * @version 2.0.0
+ * @date 2025-10-13
+ *
+ * Linked into the phantron executables only, never into obfuscator_lib or
+ * the pass plugin, so programs embedding the library keep their own
+ * allocator. Array forms and the nothrow forms fall through to these.
+ */
+
+#include "MemoryTracker.h"
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+void* allocate(std::size_t size, std::size_t alignment) {
+    obfuscator::MemoryTracker::recordAllocation(size);
+    if (size == 0) {
+        size = 1;
+    }
+    if (alignment > alignof(std::max_align_t)) {
+        // aligned_alloc wants a size that is a multiple of the alignment
+        size = (size + alignment - 1) & ~(alignment - 1);
+    }
+
+    while (true) {
+        void* memory = alignment > alignof(std::max_align_t)
+            ? std::aligned_alloc(alignment, size)
+            : std::malloc(size);
+        if (memory) {
+            return memory;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+} // anonymous namespace
+
+void* operator new(std::size_t size) {
+    return allocate(size, alignof(std::max_align_t));
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return allocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept {
+    std::free(memory);
+}
@@ -13,7 +13,7 @@
 namespace obfuscator {
 
 Logger::Logger() 
-    : logLevel_(LogLevel::INFO), verbose_(false) {
+    : logLevel_(LogLevel::INFO), verbose_(false), useStderr_(false) {
 }
 
 Logger::~Logger() {
@@ -43,6 +43,10 @@ void Logger::setVerbose(bool verbose) {
     verbose_ = verbose;
 }
 
+void Logger::setUseStderr(bool useStderr) {
+    useStderr_ = useStderr;
+}
+
 void Logger::debug(const std::string& message) {
     log(LogLevel::DEBUG, message);
 }
@@ -70,7 +74,7 @@ void Logger::log(LogLevel level, const std::string& message) {
                             levelToString(level) + "] " + message;
     
     if (verbose_ || level >= LogLevel::WARNING) {
-        std::cout << logMessage << std::endl;
+        (useStderr_ ? std::cerr : std::cout) << logMessage << std::endl;
     }
     
     if (logFile_.is_open()) {
@@ -0,0 +1,106 @@
+/**
+ * @file MemoryFile.cpp
+ * @brief Implementation of MemoryFile
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "MemoryFile.h"
+#include "Logger.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/FileSystem.h"
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <sys/mman.h>
+#endif
+
+#ifndef _WIN32
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
+namespace obfuscator {
+
+MemoryFile::MemoryFile(const std::string& name)
+    : fd_(-1), isTempFile_(false) {
+#ifdef __linux__
+    // No MFD_CLOEXEC: child processes must inherit the descriptor
+    fd_ = memfd_create(name.c_str(), 0);
+    if (fd_ >= 0) {
+        path_ = "/proc/self/fd/" + std::to_string(fd_);
+        return;
+    }
+    Logger::getInstance().warning("memfd_create failed (" + std::string(std::strerror(errno)) +
+                                  "), using a temporary file");
+#endif
+
+    llvm::SmallString<128> tempPath;
+    if (llvm::sys::fs::createTemporaryFile(name, "tmp", fd_, tempPath)) {
+        Logger::getInstance().error("Failed to create temporary file for " + name);
+        fd_ = -1;
+        return;
+    }
+    path_ = tempPath.str().str();
+    isTempFile_ = true;
+}
+
+MemoryFile::~MemoryFile() {
+    if (fd_ >= 0) {
+        ::close(fd_);
+    }
+    if (isTempFile_) {
+        llvm::sys::fs::remove(path_);
+    }
+}
+
+bool MemoryFile::write(llvm::StringRef data) {
+    if (fd_ < 0) {
+        return false;
+    }
+
+#ifndef _WIN32
+    if (::ftruncate(fd_, 0) != 0 || ::lseek(fd_, 0, SEEK_SET) != 0) {
+        return false;
+    }
+#endif
+
+    const char* ptr = data.data();
+    size_t remaining = data.size();
+    while (remaining > 0) {
+        auto written = ::write(fd_, ptr, remaining);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        ptr += written;
+        remaining -= static_cast<size_t>(written);
+    }
+
+    return true;
+}
+
+std::unique_ptr<llvm::MemoryBuffer> MemoryFile::read() const {
+    if (fd_ < 0) {
+        return nullptr;
+    }
+
+    // Volatile: contents may have been written by another process, so copy
+    // instead of mapping
+    auto buffer = llvm::MemoryBuffer::getOpenFile(
+        llvm::sys::fs::convertFDToNativeFile(fd_), path_, -1,
+        /*RequiresNullTerminator=*/false, /*IsVolatile=*/true);
+    if (!buffer) {
+        Logger::getInstance().error("Failed to read " + path_ + ": " +
+                                    buffer.getError().message());
+        return nullptr;
+    }
+
+    return std::move(*buffer);
+}
+
+} // namespace obfuscator
@@ -0,0 +1,91 @@
+/**
+ * @file MemoryTracker.cpp
+ * @brief Implementation of MemoryTracker
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "MemoryTracker.h"
+#include <cstdlib>
+#include <fstream>
+#include <string>
+
+namespace obfuscator {
+
+namespace {
+
+// Constant-initialized, so it is safe to touch from any allocation
+thread_local uint64_t threadAllocatedBytes = 0;
+
+uint64_t readStatusField(const char* field) {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    std::string prefix = std::string(field) + ":";
+    while (std::getline(status, line)) {
+        if (line.compare(0, prefix.size(), prefix) == 0) {
+            return std::strtoull(line.c_str() + prefix.size(), nullptr, 10) * 1024;
+        }
+    }
+    return 0;
+}
+
+} // anonymous namespace
+
+IRSize IRSize::measure(const llvm::Module& module) {
+    IRSize size;
+    for (const auto& func : module) {
+        if (func.isDeclaration()) {
+            continue;
+        }
+        size.functions++;
+        for (const auto& bb : func) {
+            size.basicBlocks++;
+            size.instructions += bb.size();
+        }
+    }
+    size.globals = module.global_size();
+    return size;
+}
+
+IRSize& IRSize::operator+=(const IRSize& other) {
+    instructions += other.instructions;
+    basicBlocks += other.basicBlocks;
+    functions += other.functions;
+    globals += other.globals;
+    return *this;
+}
+
+IRSize IRSize::operator-(const IRSize& other) const {
+    IRSize delta;
+    delta.instructions = instructions - other.instructions;
+    delta.basicBlocks = basicBlocks - other.basicBlocks;
+    delta.functions = functions - other.functions;
+    delta.globals = globals - other.globals;
+    return delta;
+}
+
+void MemoryTracker::recordAllocation(uint64_t bytes) {
+    threadAllocatedBytes += bytes;
+}
+
+uint64_t MemoryTracker::getThreadAllocatedBytes() {
+    return threadAllocatedBytes;
+}
+
+uint64_t MemoryTracker::getResidentBytes() {
+    return readStatusField("VmRSS");
+}
+
+uint64_t MemoryTracker::getPeakResidentBytes() {
+    return readStatusField("VmHWM");
+}
+
+bool MemoryTracker::resetPeakResident() {
+    // "5" resets VmHWM to the current RSS (Linux 4.0 and later)
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    clearRefs << "5";
+    clearRefs.flush();
+    return static_cast<bool>(clearRefs);
+}
+
+} // namespace obfuscator
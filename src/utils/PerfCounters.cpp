@@ -0,0 +1,171 @@
+/**
+ * @file PerfCounters.cpp
+ * @brief Implementation of PerfCounters
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "PerfCounters.h"
+#include "Logger.h"
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <string>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace obfuscator {
+
+double PerfCounterValues::getIPC() const {
+    if (!has(CYCLES) || !has(INSTRUCTIONS) || counts[CYCLES] == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(counts[INSTRUCTIONS]) / static_cast<double>(counts[CYCLES]);
+}
+
+const char* PerfCounterValues::getCounterName(Counter counter) {
+    switch (counter) {
+        case CYCLES:        return "cycles";
+        case INSTRUCTIONS:  return "instructions";
+        case CACHE_MISSES:  return "llc_misses";
+        case BRANCH_MISSES: return "branch_misses";
+        default:            return "unknown";
+    }
+}
+
+PerfCounterValues& PerfCounterValues::operator+=(const PerfCounterValues& other) {
+    for (int i = 0; i < COUNTER_COUNT; ++i) {
+        counts[i] += other.counts[i];
+    }
+    available |= other.available;
+    return *this;
+}
+
+PerfCounterValues PerfCounterValues::operator-(const PerfCounterValues& earlier) const {
+    PerfCounterValues delta;
+    delta.available = available & earlier.available;
+    for (int i = 0; i < COUNTER_COUNT; ++i) {
+        // Scaled readings of a multiplexed counter can step back slightly
+        delta.counts[i] = counts[i] > earlier.counts[i] ? counts[i] - earlier.counts[i] : 0;
+    }
+    return delta;
+}
+
+PerfCounters& PerfCounters::forThread() {
+    thread_local PerfCounters counters;
+    return counters;
+}
+
+#ifdef __linux__
+
+namespace {
+
+// Readings with PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING
+struct Reading {
+    uint64_t value;
+    uint64_t timeEnabled;
+    uint64_t timeRunning;
+};
+
+int openCounter(uint32_t type, uint64_t config) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    // User space only, which perf_event_paranoid <= 2 allows without privileges
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, PERF_FLAG_FD_CLOEXEC));
+}
+
+} // anonymous namespace
+
+PerfCounters::PerfCounters() {
+    static const std::array<uint64_t, PerfCounterValues::COUNTER_COUNT> configs = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES,
+        PERF_COUNT_HW_BRANCH_MISSES,
+    };
+
+    std::string refused;
+    for (int i = 0; i < PerfCounterValues::COUNTER_COUNT; ++i) {
+        fds_[i] = openCounter(PERF_TYPE_HARDWARE, configs[i]);
+        if (fds_[i] < 0) {
+            refused += std::string(refused.empty() ? "" : ", ") +
+                       PerfCounterValues::getCounterName(
+                           static_cast<PerfCounterValues::Counter>(i)) +
+                       " (" + std::strerror(errno) + ")";
+        }
+    }
+
+    // Every thread opens its own counters; one warning is enough
+    static std::once_flag warned;
+    if (!refused.empty()) {
+        std::call_once(warned, [&refused] {
+            Logger::getInstance().warning("Hardware counters unavailable: " + refused);
+        });
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int fd : fds_) {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+}
+
+PerfCounterValues PerfCounters::read() const {
+    PerfCounterValues values;
+    for (int i = 0; i < PerfCounterValues::COUNTER_COUNT; ++i) {
+        Reading reading;
+        if (fds_[i] < 0 || ::read(fds_[i], &reading, sizeof(reading)) != sizeof(reading)) {
+            continue;
+        }
+        // Counters that had to share the PMU only ran part of the time
+        if (reading.timeRunning > 0 && reading.timeRunning < reading.timeEnabled) {
+            reading.value = static_cast<uint64_t>(
+                static_cast<double>(reading.value) * reading.timeEnabled / reading.timeRunning);
+        }
+        values.counts[i] = reading.value;
+        values.available |= 1u << i;
+    }
+    return values;
+}
+
+#else
+
+PerfCounters::PerfCounters() {
+    fds_.fill(-1);
+    static std::once_flag warned;
+    std::call_once(warned, [] {
+        Logger::getInstance().warning("Hardware counters are only supported on Linux");
+    });
+}
+
+PerfCounters::~PerfCounters() {
+}
+
+PerfCounterValues PerfCounters::read() const {
+    return PerfCounterValues();
+}
+
+#endif
+
+bool PerfCounters::isAvailable() const {
+    for (int fd : fds_) {
+        if (fd >= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace obfuscator
@@ -15,7 +15,8 @@ RandomGenerator::RandomGenerator() {
 }
 
 RandomGenerator& RandomGenerator::getInstance() {
-    static RandomGenerator instance;
+    // One generator per thread so concurrent workers never share state
+    thread_local RandomGenerator instance;
     return instance;
 }
 
@@ -0,0 +1,108 @@
+/**
+ * @file RandomStream.cpp
+ * @brief Implementation of RandomStream
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "RandomStream.h"
+#include "llvm/Support/xxhash.h"
+
+namespace obfuscator {
+
+namespace {
+
+constexpr uint32_t PHILOX_M0 = 0xD2511F53;
+constexpr uint32_t PHILOX_M1 = 0xCD9E8D57;
+constexpr uint32_t PHILOX_W0 = 0x9E3779B9;
+constexpr uint32_t PHILOX_W1 = 0xBB67AE85;
+constexpr int PHILOX_ROUNDS = 10;
+
+inline void mulhilo(uint32_t a, uint32_t b, uint32_t& hi, uint32_t& lo) {
+    uint64_t product = static_cast<uint64_t>(a) * b;
+    hi = static_cast<uint32_t>(product >> 32);
+    lo = static_cast<uint32_t>(product);
+}
+
+} // anonymous namespace
+
+RandomStream::RandomStream(uint64_t key, uint64_t streamId, uint32_t subStream)
+    : key_{static_cast<uint32_t>(key), static_cast<uint32_t>(key >> 32)},
+      counter_{0, subStream, static_cast<uint32_t>(streamId),
+               static_cast<uint32_t>(streamId >> 32)},
+      buffer_{},
+      index_(4) {
+}
+
+RandomStream RandomStream::derive(uint32_t seed, uint32_t cycle,
+                                  llvm::StringRef passName, llvm::StringRef entity) {
+    // xxHash64 is stable across hosts and runs, unlike std::hash
+    uint64_t passHash = llvm::xxHash64(passName);
+    uint64_t entityHash = llvm::xxHash64(entity);
+
+    uint64_t key = (passHash << 32) | seed;
+    return RandomStream(key, entityHash, cycle);
+}
+
+std::array<uint32_t, 4> RandomStream::philox(std::array<uint32_t, 4> counter,
+                                             std::array<uint32_t, 2> key) {
+    for (int round = 0; round < PHILOX_ROUNDS; ++round) {
+        uint32_t hi0, lo0, hi1, lo1;
+        mulhilo(PHILOX_M0, counter[0], hi0, lo0);
+        mulhilo(PHILOX_M1, counter[2], hi1, lo1);
+        counter = {hi1 ^ counter[1] ^ key[0], lo1, hi0 ^ counter[3] ^ key[1], lo0};
+        key[0] += PHILOX_W0;
+        key[1] += PHILOX_W1;
+    }
+    return counter;
+}
+
+void RandomStream::refill() {
+    buffer_ = philox(counter_, key_);
+    ++counter_[0];
+    index_ = 0;
+}
+
+uint32_t RandomStream::getUInt32() {
+    if (index_ >= buffer_.size()) {
+        refill();
+    }
+    return buffer_[index_++];
+}
+
+uint32_t RandomStream::getUInt32(uint32_t min, uint32_t max) {
+    if (min >= max) {
+        return min;
+    }
+
+    uint32_t range = max - min + 1;
+    if (range == 0) {
+        return getUInt32();  // Full 32-bit range
+    }
+
+    // Reject the low values that would bias the modulo
+    uint32_t threshold = (0u - range) % range;
+    uint32_t value;
+    do {
+        value = getUInt32();
+    } while (value < threshold);
+
+    return min + value % range;
+}
+
+uint64_t RandomStream::getUInt64() {
+    uint64_t high = static_cast<uint64_t>(getUInt32()) << 32;
+    uint64_t low = static_cast<uint64_t>(getUInt32());
+    return high | low;
+}
+
+bool RandomStream::getBool(uint32_t probability) {
+    return getUInt32(0, 99) < probability;
+}
+
+double RandomStream::getDouble() {
+    // 53 random bits scaled into [0, 1)
+    return static_cast<double>(getUInt64() >> 11) * (1.0 / 9007199254740992.0);
+}
+
+} // namespace obfuscator
@@ -0,0 +1,203 @@
+/**
+ * @file ResultCache.cpp
+ * @brief Implementation of ResultCache
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "ResultCache.h"
+#include "Logger.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Chrono.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/raw_ostream.h"
+#include <algorithm>
+#include <vector>
+
+#ifndef PHANTRON_VERSION
+#define PHANTRON_VERSION "unknown"
+#endif
+
+namespace obfuscator {
+
+namespace {
+
+// Bump when the entry layout, key derivation or pass output changes
+constexpr const char* CACHE_FORMAT = "phantron-result-cache-3";
+
+constexpr size_t KEY_LENGTH = 64;  // Hex SHA-256
+
+// Evict down to the bound minus this share of it, so a full cache is not
+// rescanned on every store
+constexpr uint64_t HEADROOM_DIVISOR = 10;
+
+bool isEntryName(llvm::StringRef name) {
+    return name.size() == KEY_LENGTH &&
+           llvm::all_of(name, [](char c) { return llvm::isHexDigit(c); });
+}
+
+struct CacheEntry {
+    std::string path;
+    uint64_t size;
+    llvm::sys::TimePoint<> lastUsed;
+};
+
+std::vector<CacheEntry> listEntries(const std::string& directory) {
+    std::vector<CacheEntry> entries;
+    std::error_code ec;
+    for (llvm::sys::fs::directory_iterator it(directory, ec), end; it != end && !ec;
+         it.increment(ec)) {
+        if (!isEntryName(llvm::sys::path::filename(it->path()))) {
+            continue;  // In-flight temporaries and foreign files
+        }
+        llvm::sys::fs::file_status status;
+        if (llvm::sys::fs::status(it->path(), status) ||
+            status.type() != llvm::sys::fs::file_type::regular_file) {
+            continue;
+        }
+        entries.push_back({it->path(), status.getSize(), status.getLastModificationTime()});
+    }
+    return entries;
+}
+
+} // anonymous namespace
+
+ResultCache::ResultCache(const std::string& directory, uint64_t maxSize)
+    : directory_(directory), maxSize_(maxSize), knownSize_(0), sizeKnown_(false) {
+    if (std::error_code ec = llvm::sys::fs::create_directories(directory_)) {
+        Logger::getInstance().warning("Cannot create cache directory " + directory_ + ": " +
+                                      ec.message());
+    }
+}
+
+std::string ResultCache::computeKey(llvm::StringRef input, const ObfuscationConfig& config,
+                                    llvm::StringRef kind) {
+    // Length-prefix every field so no two inputs serialize alike
+    std::string fingerprint = config.fingerprint();
+    std::string header;
+    llvm::raw_string_ostream stream(header);
+    for (llvm::StringRef field : {llvm::StringRef(CACHE_FORMAT), llvm::StringRef(PHANTRON_VERSION),
+                                  kind, llvm::StringRef(fingerprint)}) {
+        stream << field.size() << ':' << field << ';';
+    }
+    stream << input.size() << ':';
+    stream.flush();
+
+    llvm::SHA256 hasher;
+    hasher.update(header);
+    hasher.update(input);
+    return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+std::unique_ptr<llvm::MemoryBuffer> ResultCache::lookup(const std::string& key) {
+    std::string path = entryPath(key);
+
+    auto buffer = llvm::MemoryBuffer::getFile(path, /*IsText=*/false,
+                                              /*RequiresNullTerminator=*/false);
+    if (!buffer) {
+        return nullptr;
+    }
+
+    // Recency is the modification time, so eviction needs no index file
+    int fd;
+    if (!llvm::sys::fs::openFileForWrite(path, fd, llvm::sys::fs::CD_OpenExisting,
+                                         llvm::sys::fs::OF_Append)) {
+        llvm::sys::fs::setLastAccessAndModificationTime(fd, std::chrono::system_clock::now());
+        llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+    }
+
+    Logger::getInstance().debug("Result cache hit: " + key.substr(0, 16));
+    return std::move(*buffer);
+}
+
+bool ResultCache::store(const std::string& key, llvm::StringRef data) {
+    // Write a private temporary, then publish it atomically
+    llvm::SmallString<256> model(directory_);
+    llvm::sys::path::append(model, key.substr(0, 16) + ".%%%%%%.tmp");
+
+    int fd;
+    llvm::SmallString<256> tempPath;
+    if (std::error_code ec = llvm::sys::fs::createUniqueFile(model, fd, tempPath)) {
+        Logger::getInstance().warning("Cannot write cache entry: " + ec.message());
+        return false;
+    }
+
+    {
+        llvm::raw_fd_ostream out(fd, /*shouldClose=*/true);
+        out << data;
+        out.close();
+        if (out.has_error()) {
+            out.clear_error();
+            llvm::sys::fs::remove(tempPath);
+            Logger::getInstance().warning("Cannot write cache entry " + key.substr(0, 16));
+            return false;
+        }
+    }
+
+    if (std::error_code ec = llvm::sys::fs::rename(tempPath, entryPath(key))) {
+        llvm::sys::fs::remove(tempPath);
+        Logger::getInstance().warning("Cannot publish cache entry: " + ec.message());
+        return false;
+    }
+
+    // Other processes write too, so the running total is only an estimate;
+    // eviction rescans the directory before removing anything
+    knownSize_ += data.size();
+    if (!sizeKnown_ || knownSize_ > maxSize_) {
+        evict();
+    }
+    return true;
+}
+
+void ResultCache::evict() {
+    std::vector<CacheEntry> entries = listEntries(directory_);
+
+    uint64_t total = 0;
+    for (const auto& entry : entries) {
+        total += entry.size;
+    }
+    sizeKnown_ = true;
+    knownSize_ = total;
+    if (total <= maxSize_) {
+        return;
+    }
+    uint64_t target = maxSize_ - maxSize_ / HEADROOM_DIVISOR;
+
+    std::sort(entries.begin(), entries.end(), [](const CacheEntry& a, const CacheEntry& b) {
+        return a.lastUsed < b.lastUsed;
+    });
+
+    size_t removed = 0;
+    for (const auto& entry : entries) {
+        if (total <= target) {
+            break;
+        }
+        // Another build may have evicted it already; either way it is gone
+        llvm::sys::fs::remove(entry.path);
+        total -= entry.size;
+        ++removed;
+    }
+    knownSize_ = total;
+
+    Logger::getInstance().debug("Result cache evicted " + std::to_string(removed) + " entries");
+}
+
+uint64_t ResultCache::getSize() const {
+    uint64_t total = 0;
+    for (const auto& entry : listEntries(directory_)) {
+        total += entry.size;
+    }
+    return total;
+}
+
+std::string ResultCache::entryPath(const std::string& key) const {
+    llvm::SmallString<256> path(directory_);
+    llvm::sys::path::append(path, key);
+    return std::string(path.str());
+}
+
+} // namespace obfuscator
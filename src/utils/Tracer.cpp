@@ -0,0 +1,138 @@
+/**
+ * @file Tracer.cpp
+ * @brief Implementation of Tracer
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "Tracer.h"
+#include "Logger.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace obfuscator {
+
+Tracer::Tracer()
+    : enabled_(false), functions_(false), epoch_(Clock::now()) {
+}
+
+Tracer& Tracer::getInstance() {
+    static Tracer instance;
+    return instance;
+}
+
+void Tracer::start(bool functions) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    events_.clear();
+    functions_ = functions;
+    epoch_ = Clock::now();
+    enabled_.store(true, std::memory_order_relaxed);
+}
+
+void Tracer::stop() {
+    enabled_.store(false, std::memory_order_relaxed);
+}
+
+void Tracer::record(const char* category, std::string name, Clock::time_point begin,
+                    Clock::time_point end, llvm::json::Object args) {
+    Event event{category, std::move(name), 0,
+                std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count(),
+                llvm::get_threadid(), std::move(args)};
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    event.beginNs = std::chrono::duration_cast<std::chrono::nanoseconds>(begin - epoch_).count();
+    events_.push_back(std::move(event));
+}
+
+bool Tracer::write(const std::string& path) const {
+    std::error_code ec;
+    llvm::raw_fd_ostream out(path, ec, llvm::sys::fs::OF_Text);
+    if (ec) {
+        Logger::getInstance().error("Cannot write trace " + path + ": " + ec.message());
+        return false;
+    }
+
+    auto pid = static_cast<int64_t>(llvm::sys::Process::getProcessId());
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    llvm::json::OStream json(out);
+    json.object([&] {
+        json.attribute("displayTimeUnit", "ns");
+        json.attributeArray("traceEvents", [&] {
+            json.object([&] {
+                json.attribute("name", "process_name");
+                json.attribute("ph", "M");
+                json.attribute("pid", pid);
+                json.attribute("tid", 0);
+                json.attributeObject("args", [&] { json.attribute("name", "phantron"); });
+            });
+
+            // Trace-event timestamps are microseconds; fractions keep the nanoseconds
+            for (const auto& event : events_) {
+                json.object([&] {
+                    json.attribute("name", event.name);
+                    json.attribute("cat", event.category);
+                    json.attribute("ph", "X");
+                    json.attribute("ts", event.beginNs / 1000.0);
+                    json.attribute("dur", event.durationNs / 1000.0);
+                    json.attribute("pid", pid);
+                    json.attribute("tid", static_cast<int64_t>(event.threadId));
+                    if (!event.args.empty()) {
+                        json.attribute("args", llvm::json::Object(event.args));
+                    }
+                });
+            }
+        });
+    });
+    out << "\n";
+    out.close();
+
+    if (out.has_error()) {
+        out.clear_error();
+        Logger::getInstance().error("Cannot write trace " + path);
+        return false;
+    }
+    Logger::getInstance().info("Trace with " + std::to_string(events_.size()) +
+                               " spans written to " + path);
+    return true;
+}
+
+size_t Tracer::getEventCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return events_.size();
+}
+
+TraceSpan::TraceSpan(const char* category, llvm::StringRef name)
+    : active_(Tracer::getInstance().isEnabled()), category_(category) {
+    if (active_) {
+        name_ = name.str();
+        begin_ = Tracer::Clock::now();
+    }
+}
+
+TraceSpan::~TraceSpan() {
+    if (active_) {
+        Tracer::getInstance().record(category_, std::move(name_), begin_, Tracer::Clock::now(),
+                                     std::move(args_));
+    }
+}
+
+void TraceSpan::addArgument(llvm::StringRef key, llvm::json::Value value) {
+    if (active_) {
+        args_[key] = std::move(value);
+    }
+}
+
+TraceSession::TraceSession(const std::string& path, bool functions)
+    : path_(path) {
+    Tracer::getInstance().start(functions);
+}
+
+TraceSession::~TraceSession() {
+    Tracer::getInstance().stop();
+    Tracer::getInstance().write(path_);
+}
+
+} // namespace obfuscator
@@ -0,0 +1,132 @@
+/**
+ * @file WorkStealingPool.cpp
+ * @brief Implementation of WorkStealingPool
+ * @version 2.0.0
+ * @date 2025-10-13
+ */
+
+#include "WorkStealingPool.h"
+#include <algorithm>
+
+namespace obfuscator {
+
+WorkStealingPool::WorkStealingPool(uint32_t threadCount)
+    : body_(nullptr), pending_(0), generation_(0), stopping_(false) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    for (uint32_t i = 0; i < threadCount; ++i) {
+        queues_.push_back(std::make_unique<WorkQueue>());
+    }
+
+    // Worker 0 is whichever thread calls parallelFor
+    for (uint32_t i = 1; i < threadCount; ++i) {
+        threads_.emplace_back(&WorkStealingPool::workerLoop, this, i);
+    }
+}
+
+WorkStealingPool::~WorkStealingPool() {
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        stopping_ = true;
+    }
+    wakeWorkers_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+void WorkStealingPool::parallelFor(size_t count, const std::function<void(size_t)>& body) {
+    if (count == 0) {
+        return;
+    }
+
+    // Give each worker a contiguous block of items
+    size_t workers = queues_.size();
+    {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        body_ = &body;
+        pending_ = count;
+        for (size_t w = 0; w < workers; ++w) {
+            size_t begin = count * w / workers;
+            size_t end = count * (w + 1) / workers;
+            std::lock_guard<std::mutex> queueLock(queues_[w]->mutex);
+            for (size_t i = begin; i < end; ++i) {
+                queues_[w]->items.push_back(i);
+            }
+        }
+        ++generation_;
+    }
+    wakeWorkers_.notify_all();
+
+    while (runOne(0)) {
+    }
+
+    // Wait for items other workers are still running
+    std::unique_lock<std::mutex> lock(stateMutex_);
+    allDone_.wait(lock, [this]() { return pending_ == 0; });
+    body_ = nullptr;
+}
+
+void WorkStealingPool::workerLoop(uint32_t worker) {
+    uint64_t seenGeneration = 0;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(stateMutex_);
+            wakeWorkers_.wait(lock, [&]() {
+                return stopping_ || generation_ != seenGeneration;
+            });
+            if (stopping_) {
+                return;
+            }
+            seenGeneration = generation_;
+        }
+
+        while (runOne(worker)) {
+        }
+    }
+}
+
+bool WorkStealingPool::runOne(uint32_t worker) {
+    size_t item;
+    if (!popLocal(worker, item) && !steal(worker, item)) {
+        return false;
+    }
+
+    (*body_)(item);
+
+    if (pending_.fetch_sub(1) == 1) {
+        std::lock_guard<std::mutex> lock(stateMutex_);
+        allDone_.notify_all();
+    }
+    return true;
+}
+
+bool WorkStealingPool::popLocal(uint32_t worker, size_t& item) {
+    WorkQueue& queue = *queues_[worker];
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.items.empty()) {
+        return false;
+    }
+    item = queue.items.back();
+    queue.items.pop_back();
+    return true;
+}
+
+bool WorkStealingPool::steal(uint32_t worker, size_t& item) {
+    size_t workers = queues_.size();
+    for (size_t offset = 1; offset < workers; ++offset) {
+        WorkQueue& victim = *queues_[(worker + offset) % workers];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.items.empty()) {
+            item = victim.items.front();
+            victim.items.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace obfuscator
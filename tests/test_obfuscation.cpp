@@ -5,11 +5,59 @@
  * @date 2025-10-09
  */
 
+// The checks are asserts, which must run in release builds too
+#undef NDEBUG
+
+#include <algorithm>
 #include <iostream>
 #include <cassert>
+#include <cstdlib>
+#include <fstream>
+#include <chrono>
+#include <thread>
 #include "ObfuscationConfig.h"
 #include "MetricsCollector.h"
 #include "RandomGenerator.h"
+#include "RandomStream.h"
+#include "ResultCache.h"
+#include "FunctionCache.h"
+#include "CodeGenerator.h"
+#include "LowMemoryPipeline.h"
+#include "ManifestRunner.h"
+#include "ProjectBuilder.h"
+#include "MemoryFile.h"
+#include "BoundedQueue.h"
+#include "Tracer.h"
+#include "PerfCounters.h"
+#include "MemoryTracker.h"
+#include "PassScheduler.h"
+#include "PassManager.h"
+#include "ParallelPassRunner.h"
+#include "PassAdaptors.h"
+#include "PhantronPass.h"
+#include "BlockHotness.h"
+#include "FunctionPolicy.h"
+#include "ServerProtocol.h"
+#include "CLIParser.h"
+#include "passes/MBAObfuscation.h"
+#include "passes/ControlFlowFlattening.h"
+#include "ConfigParser.h"
+#include "FileUtils.h"
+#include "llvm/IR/Dominators.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
+#include "llvm/IR/ValueSymbolTable.h"
+#include "llvm/AsmParser/Parser.h"
+#include "llvm/Bitcode/BitcodeReader.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Verifier.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/Program.h"
+#include <sys/socket.h>
+#include <unistd.h>
 
 using namespace obfuscator;
 
@@ -20,10 +68,10 @@ void testObfuscationConfig() {
     assert(config.validate());
     
     config.applyPreset(ObfuscationLevel::LOW);
-    assert(config.obfuscationCycles == 1);
+    assert(config.obfuscationCycles == 2);
     
     config.applyPreset(ObfuscationLevel::HIGH);
-    assert(config.obfuscationCycles == 5);
+    assert(config.obfuscationCycles == 6);
     
     std::cout << "✓\n";
 }
@@ -38,7 +86,7 @@ void testMetricsCollector() {
     assert(metrics.getMetrics().obfuscatedFileSize == 1500);
     
     metrics.incrementTransformations("TestPass", 10);
-    assert(metrics.getMetrics().passTransformations["TestPass"] == 10);
+    assert(metrics.getMetrics().passTransformations.at("TestPass") == 10);
     
     std::cout << "✓\n";
 }
@@ -62,6 +110,1446 @@ void testRandomGenerator() {
     std::cout << "✓\n";
 }
 
+void testRandomStream() {
+    std::cout << "Testing RandomStream... ";
+    
+    // Philox4x32-10 known-answer vectors (Random123)
+    auto zero = RandomStream::philox({0, 0, 0, 0}, {0, 0});
+    assert(zero[0] == 0x6627e8d5 && zero[1] == 0xe169c58d);
+    assert(zero[2] == 0xbc57ac4c && zero[3] == 0x9b00dbd8);
+    auto ones = RandomStream::philox({0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff},
+                                     {0xffffffff, 0xffffffff});
+    assert(ones[0] == 0x408f276d && ones[1] == 0x41c83b0e);
+    assert(ones[2] == 0xa20bc7c6 && ones[3] == 0x6d5451fd);
+    
+    // Same tuple, same sequence; draws elsewhere do not interfere
+    RandomStream a = RandomStream::derive(42, 1, "MBAObfuscation", "main");
+    RandomStream other = RandomStream::derive(42, 1, "MBAObfuscation", "helper");
+    RandomStream b = RandomStream::derive(42, 1, "MBAObfuscation", "main");
+    for (int i = 0; i < 16; ++i) {
+        other.getUInt32();
+        assert(a.getUInt32() == b.getUInt32());
+    }
+    
+    // Any component of the tuple changes the stream
+    uint32_t base = RandomStream::derive(42, 1, "MBAObfuscation", "main").getUInt32();
+    assert(base != RandomStream::derive(43, 1, "MBAObfuscation", "main").getUInt32());
+    assert(base != RandomStream::derive(42, 2, "MBAObfuscation", "main").getUInt32());
+    assert(base != RandomStream::derive(42, 1, "DeadCodeInjection", "main").getUInt32());
+    assert(base != RandomStream::derive(42, 1, "MBAObfuscation", "helper").getUInt32());
+    
+    for (int i = 0; i < 1000; ++i) {
+        uint32_t ranged = a.getUInt32(5, 9);
+        assert(ranged >= 5 && ranged <= 9);
+        double d = a.getDouble();
+        assert(d >= 0.0 && d < 1.0);
+    }
+    
+    std::cout << "✓\n";
+}
+
+void testResultCache() {
+    std::cout << "Testing ResultCache... ";
+    
+    llvm::SmallString<128> directory;
+    llvm::sys::fs::createUniqueDirectory("phantron-cache-test", directory);
+    std::string dir(directory.str());
+    
+    // Every code-affecting input changes the key; reporting settings do not
+    ObfuscationConfig config;
+    config.seed = 1;
+    std::string key = ResultCache::computeKey("bitcode", config, "object");
+    assert(key.size() == 64);
+    assert(key == ResultCache::computeKey("bitcode", config, "object"));
+    assert(key != ResultCache::computeKey("bitcodE", config, "object"));
+    assert(key != ResultCache::computeKey("bitcode", config, "binary/c"));
+    ObfuscationConfig reseeded = config;
+    reseeded.seed = 2;
+    assert(key != ResultCache::computeKey("bitcode", reseeded, "object"));
+    ObfuscationConfig reported = config;
+    reported.verbose = true;
+    reported.reportPath = "elsewhere";
+    assert(key == ResultCache::computeKey("bitcode", reported, "object"));
+    
+    // Room for two 100-byte entries: the least recently used one goes
+    ResultCache cache(dir, 250);
+    std::string a = ResultCache::computeKey("a", config, "object");
+    std::string b = ResultCache::computeKey("b", config, "object");
+    std::string c = ResultCache::computeKey("c", config, "object");
+    assert(!cache.lookup(a));
+    assert(cache.store(a, std::string(100, 'a')));
+    assert(cache.store(b, std::string(100, 'b')));
+    
+    // Make a older than b, then touch it again through a hit
+    int fd;
+    llvm::sys::fs::openFileForWrite(dir + "/" + a, fd, llvm::sys::fs::CD_OpenExisting,
+                                    llvm::sys::fs::OF_Append);
+    llvm::sys::fs::setLastAccessAndModificationTime(
+        fd, std::chrono::system_clock::now() - std::chrono::hours(1));
+    llvm::sys::Process::SafelyCloseFileDescriptor(fd);
+    auto hit = cache.lookup(a);
+    assert(hit && hit->getBuffer() == std::string(100, 'a'));
+    
+    assert(cache.store(c, std::string(100, 'c')));
+    assert(cache.getSize() == 200);
+    assert(cache.lookup(a) && cache.lookup(c));
+    assert(!cache.lookup(b));
+    
+    // Without --seed every run gets a new seed and would miss
+    auto parses = [](std::vector<std::string> args) {
+        std::vector<char*> argv;
+        for (auto& arg : args) {
+            argv.push_back(&arg[0]);
+        }
+        CLIParser parser;
+        return parser.parse(static_cast<int>(argv.size()), argv.data());
+    };
+    assert(!parses({"phantron-llvm-obfuscator", "--cache-dir", dir, "in.c"}));
+    assert(parses({"phantron-llvm-obfuscator", "--cache-dir", dir, "--seed", "1", "in.c"}));
+
+    llvm::sys::fs::remove_directories(dir);
+    std::cout << "✓\n";
+}
+
+void testFunctionCache() {
+    std::cout << "Testing FunctionCache... ";
+    
+    llvm::SmallString<128> directory;
+    llvm::sys::fs::createUniqueDirectory("phantron-function-cache-test", directory);
+    std::string dir(directory.str());
+    
+    const char* source =
+        "define internal i32 @twice(i32 %x) {\n"
+        "  %y = add i32 %x, %x\n"
+        "  ret i32 %y\n"
+        "}\n"
+        "define i32 @entry(i32 %x) {\n"
+        "  %y = call i32 @twice(i32 %x)\n"
+        "  %z = mul i32 %y, 3\n"
+        "  ret i32 %z\n"
+        "}\n";
+    
+    ObfuscationConfig config;
+    config.incremental = true;
+    config.cacheDirectory = dir;
+    ResultCache storage(dir, config.cacheMaxSize);
+    llvm::LLVMContext context;
+    llvm::SMDiagnostic error;
+    
+    // Stand-in for the passes: tag every function they see
+    auto obfuscate = [](llvm::Module& module) {
+        for (auto& func : module) {
+            if (!func.isDeclaration()) {
+                func.addFnAttr("obfuscated");
+            }
+        }
+    };
+    
+    // Cold run: everything misses and is stored afterwards
+    auto first = llvm::parseAssemblyString(source, error, context);
+    FunctionCache cold(storage, config);
+    assert(cold.prepare(*first) == 0);
+    assert(cold.getMissCount() == 2);
+    obfuscate(*first);
+    assert(cold.finish(*first));
+    
+    // Warm run: hits are hidden from the passes and come back obfuscated
+    auto second = llvm::parseAssemblyString(source, error, context);
+    FunctionCache warm(storage, config);
+    assert(warm.prepare(*second) == 2);
+    assert(second->getFunction("twice")->isDeclaration());
+    obfuscate(*second);
+    assert(warm.finish(*second));
+    assert(!llvm::verifyModule(*second));
+    llvm::Function* twice = second->getFunction("twice");
+    assert(!twice->isDeclaration() && twice->hasInternalLinkage());
+    assert(twice->hasFnAttribute("obfuscated"));
+    assert(second->getFunction("entry")->hasFnAttribute("obfuscated"));
+    
+    // A changed function misses, its unchanged callee still hits
+    std::string changed(source);
+    changed.replace(changed.find("mul i32 %y, 3"), 13, "mul i32 %y, 5");
+    auto third = llvm::parseAssemblyString(changed, error, context);
+    FunctionCache partial(storage, config);
+    assert(partial.prepare(*third) == 1);
+    assert(!third->getFunction("entry")->isDeclaration());
+    assert(partial.finish(*third));
+    assert(!llvm::verifyModule(*third));
+    
+    // A different configuration never reuses bodies
+    ObfuscationConfig reseeded = config;
+    reseeded.seed = config.seed + 1;
+    FunctionCache other(storage, reseeded);
+    assert(other.computeKey(*first->getFunction("twice")) !=
+           cold.computeKey(*first->getFunction("twice")));
+    
+    llvm::sys::fs::remove_directories(dir);
+    std::cout << "✓\n";
+}
+
+void testCodegenPartitions() {
+    std::cout << "Testing codegen partitioning... ";
+    
+    // 40 functions of 251 instructions each
+    std::string source;
+    for (int i = 0; i < 40; ++i) {
+        source += "define i32 @f" + std::to_string(i) + "(i32 %x0) {\n";
+        for (int j = 0; j < 250; ++j) {
+            source += "  %x" + std::to_string(j + 1) + " = add i32 %x" + std::to_string(j) +
+                      ", " + std::to_string(i) + "\n";
+        }
+        source += "  ret i32 %x250\n}\n";
+    }
+    
+    llvm::LLVMContext context;
+    llvm::SMDiagnostic error;
+    auto module = llvm::parseAssemblyString(source, error, context);
+    
+    // About 10k instructions: worth two partitions at most, never more than asked
+    assert(CodeGenerator::getPartitionCount(*module, 1) == 1);
+    assert(CodeGenerator::getPartitionCount(*module, 2) == 2);
+    assert(CodeGenerator::getPartitionCount(*module, 8) == 2);
+    
+    auto small = llvm::parseAssemblyString("define void @f() {\n  ret void\n}\n", error, context);
+    assert(CodeGenerator::getPartitionCount(*small, 8) == 1);
+    
+    // Locals shared across partitions become hidden globals with a
+    // module-specific suffix, defined once and referenced elsewhere
+    std::string shared =
+        "@shared = internal global i32 0\n"
+        "define internal i32 @helper(i32 %x) {\n"
+        "  %v = load i32, i32* @shared\n"
+        "  %y = add i32 %x, %v\n"
+        "  store i32 %y, i32* @shared\n"
+        "  ret i32 %y\n"
+        "}\n";
+    for (int i = 0; i < 8; ++i) {
+        shared += "define i32 @g" + std::to_string(i) + "(i32 %x) {\n"
+                  "  %y = call i32 @helper(i32 %x)\n"
+                  "  %z = mul i32 %y, " + std::to_string(i + 3) + "\n"
+                  "  ret i32 %z\n"
+                  "}\n";
+    }
+    auto split = llvm::parseAssemblyString(shared, error, context);
+    assert(split);
+    CodeGenerator generator;
+    std::vector<llvm::SmallVector<char, 0>> objects;
+    assert(generator.emitPartitions(*split, 2, objects));
+    assert(objects.size() == 2);
+    
+    llvm::GlobalVariable* promoted = nullptr;
+    for (auto& gv : split->globals()) {
+        promoted = &gv;
+    }
+    assert(promoted && promoted->getName().startswith("shared.llvm."));
+    assert(promoted->getName().size() == std::string("shared.llvm.").size() + 16);
+    assert(promoted->hasExternalLinkage() && promoted->hasHiddenVisibility());
+    llvm::Function* helper = nullptr;
+    for (auto& func : *split) {
+        if (func.getName().startswith("helper.llvm.")) {
+            helper = &func;
+        }
+    }
+    assert(helper && helper->hasHiddenVisibility());
+    
+    int definitions = 0;
+    int references = 0;
+    for (const auto& object : objects) {
+        auto file = llvm::object::ObjectFile::createObjectFile(
+            llvm::MemoryBufferRef(llvm::StringRef(object.data(), object.size()), "part.o"));
+        assert(file);
+        for (const auto& symbol : (*file)->symbols()) {
+            llvm::Expected<llvm::StringRef> name = symbol.getName();
+            llvm::Expected<uint32_t> flags = symbol.getFlags();
+            assert(name && flags);
+            if (*name != promoted->getName()) {
+                continue;
+            }
+            if (*flags & llvm::object::SymbolRef::SF_Undefined) {
+                ++references;
+            } else {
+                ++definitions;
+                assert(!(*flags & llvm::object::SymbolRef::SF_Global) ||
+                       (*flags & llvm::object::SymbolRef::SF_Hidden));
+            }
+        }
+    }
+    assert(definitions == 1 && references == 1);
+    
+    std::cout << "✓\n";
+}
+
+void testObjectConstructors() {
+    std::cout << "Testing object constructor sections... ";
+    
+    // Like the decrypt constructor of StringEncryption
+    llvm::LLVMContext context;
+    llvm::SMDiagnostic error;
+    auto module = llvm::parseAssemblyString(
+        "@llvm.global_ctors = appending global [1 x { i32, void ()*, i8* }] "
+        "[{ i32, void ()*, i8* } { i32 65535, void ()* @init, i8* null }]\n"
+        "define internal void @init() {\n  ret void\n}\n",
+        error, context);
+    assert(module);
+    
+    CodeGenerator generator;
+    llvm::SmallVector<char, 0> object;
+    assert(generator.emitObject(*module, object));
+    
+    // Same as llc -filetype=obj: .init_array, no .ctors
+    auto file = llvm::object::ObjectFile::createObjectFile(
+        llvm::MemoryBufferRef(llvm::StringRef(object.data(), object.size()), "ctors.o"));
+    assert(file);
+    if (!(*file)->isELF()) {
+        std::cout << "skipped (not ELF)\n";
+        return;
+    }
+    bool hasInitArray = false;
+    bool hasCtors = false;
+    for (const auto& section : (*file)->sections()) {
+        llvm::Expected<llvm::StringRef> name = section.getName();
+        assert(name);
+        hasInitArray |= name->startswith(".init_array");
+        hasCtors |= name->contains(".ctors");
+    }
+    assert(hasInitArray && !hasCtors);
+    
+    std::cout << "✓\n";
+}
+
+void testLowMemoryPipeline() {
+    std::cout << "Testing low-memory pipeline... ";
+    
+    ObfuscationConfig config;
+    config.lowMemory = true;
+    assert(config.validate());
+    config.batchFunctions = 0;
+    assert(!config.validate());
+    
+    llvm::LLVMContext context;
+    llvm::SMDiagnostic error;
+    auto plain = llvm::parseAssemblyString(
+        "define i32 @f(i32 %x) {\n  ret i32 %x\n}\n", error, context);
+    assert(LowMemoryPipeline::canRun(*plain));
+    
+    // ifuncs pin their resolver to the same object
+    auto ifunc = llvm::parseAssemblyString(
+        "@g = ifunc i32 (i32), i32 (i32)* ()* @resolve\n"
+        "define i32 (i32)* @resolve() {\n  ret i32 (i32)* null\n}\n", error, context);
+    assert(ifunc && !LowMemoryPipeline::canRun(*ifunc));
+    
+    // Seven functions in batches of three, loaded lazily from bitcode
+    std::string source = "@total = internal global i32 0\n";
+    for (int i = 0; i < 7; ++i) {
+        std::string n = std::to_string(i);
+        source += "define i32 @f" + n + "(i32 %x) {\n"
+                  "  %t = load i32, i32* @total\n"
+                  "  %y = add i32 %x, %t\n"
+                  "  %z = mul i32 %y, " + std::to_string(i + 2) + "\n"
+                  "  store i32 %z, i32* @total\n"
+                  "  ret i32 %z\n"
+                  "}\n";
+    }
+    llvm::SmallVector<char, 0> bitcode;
+    {
+        auto whole = llvm::parseAssemblyString(source, error, context);
+        assert(whole);
+        llvm::raw_svector_ostream stream(bitcode);
+        llvm::WriteBitcodeToFile(*whole, stream);
+    }
+    auto lazy = llvm::getLazyBitcodeModule(
+        llvm::MemoryBufferRef(llvm::StringRef(bitcode.data(), bitcode.size()), "lazy"), context);
+    assert(lazy && (*lazy)->getFunction("f6")->isMaterializable());
+    
+    config.applyPreset(ObfuscationLevel::LOW);
+    config.seed = 7;
+    config.batchFunctions = 3;
+    config.enableStringEncryption = false;
+    PassManager passManager(config);
+    Linker linker;
+    LowMemoryPipeline pipeline(config, passManager, linker);
+    MetricsCollector metrics;
+    llvm::SmallVector<char, 0> combined;
+    bool linked = pipeline.run(**lazy, metrics, combined);
+    
+    // Every body was written to a batch object and dropped from the module
+    for (int i = 0; i < 7; ++i) {
+        llvm::Function* func = (*lazy)->getFunction("f" + std::to_string(i));
+        assert(func && func->isDeclaration() && !func->isMaterializable());
+    }
+    assert(metrics.getMetrics().originalFunctionCount == 7);
+    
+    // Combining the batches needs lld built in or a clang driver
+    if (!Linker::isInProcessAvailable() && !llvm::sys::findProgramByName("clang")) {
+        std::cout << "skipped combining (no linker) ";
+    } else {
+        assert(linked);
+        auto file = llvm::object::ObjectFile::createObjectFile(
+            llvm::MemoryBufferRef(llvm::StringRef(combined.data(), combined.size()), "lm.o"));
+        assert(file);
+        int defined = 0;
+        for (const auto& symbol : (*file)->symbols()) {
+            llvm::Expected<llvm::StringRef> name = symbol.getName();
+            llvm::Expected<uint32_t> flags = symbol.getFlags();
+            assert(name && flags);
+            if (name->size() == 2 && name->startswith("f") &&
+                !(*flags & llvm::object::SymbolRef::SF_Undefined)) {
+                ++defined;
+            }
+        }
+        assert(defined == 7);
+    }
+    
+    std::cout << "✓\n";
+}
+
+void testMemoryFile() {
+    std::cout << "Testing MemoryFile... ";
+    
+    // Bytes written through the object come back through the path and
+    // the other way round, NULs and all
+    MemoryFile file("phantron-test");
+    assert(file.isValid() && !file.getPath().empty());
+    std::string data("object\0bytes\n", 13);
+    assert(file.write(data));
+    {
+        std::ifstream in(file.getPath(), std::ios::binary);
+        std::string read((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        assert(read == data);
+    }
+    {
+        std::ofstream out(file.getPath(), std::ios::binary | std::ios::trunc);
+        out << "from a tool";
+    }
+    auto buffer = file.read();
+    assert(buffer && buffer->getBuffer() == "from a tool");
+    
+    // A shorter write replaces the contents
+    assert(file.write("x"));
+    buffer = file.read();
+    assert(buffer && buffer->getBuffer() == "x");
+    
+    std::cout << "✓\n";
+}
+
+void testProjectBuilder() {
+    std::cout << "Testing parallel project builds... ";
+    
+    ObfuscationConfig config;
+    config.jobs = 4;
+    assert(ProjectBuilder(config).getWorkerCount(2) == 2);
+    assert(ProjectBuilder(config).getWorkerCount(10) == 4);
+    
+    // Sources go through the clang driver
+    if (!llvm::sys::findProgramByName("clang")) {
+        std::cout << "skipped (no clang)\n";
+        return;
+    }
+    
+    llvm::SmallString<128> directory;
+    llvm::sys::fs::createUniqueDirectory("phantron-project-test", directory);
+    std::string dir(directory.str());
+    std::vector<std::string> inputs;
+    std::string main = "define i32 @main() {\n  %s0 = add i32 0, 0\n";
+    for (int i = 0; i < 4; ++i) {
+        std::string n = std::to_string(i);
+        inputs.push_back(dir + "/unit" + n + ".ll");
+        std::ofstream(inputs.back()) <<
+            "@counter = internal global i32 0\n"
+            "@.str = private unnamed_addr constant [6 x i8] c\"unit" + n + "\\00\"\n"
+            "declare i32 @puts(i8*)\n"
+            "define internal i32 @helper(i32 %x) {\n"
+            "  %a = mul i32 %x, " + std::to_string(i + 3) + "\n"
+            "  %b = xor i32 %a, 1234\n"
+            "  %old = load i32, i32* @counter\n"
+            "  %new = add i32 %old, %b\n"
+            "  store i32 %new, i32* @counter\n"
+            "  ret i32 %b\n"
+            "}\n"
+            "define i32 @unit" + n + "(i32 %n) {\n"
+            "entry:\n"
+            "  %p = call i32 @puts(i8* getelementptr ([6 x i8], [6 x i8]* @.str, i64 0, i64 0))\n"
+            "  br label %loop\n"
+            "loop:\n"
+            "  %i = phi i32 [ 0, %entry ], [ %next, %loop ]\n"
+            "  %acc = phi i32 [ " + n + ", %entry ], [ %m, %loop ]\n"
+            "  %h = call i32 @helper(i32 %acc)\n"
+            "  %m = xor i32 %h, %i\n"
+            "  %next = add i32 %i, 1\n"
+            "  %done = icmp sge i32 %next, %n\n"
+            "  br i1 %done, label %exit, label %loop\n"
+            "exit:\n"
+            "  ret i32 %m\n"
+            "}\n";
+        main = "declare i32 @unit" + n + "(i32)\n" + main +
+               "  %r" + n + " = call i32 @unit" + n + "(i32 " + n + ")\n"
+               "  %s" + std::to_string(i + 1) + " = add i32 %s" + n + ", %r" + n + "\n";
+    }
+    inputs.push_back(dir + "/main.ll");
+    std::ofstream(inputs.back()) << main + "  ret i32 %s4\n}\n";
+    
+    // The same seed gives the same objects, in input order, whichever
+    // worker built them and however they reach the linker
+    auto build = [&](uint32_t jobs, bool inMemory, uint32_t seed) {
+        ObfuscationConfig project;
+        project.applyPreset(ObfuscationLevel::MEDIUM);
+        project.seed = seed;
+        project.jobs = jobs;
+        project.inMemoryPipeline = inMemory;
+        project.generateMetrics = false;
+        std::string output = dir + "/bin" + std::to_string(jobs) + (inMemory ? "m" : "") +
+                             std::to_string(seed);
+        assert(ProjectBuilder(project).build(inputs, output));
+        auto binary = llvm::MemoryBuffer::getFile(output);
+        assert(binary);
+        return (*binary)->getBuffer().str();
+    };
+    std::string serial = build(1, false, 11);
+    assert(!serial.empty());
+    assert(build(4, false, 11) == serial);
+    assert(build(4, true, 11) == serial);
+    assert(build(4, false, 12) != serial);
+    
+    llvm::sys::fs::remove_directories(dir);
+    std::cout << "✓\n";
+}
+
+void testManifest() {
+    std::cout << "Testing manifest parsing... ";
+    
+    llvm::SmallString<128> path;
+    llvm::sys::fs::createTemporaryFile("phantron-manifest", "txt", path);
+    {
+        std::ofstream out(path.str().str());
+        out << "# comment\n\n"
+            << "a.c a.out\n"
+            << "  my dir/b.c\tmy dir/b\n"
+            << "c.cpp\n";
+    }
+    
+    std::vector<ManifestEntry> entries;
+    assert(ManifestRunner::parseManifest(path.str().str(), entries));
+    assert(entries.size() == 3);
+    assert(entries[0].inputFile == "a.c" && entries[0].outputFile == "a.out");
+    assert(entries[1].inputFile == "my dir/b.c" && entries[1].outputFile == "my dir/b");
+    assert(entries[2].inputFile == "c.cpp" && entries[2].outputFile == "c.cpp.obf");
+    llvm::sys::fs::remove(path);
+    
+    assert(!ManifestRunner::parseManifest(path.str().str(), entries));
+    
+    std::cout << "✓\n";
+}
+
+/**
+ * @brief Feed raw bytes to ServerMessage::read through a socket pair
+ */
+bool readServerMessage(const std::string& bytes, size_t maxSize, ServerMessage& message) {
+    int fds[2];
+    assert(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    assert(::write(fds[0], bytes.data(), bytes.size()) == static_cast<ssize_t>(bytes.size()));
+    ::close(fds[0]);
+    bool ok = message.read(fds[1], maxSize);
+    ::close(fds[1]);
+    return ok;
+}
+
+void testServerProtocol() {
+    std::cout << "Testing server protocol... ";
+    
+    // Round trip of binary values and repeated fields
+    std::string binary("a\nb\0c end 0\n", 13);
+    ServerMessage request;
+    request.add("request", "obfuscate");
+    request.add("arg", "-l");
+    request.add("arg", "low");
+    request.add("input-data", binary);
+    request.add("empty", "");
+    int fds[2];
+    assert(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    assert(request.write(fds[0]));
+    ::close(fds[0]);
+    ServerMessage received;
+    assert(received.read(fds[1], 1 << 20));
+    ::close(fds[1]);
+    assert(received.get("request") == "obfuscate");
+    assert(received.getAll("arg") == std::vector<std::string>({"-l", "low"}));
+    assert(received.get("input-data") == binary);
+    assert(received.has("empty") && received.get("empty").empty());
+    assert(!received.has("output"));
+    
+    ServerMessage message;
+    assert(readServerMessage("data 5\nhello\nend 0\n", 5, message));
+    assert(message.get("data") == "hello");
+    
+    // Truncated and over-long headers
+    assert(!readServerMessage("request 9", 100, message));
+    assert(!readServerMessage(std::string(300, 'a') + " 1\nx\nend 0\n", 100, message));
+    assert(!readServerMessage("request\n", 100, message));
+    assert(!readServerMessage("request x\n", 100, message));
+    
+    // Values beyond the size bound, alone or together
+    assert(!readServerMessage("data 11\nhello world\nend 0\n", 10, message));
+    assert(!readServerMessage("a 6\nhello!\nb 5\nworld\nend 0\n", 10, message));
+    
+    // A length that would wrap the running total
+    assert(!readServerMessage("request 9\nobfuscate\narg 18446744073709551611\n", 1 << 20,
+                              message));
+    assert(!readServerMessage("arg 99999999999999999999999\n", 1 << 20, message));
+    
+    // Value not followed by a newline, value cut short, no end field
+    assert(!readServerMessage("data 5\nhelloXend 0\n", 100, message));
+    assert(!readServerMessage("data 5\nhel", 100, message));
+    assert(!readServerMessage("data 5\nhello\n", 100, message));
+
+    // The deadline covers the whole message: a silent peer and a peer
+    // trickling one byte at a time both run out of it
+    assert(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    assert(!message.read(fds[1], 100, 50));
+    std::thread trickle([&fds] {
+        for (char c : std::string("data 5\nhello\nend 0\n")) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            if (::write(fds[0], &c, 1) != 1) {
+                break;
+            }
+        }
+    });
+    assert(!message.read(fds[1], 100, 100));
+    trickle.join();
+    ::close(fds[0]);
+    ::close(fds[1]);
+    assert(::socketpair(AF_UNIX, SOCK_STREAM, 0, fds) == 0);
+    assert(request.write(fds[0]));
+    assert(received.read(fds[1], 1 << 20, 1000));
+    assert(received.get("input-data") == binary);
+    ::close(fds[0]);
+    ::close(fds[1]);
+
+    // Bad numbers in client arguments are errors, not exceptions
+    for (const char* option : {"--protect-depth", "--seed", "--cycles", "--pipeline", "-l"}) {
+        std::vector<std::string> args = {"phantron-llvm-obfuscator", option, "abc", "in.c"};
+        std::vector<char*> argv;
+        for (auto& arg : args) {
+            argv.push_back(&arg[0]);
+        }
+        CLIParser parser;
+        assert(!parser.parse(static_cast<int>(argv.size()), argv.data()));
+    }
+    
+    std::cout << "✓\n";
+}
+
+void testBoundedQueue() {
+    std::cout << "Testing bounded queue... ";
+    
+    BoundedQueue<int> queue(2);
+    std::thread producer([&queue] {
+        for (int i = 0; i < 100; ++i) {
+            queue.push(i);
+        }
+        queue.close();
+    });
+    
+    int item = 0;
+    int expected = 0;
+    while (queue.pop(item)) {
+        assert(item == expected++);
+    }
+    producer.join();
+    assert(expected == 100);
+    assert(queue.getHighWatermark() <= 2);
+    assert(!queue.push(1));
+    
+    std::cout << "✓\n";
+}
+
+void testTracer() {
+    std::cout << "Testing tracer... ";
+    
+    // Off by default: spans cost nothing and record nothing
+    { TraceSpan span("pass", "ignored"); }
+    assert(Tracer::getInstance().getEventCount() == 0);
+    
+    Tracer::getInstance().start(false);
+    {
+        TraceSpan outer("stage", "outer");
+        TraceSpan inner("pass", "inner \"quoted\"");
+        inner.addArgument("function", std::string("main"));
+    }
+    Tracer::getInstance().stop();
+    { TraceSpan span("pass", "after stop"); }
+    assert(Tracer::getInstance().getEventCount() == 2);
+    
+    llvm::SmallString<128> path;
+    llvm::sys::fs::createTemporaryFile("phantron-trace", "json", path);
+    assert(Tracer::getInstance().write(path.str().str()));
+    std::ifstream in(path.str().str());
+    std::string trace((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    assert(trace.find("\"traceEvents\"") != std::string::npos);
+    assert(trace.find("\"ph\":\"X\"") != std::string::npos);
+    assert(trace.find("inner \\\"quoted\\\"") != std::string::npos);
+    llvm::sys::fs::remove(path);
+    
+    // Pass timings keep sub-millisecond runs and add up over cycles
+    MetricsCollector metrics;
+    metrics.recordTiming("pass", std::chrono::microseconds(300));
+    metrics.recordTiming("pass", std::chrono::microseconds(400));
+    assert(metrics.getMetrics().passTimings.at("pass") == std::chrono::microseconds(700));
+    
+    std::cout << "✓\n";
+}
+
+void testPerfCounters() {
+    std::cout << "Testing performance counters... ";
+    
+    PerfCounterValues before;
+    before.counts = {{100, 150, 5, 7}};
+    before.available = (1u << PerfCounterValues::CYCLES) | (1u << PerfCounterValues::INSTRUCTIONS);
+    PerfCounterValues after = before;
+    after.counts = {{300, 550, 9, 3}};
+    
+    PerfCounterValues delta = after - before;
+    assert(delta.counts[PerfCounterValues::CYCLES] == 200);
+    assert(delta.counts[PerfCounterValues::INSTRUCTIONS] == 400);
+    assert(delta.counts[PerfCounterValues::BRANCH_MISSES] == 0);  // Never negative
+    assert(delta.getIPC() == 2.0);
+    assert(!delta.has(PerfCounterValues::CACHE_MISSES));
+    
+    delta += delta;
+    assert(delta.counts[PerfCounterValues::CYCLES] == 400);
+    assert(PerfCounterValues().getIPC() == 0.0);
+    
+    // Readings without a PMU or permission are empty, not errors
+    PerfCounterValues reading = PerfCounters::forThread().read();
+    assert(PerfCounters::forThread().isAvailable() || reading.available == 0);
+    
+    std::cout << "✓\n";
+}
+
+void testMemoryTracker() {
+    std::cout << "Testing memory tracker... ";
+    
+    llvm::LLVMContext context;
+    llvm::SMDiagnostic error;
+    auto module = llvm::parseAssemblyString(
+        "@g = global i32 0\n"
+        "declare void @ext()\n"
+        "define i32 @f(i32 %x) {\n"
+        "entry:\n"
+        "  %c = icmp eq i32 %x, 0\n"
+        "  br i1 %c, label %a, label %b\n"
+        "a:\n"
+        "  ret i32 1\n"
+        "b:\n"
+        "  ret i32 %x\n"
+        "}\n", error, context);
+    assert(module);
+    
+    IRSize size = IRSize::measure(*module);
+    assert(size.functions == 1 && size.basicBlocks == 3 && size.instructions == 4);
+    assert(size.globals == 1);
+    IRSize delta = size - IRSize();
+    assert(delta.instructions == 4);
+    
+    // operator new is counted per thread
+    uint64_t before = MemoryTracker::getThreadAllocatedBytes();
+    auto block = std::make_unique<char[]>(4096);
+    assert(MemoryTracker::getThreadAllocatedBytes() - before >= 4096);
+    block.reset();
+    
+    assert(MemoryTracker::getResidentBytes() > 0);
+    assert(MemoryTracker::getPeakResidentBytes() >= MemoryTracker::getResidentBytes() ||
+           MemoryTracker::getPeakResidentBytes() == 0);
+    
+    std::cout << "✓\n";
+}
+
+/**
+ * @brief Pass that only declares traits, for scheduling tests
+ */
+class TraitPass : public ObfuscationPass {
+public:
+    TraitPass(const std::string& name, PassTraits traits, bool functionLocal = false)
+        : ObfuscationPass(name), traits_(traits), functionLocal_(functionLocal) {}
+    bool runOnModule(llvm::Module&, MetricsCollector&) override { return false; }
+    bool isFunctionLocal() const override { return functionLocal_; }
+    PassTraits getTraits() const override { return traits_; }
+
+private:
+    PassTraits traits_;
+    bool functionLocal_;
+};
+
+void testParallelPasses() {
+    std::cout << "Testing function-parallel passes... ";
+    
+    // Internal and linkonce helpers, shared globals and loops across shards
+    std::string source =
+        "@counter = internal global i32 0\n"
+        "@table = private constant [4 x i32] [i32 3, i32 5, i32 7, i32 11]\n"
+        "define internal i32 @mix(i32 %x, i32 %y) {\n"
+        "  %a = xor i32 %x, %y\n"
+        "  %b = mul i32 %a, 31\n"
+        "  %c = add i32 %b, 7\n"
+        "  ret i32 %c\n"
+        "}\n"
+        "define linkonce_odr i32 @pick(i32 %i) {\n"
+        "  %m = and i32 %i, 3\n"
+        "  %e = zext i32 %m to i64\n"
+        "  %p = getelementptr [4 x i32], [4 x i32]* @table, i64 0, i64 %e\n"
+        "  %v = load i32, i32* %p\n"
+        "  ret i32 %v\n"
+        "}\n";
+    for (int i = 0; i < 12; ++i) {
+        std::string n = std::to_string(i);
+        source +=
+            "define i32 @f" + n + "(i32 %n) {\n"
+            "entry:\n"
+            "  br label %loop\n"
+            "loop:\n"
+            "  %i = phi i32 [ 0, %entry ], [ %next, %loop ]\n"
+            "  %acc = phi i32 [ " + n + ", %entry ], [ %mixed, %loop ]\n"
+            "  %k = call i32 @pick(i32 %i)\n"
+            "  %mixed = call i32 @mix(i32 %acc, i32 %k)\n"
+            "  %next = add i32 %i, 1\n"
+            "  %done = icmp sge i32 %next, %n\n"
+            "  br i1 %done, label %exit, label %loop\n"
+            "exit:\n"
+            "  %old = load i32, i32* @counter\n"
+            "  %new = add i32 %old, %mixed\n"
+            "  store i32 %new, i32* @counter\n"
+            "  %r = sub i32 %new, " + std::to_string(i * 17 + 3) + "\n"
+            "  ret i32 %r\n"
+            "}\n";
+    }
+    
+    // Same seed, same IR, however many threads transform the shards
+    auto obfuscate = [&source](uint32_t passJobs) {
+        ObfuscationConfig config;
+        config.applyPreset(ObfuscationLevel::MEDIUM);
+        config.seed = 42;
+        config.obfuscationCycles = 2;
+        config.enableControlFlowFlattening = true;
+        config.enableStringEncryption = false;
+        config.enableCallGraphObfuscation = false;
+        config.enableAntiDebug = false;
+        config.enableAntiTamper = false;
+        config.passJobs = passJobs;
+        
+        llvm::LLVMContext context;
+        llvm::SMDiagnostic error;
+        auto module = llvm::parseAssemblyString(source, error, context);
+        assert(module && ParallelPassRunner::canShard(*module));
+        PassManager manager(config);
+        MetricsCollector metrics;
+        manager.resolvePolicies(*module);
+        for (uint32_t cycle = 0; cycle < config.obfuscationCycles; ++cycle) {
+            assert(manager.runPasses(*module, metrics, cycle));
+        }
+        assert(!llvm::verifyModule(*module, &llvm::errs()));
+        
+        std::string text;
+        llvm::raw_string_ostream os(text);
+        module->print(os, nullptr, /*ShouldPreserveUseListOrder=*/false);
+        return os.str();
+    };
+    std::string serial = obfuscate(1);
+    std::string parallel = obfuscate(4);
+    assert(serial == parallel);
+    assert(serial.find("@f11") != std::string::npos);
+    
+    std::cout << "✓\n";
+}
+
+void testPassScheduler() {
+    std::cout << "Testing pass scheduler... ";
+    
+    auto indexOf = [](const std::vector<std::string>& names, const std::string& name) {
+        return std::find(names.begin(), names.end(), name) - names.begin();
+    };
+    auto run = [](PassScheduler& scheduler, const std::vector<const ObfuscationPass*>& passes) {
+        std::vector<std::string> names;
+        for (size_t index : scheduler.schedule(passes)) {
+            names.push_back(passes[index]->getName());
+        }
+        return names;
+    };
+    
+    // A pass that destroys what another needs runs after it, whatever the
+    // registration order; a pass that rewrites what another adds runs first
+    PassTraits destroyer;
+    destroyer.required = IR_CONSTANT_OPERANDS;
+    destroyer.invalidated = IR_CONSTANT_OPERANDS;
+    PassTraits reader;
+    reader.required = IR_CONSTANT_OPERANDS;
+    PassTraits amplifier;
+    amplifier.required = IR_ARITHMETIC;
+    amplifier.produced = IR_ARITHMETIC;
+    amplifier.growth = 300;
+    PassTraits feeder;
+    feeder.produced = IR_ARITHMETIC;
+    
+    TraitPass destroy("destroy", destroyer), read("read", reader);
+    TraitPass amplify("amplify", amplifier), feed("feed", feeder);
+    PassScheduler scheduler;
+    auto names = run(scheduler, {&destroy, &feed, &read, &amplify});
+    assert(names.size() == 4);
+    assert(indexOf(names, "read") < indexOf(names, "destroy"));
+    assert(indexOf(names, "amplify") < indexOf(names, "feed"));
+    assert(!scheduler.hadConflict());
+    assert(!scheduler.getDecisions().empty());
+    assert(run(scheduler, {&destroy, &feed, &read, &amplify}) == names);
+    
+    // Properties the input lacks must be produced first
+    PassTraits helperUser;
+    helperUser.required = IR_RUNTIME_HELPERS;
+    PassTraits helperMaker;
+    helperMaker.produced = IR_RUNTIME_HELPERS;
+    TraitPass user("user", helperUser), maker("maker", helperMaker);
+    names = run(scheduler, {&user, &maker});
+    assert(names[0] == "maker" && names[1] == "user");
+    
+    // Unconstrained passes keep registration order, with function-local
+    // passes kept together; cycles fall back to registration order
+    TraitPass a("a", PassTraits(), true), b("b", PassTraits()), c("c", PassTraits(), true);
+    names = run(scheduler, {&a, &b, &c});
+    assert(names[0] == "a" && names[1] == "c" && names[2] == "b");
+    TraitPass destroy2("destroy2", destroyer);
+    names = run(scheduler, {&destroy, &destroy2});
+    assert(scheduler.hadConflict() && names[0] == "destroy" && names[1] == "destroy2");
+    
+    // The built-in passes: cache obfuscation reads the constant operands
+    // that constant obfuscation replaces, and the schedule is reported
+    ObfuscationConfig config;
+    config.enableInstructionSubstitution = true;
+    config.enableConstantObfuscation = true;
+    config.enableHardwareCacheObfuscation = true;
+    config.enableControlFlowFlattening = true;
+    config.passJobs = 1;
+    PassManager manager(config);
+    const auto& schedule = manager.getSchedule();
+    assert(schedule.size() == manager.getPassCount());
+    assert(indexOf(schedule, "HardwareCacheObfuscation") <
+           indexOf(schedule, "ConstantObfuscation"));
+    assert(indexOf(schedule, "MBAObfuscation") < indexOf(schedule, "GrammarMetamorphic"));
+    
+    std::cout << "✓\n";
+}
+
+/**
+ * @brief Function pass that records whether a dominator tree was cached
+ */
+class AnalysisProbePass : public FunctionObfuscationPass {
+public:
+    AnalysisProbePass(const std::string& name, bool changesCFG, std::vector<bool>& cached)
+        : FunctionObfuscationPass(name), changesCFG_(changesCFG), cached_(cached) {}
+
+    PassTraits getTraits() const override {
+        PassTraits traits;
+        traits.produced = changesCFG_ ? IR_BASIC_BLOCKS : IR_INSTRUCTIONS;
+        return traits;
+    }
+
+protected:
+    uint32_t runOnFunction(llvm::Function& func, llvm::FunctionAnalysisManager& analyses) override {
+        cached_.push_back(analyses.getCachedResult<llvm::DominatorTreeAnalysis>(func) != nullptr);
+        analyses.getResult<llvm::DominatorTreeAnalysis>(func);
+        return 1;
+    }
+
+private:
+    bool changesCFG_;
+    std::vector<bool>& cached_;
+};
+
+void testNewPassManager() {
+    std::cout << "Testing new pass manager adaptors... ";
+    
+    llvm::LLVMContext context;
+    llvm::SMDiagnostic error;
+    auto module = llvm::parseAssemblyString(
+        "define i32 @f(i32 %x) {\n"
+        "entry:\n"
+        "  %c = icmp eq i32 %x, 0\n"
+        "  br i1 %c, label %a, label %b\n"
+        "a:\n"
+        "  ret i32 1\n"
+        "b:\n"
+        "  ret i32 %x\n"
+        "}\n", error, context);
+    assert(module);
+    
+    // The dominator tree survives passes that keep the CFG and is
+    // recomputed after one that changes it
+    std::vector<bool> cached;
+    AnalysisProbePass first("first", false, cached), second("second", false, cached);
+    AnalysisProbePass reshape("reshape", true, cached), last("last", false, cached);
+    AnalysisManagers analyses;
+    MetricsCollector metrics;
+    for (auto* pass : {&first, &second, &reshape, &last}) {
+        assert(pass->run(*module, metrics, analyses.getModuleManager()));
+    }
+    assert((cached == std::vector<bool>{false, true, true, false}));
+    
+    // Transformed functions are marked and not transformed again
+    llvm::Function* func = module->getFunction("f");
+    assert(func->getMetadata("obfuscated.first"));
+    assert(!first.run(*module, metrics, analyses.getModuleManager()));
+    assert(cached.size() == 4);
+    assert(metrics.getMetrics().passTransformations.at("first") == 1);
+    
+    // Standalone runs bring their own analysis managers
+    AnalysisProbePass standalone("standalone", false, cached);
+    assert(standalone.runOnModule(*module, metrics));
+    assert(cached.size() == 5 && !cached.back());
+    
+    std::cout << "✓\n";
+}
+
+void testPassPlugin() {
+    std::cout << "Testing pass plugin... ";
+    
+    // YAML as written by the auto-tuner; the level preset comes first
+    ConfigParser parser;
+    ObfuscationConfig config;
+    assert(parser.parseYAML("# comment\n"
+                            "obfuscation:\n"
+                            "  cycles: 2\n"
+                            "  seed: 99\n"
+                            "  level: low\n"
+                            "control_flow:\n"
+                            "  flattening_enabled: true\n"
+                            "unknown_section:\n"
+                            "  nested: [1, 2]\n", config));
+    assert(config.level == ObfuscationLevel::LOW);
+    assert(config.obfuscationCycles == 2 && config.seed == 99);
+    assert(config.enableControlFlowFlattening);
+    assert(!parser.parseYAML("obfuscation:\n  cycles: many\n", config));
+    assert(!parser.parseYAML("obfuscation:\n  cycles: 0\n", config));
+    assert(!parser.parseYAML("obfuscation: [\n", config));
+    
+    // PHANTRON_CONFIG is read when the pass is added to a pipeline
+    std::string configPath = "/tmp/phantron_plugin_test.yaml";
+    FileUtils::writeFile(configPath, "obfuscation:\n  level: medium\n  cycles: 1\n  seed: 7\n");
+    setenv("PHANTRON_CONFIG", configPath.c_str(), 1);
+    
+    llvm::LLVMContext context;
+    llvm::SMDiagnostic error;
+    auto module = llvm::parseAssemblyString(
+        "define i32 @f(i32 %x, i32 %y) {\n"
+        "entry:\n"
+        "  %c = icmp sgt i32 %x, %y\n"
+        "  br i1 %c, label %a, label %b\n"
+        "a:\n"
+        "  %s = add i32 %x, %y\n"
+        "  br label %done\n"
+        "b:\n"
+        "  %t = xor i32 %x, 1234\n"
+        "  br label %done\n"
+        "done:\n"
+        "  %r = phi i32 [ %s, %a ], [ %t, %b ]\n"
+        "  ret i32 %r\n"
+        "}\n", error, context);
+    assert(module);
+    unsigned originalSize = module->getFunction("f")->getInstructionCount();
+    
+    AnalysisManagers analyses;
+    llvm::PassBuilder builder;
+    registerPhantronPass(builder);
+    llvm::ModulePassManager passes;
+    assert(!builder.parsePassPipeline(passes, "phantron"));
+    passes.run(*module, analyses.getModuleManager());
+    unsetenv("PHANTRON_CONFIG");
+    FileUtils::deleteFile(configPath);
+    
+    assert(module->getFunction("f")->getInstructionCount() > originalSize);
+    assert(!llvm::verifyModule(*module, &llvm::errs()));
+    
+    std::cout << "✓\n";
+}
+
+void testProfileGuidedHotness() {
+    std::cout << "Testing profile-guided hotness... ";
+    
+    // Entered 10 times, the loop runs about 10000 times: hot above 1000
+    // and cold up to 10 according to the summary
+    llvm::LLVMContext context;
+    llvm::SMDiagnostic error;
+    auto module = llvm::parseAssemblyString(
+        "define i32 @f(i32 %n) !prof !20 {\n"
+        "entry:\n"
+        "  br label %loop\n"
+        "loop:\n"
+        "  %i = phi i32 [ 0, %entry ], [ %i.next, %loop ]\n"
+        "  %acc = phi i32 [ 0, %entry ], [ %acc.next, %loop ]\n"
+        "  %acc.next = add i32 %acc, %i\n"
+        "  %i.next = add i32 %i, 1\n"
+        "  %c = icmp slt i32 %i.next, %n\n"
+        "  br i1 %c, label %loop, label %exit, !prof !21\n"
+        "exit:\n"
+        "  %r = xor i32 %acc.next, 77\n"
+        "  ret i32 %r\n"
+        "}\n"
+        "!llvm.module.flags = !{!0}\n"
+        "!0 = !{i32 1, !\"ProfileSummary\", !1}\n"
+        "!1 = !{!2, !3, !4, !5, !6, !7, !8, !9}\n"
+        "!2 = !{!\"ProfileFormat\", !\"InstrProf\"}\n"
+        "!3 = !{!\"TotalCount\", i64 10020}\n"
+        "!4 = !{!\"MaxCount\", i64 10000}\n"
+        "!5 = !{!\"MaxInternalCount\", i64 10000}\n"
+        "!6 = !{!\"MaxFunctionCount\", i64 10}\n"
+        "!7 = !{!\"NumCounts\", i64 3}\n"
+        "!8 = !{!\"NumFunctions\", i64 1}\n"
+        "!9 = !{!\"DetailedSummary\", !10}\n"
+        "!10 = !{!11, !12}\n"
+        "!11 = !{i32 990000, i64 1000, i32 1}\n"
+        "!12 = !{i32 999999, i64 10, i32 3}\n"
+        "!20 = !{!\"function_entry_count\", i64 10}\n"
+        "!21 = !{!\"branch_weights\", i32 9990, i32 10}\n", error, context);
+    assert(module);
+    llvm::Function* func = module->getFunction("f");
+    
+    AnalysisManagers analyses;
+    analyses.getModuleManager().getResult<llvm::ProfileSummaryAnalysis>(*module);
+    BlockHotness hotness(*func, analyses.getFunctionManager());
+    auto block = [&](llvm::StringRef name) -> const llvm::BasicBlock* {
+        for (const auto& bb : *func) {
+            if (bb.getName() == name) {
+                return &bb;
+            }
+        }
+        return nullptr;
+    };
+    assert(hotness.getIntensity(block("entry")) == 100);
+    assert(hotness.getIntensity(block("exit")) == 100);
+    assert(hotness.getIntensity(block("loop")) == 0);
+    assert(hotness.getFunctionIntensity() == 0);
+    assert(hotness.scale(80, block("loop")) == 0 && hotness.scale(80, block("exit")) == 80);
+    
+    // Without a profile every block is at full strength
+    BlockHotness unprofiled;
+    assert(unprofiled.getIntensity(block("loop")) == 100);
+    
+    // MBA at full probability rewrites the cold xor but not the hot loop
+    MBAObfuscation mba(100);
+    MetricsCollector metrics;
+    assert(mba.run(*module, metrics, analyses.getModuleManager()));
+    auto* symbols = func->getValueSymbolTable();
+    assert(symbols->lookup("acc.next") && symbols->lookup("i.next"));
+    assert(!symbols->lookup("r"));
+    assert(!llvm::verifyModule(*module, &llvm::errs()));
+    
+    std::cout << "✓\n";
+}
+
+void testStaticHotness() {
+    std::cout << "Testing static hotness estimation... ";
+    
+    const char* source =
+        "define i32 @g(i32 %n) {\n"
+        "entry:\n"
+        "  br label %outer\n"
+        "outer:\n"
+        "  %i = phi i32 [ 0, %entry ], [ %i.next, %latch ]\n"
+        "  br label %inner\n"
+        "inner:\n"
+        "  %j = phi i32 [ 0, %outer ], [ %j.next, %inner ]\n"
+        "  %j.next = add i32 %j, 1\n"
+        "  %c = icmp slt i32 %j.next, %n\n"
+        "  br i1 %c, label %inner, label %latch\n"
+        "latch:\n"
+        "  %i.next = add i32 %i, 1\n"
+        "  %d = icmp slt i32 %i.next, %n\n"
+        "  br i1 %d, label %outer, label %exit\n"
+        "exit:\n"
+        "  %r = xor i32 %i.next, 77\n"
+        "  ret i32 %r\n"
+        "}\n";
+    
+    llvm::LLVMContext context;
+    llvm::SMDiagnostic error;
+    auto module = llvm::parseAssemblyString(source, error, context);
+    assert(module);
+    llvm::Function* func = module->getFunction("g");
+    auto block = [&](llvm::StringRef name) -> const llvm::BasicBlock* {
+        for (const auto& bb : *func) {
+            if (bb.getName() == name) {
+                return &bb;
+            }
+        }
+        return nullptr;
+    };
+    
+    // Innermost loop spared, outer loop halved, straight-line code untouched
+    AnalysisManagers analyses;
+    analyses.getModuleManager().getResult<llvm::ProfileSummaryAnalysis>(*module);
+    BlockHotness hotness(*func, analyses.getFunctionManager(), 8);
+    assert(hotness.getIntensity(block("inner")) == 0);
+    assert(hotness.getIntensity(block("latch")) == 50);
+    assert(hotness.getIntensity(block("entry")) == 100);
+    assert(hotness.getIntensity(block("exit")) == 100);
+    BlockHotness off(*func, analyses.getFunctionManager(), 0);
+    assert(off.getIntensity(block("inner")) == 100 && off.getFunctionIntensity() == 100);
+    
+    // MBA leaves the inner loop alone only when the estimate is on
+    MBAObfuscation guided(100);
+    guided.setHotLoopThreshold(8);
+    MetricsCollector metrics;
+    assert(guided.run(*module, metrics, analyses.getModuleManager()));
+    assert(func->getValueSymbolTable()->lookup("j.next"));
+    assert(!func->getValueSymbolTable()->lookup("r"));
+    
+    auto plainModule = llvm::parseAssemblyString(source, error, context);
+    AnalysisManagers plainAnalyses;
+    MBAObfuscation plain(100);
+    assert(plain.run(*plainModule, metrics, plainAnalyses.getModuleManager()));
+    assert(!plainModule->getFunction("g")->getValueSymbolTable()->lookup("j.next"));
+    
+    std::cout << "✓\n";
+}
+
+void testFunctionPolicy() {
+    std::cout << "Testing function policies... ";
+    
+    FunctionPolicy policy;
+    assert(FunctionPolicy::parse("level=low, intensity=50", policy));
+    assert(policy.level == "low" && policy.intensity == 50);
+    assert(!FunctionPolicy::parse("level=extreme", policy));
+    assert(!FunctionPolicy::parse("intensity=101", policy));
+    assert(!FunctionPolicy::parse("speed=1", policy));
+    
+    ConfigParser parser;
+    ObfuscationConfig config;
+    assert(parser.parseYAML("functions:\n"
+                            "  allow: [\"^lic_\", crypto]\n"
+                            "  deny:\n"
+                            "    - render\n"
+                            "  policies:\n"
+                            "    \"^lic_\": \"level=high\"\n"
+                            "    \"^hash_\": \"intensity=30\"\n", config));
+    assert(config.functionAllowList.size() == 2 && config.functionDenyList.size() == 1);
+    assert(config.functionPolicies.size() == 2 && config.functionPolicies[1].first == "^hash_");
+    assert(!parser.parseYAML("functions:\n  deny: [\"(\"]\n", config));
+    assert(!parser.parseYAML("functions:\n  policies:\n    f: \"level=max\"\n", config));
+    
+    // One function per way of choosing a policy, all with the same body
+    std::string source =
+        "@.none = private unnamed_addr constant [20 x i8] c\"phantron:level=none\\00\", "
+        "section \"llvm.metadata\"\n"
+        "@.low = private unnamed_addr constant [19 x i8] c\"phantron:level=low\\00\", "
+        "section \"llvm.metadata\"\n"
+        "@.file = private unnamed_addr constant [4 x i8] c\"t.c\\00\", section \"llvm.metadata\"\n"
+        "@llvm.global.annotations = appending global [2 x { i8*, i8*, i8*, i32, i8* }] [\n"
+        "  { i8*, i8*, i8*, i32, i8* } { i8* bitcast (i32 (i32, i32)* @annotated_none to i8*), "
+        "i8* getelementptr ([20 x i8], [20 x i8]* @.none, i32 0, i32 0), "
+        "i8* getelementptr ([4 x i8], [4 x i8]* @.file, i32 0, i32 0), i32 1, i8* null },\n"
+        "  { i8*, i8*, i8*, i32, i8* } { i8* bitcast (i32 (i32, i32)* @annotated_low to i8*), "
+        "i8* getelementptr ([19 x i8], [19 x i8]* @.low, i32 0, i32 0), "
+        "i8* getelementptr ([4 x i8], [4 x i8]* @.file, i32 0, i32 0), i32 2, i8* null }\n"
+        "], section \"llvm.metadata\"\n";
+    const char* names[] = {"annotated_none", "annotated_low", "denied", "gentle", "plain"};
+    for (const char* name : names) {
+        source += std::string("define i32 @") + name + "(i32 %x, i32 %y) {\n"
+            "entry:\n"
+            "  %c = icmp sgt i32 %x, %y\n"
+            "  br i1 %c, label %a, label %b\n"
+            "a:\n"
+            "  %s = add i32 %x, %y\n"
+            "  br label %done\n"
+            "b:\n"
+            "  %t = sub i32 %x, %y\n"
+            "  br label %done\n"
+            "done:\n"
+            "  %r = phi i32 [ %s, %a ], [ %t, %b ]\n"
+            "  ret i32 %r\n"
+            "}\n";
+    }
+    
+    llvm::LLVMContext context;
+    llvm::SMDiagnostic error;
+    auto module = llvm::parseAssemblyString(source, error, context);
+    assert(module);
+    unsigned originalSize = module->getFunction("plain")->getInstructionCount();
+    
+    config = ObfuscationConfig();
+    config.applyPreset(ObfuscationLevel::MEDIUM);
+    config.seed = 7;
+    config.substitutionProbability = 100;
+    config.enableStringEncryption = false;
+    config.enableCallGraphObfuscation = false;
+    config.enableAntiDebug = false;
+    config.functionDenyList = {"^denied$"};
+    config.functionPolicies = {{"^gentle$", "intensity=0"}, {"^annotated_", "level=high"}};
+    assert(config.validate());
+    
+    // The low annotation brings in LOW's function-local passes
+    PassManager manager(config);
+    size_t configuredPasses = manager.getPassCount();
+    manager.resolvePolicies(*module);
+    assert(manager.getPassCount() > configuredPasses);
+    assert(FunctionPolicy::isExcluded(*module->getFunction("annotated_none")));
+    assert(FunctionPolicy::getLevel(*module->getFunction("annotated_low")) == "low");
+    assert(FunctionPolicy::isExcluded(*module->getFunction("denied")));
+    assert(FunctionPolicy::getIntensity(*module->getFunction("gentle")) == 0);
+    assert(FunctionPolicy::getLevel(*module->getFunction("plain")).empty());
+    assert(!module->getFunction("plain")->hasFnAttribute("phantron-intensity"));
+    
+    MetricsCollector metrics;
+    assert(manager.runPasses(*module, metrics, 0));
+    assert(!llvm::verifyModule(*module, &llvm::errs()));
+    auto size = [&](const char* name) { return module->getFunction(name)->getInstructionCount(); };
+    assert(size("annotated_none") == originalSize);
+    assert(size("denied") == originalSize);
+    assert(size("gentle") == originalSize);
+    assert(size("annotated_low") > originalSize);
+    assert(size("plain") > originalSize);
+    
+    // With an allow list, functions nothing selects are left alone
+    auto allowModule = llvm::parseAssemblyString(source, error, context);
+    ObfuscationConfig allowConfig = config;
+    allowConfig.functionDenyList.clear();
+    allowConfig.functionPolicies.clear();
+    allowConfig.functionAllowList = {"^pla"};
+    FunctionPolicy::resolve(*allowModule, allowConfig);
+    assert(FunctionPolicy::getLevel(*allowModule->getFunction("plain")).empty());
+    assert(FunctionPolicy::isExcluded(*allowModule->getFunction("denied")));
+    assert(FunctionPolicy::getLevel(*allowModule->getFunction("annotated_low")) == "low");
+    
+    std::cout << "✓\n";
+}
+
+void testProtectedRegion() {
+    std::cout << "Testing protected call-graph region... ";
+    
+    // check_license -> decode -> (bitcast) mix -> leaf; render is unrelated
+    const char* source =
+        "declare i32 @puts(i8*)\n"
+        "define i32 @leaf(i32 %x) {\n"
+        "  %r = add i32 %x, 1\n"
+        "  ret i32 %r\n"
+        "}\n"
+        "define i32 @mix(i32 %x) {\n"
+        "  %r = call i32 @leaf(i32 %x)\n"
+        "  ret i32 %r\n"
+        "}\n"
+        "define i32 @decode(i32 %x) {\n"
+        "  %r = call i32 bitcast (i32 (i32)* @mix to i32 (i32, i32)*)(i32 %x, i32 0)\n"
+        "  ret i32 %r\n"
+        "}\n"
+        "define i32 @check_license(i32 %x) {\n"
+        "  %p = call i32 @puts(i8* null)\n"
+        "  %r = call i32 @decode(i32 %x)\n"
+        "  ret i32 %r\n"
+        "}\n"
+        "define i32 @render(i32 %x) {\n"
+        "  %r = call i32 @leaf(i32 %x)\n"
+        "  ret i32 %r\n"
+        "}\n";
+    
+    ObfuscationConfig config;
+    config.applyPreset(ObfuscationLevel::MEDIUM);
+    config.protectedRoots = {"^check_license$"};
+    config.protectedDepth = 1;
+    assert(config.validate());
+    
+    llvm::LLVMContext context;
+    llvm::SMDiagnostic error;
+    auto module = llvm::parseAssemblyString(source, error, context);
+    assert(module);
+    FunctionPolicy::resolve(*module, config);
+    auto excluded = [](llvm::Module& m, const char* name) {
+        return FunctionPolicy::isExcluded(*m.getFunction(name));
+    };
+    assert(!excluded(*module, "check_license") && !excluded(*module, "decode"));
+    assert(excluded(*module, "mix") && excluded(*module, "leaf") && excluded(*module, "render"));
+    
+    // Two hops reach through the cast call; the rest is only lightly obfuscated
+    config.protectedDepth = 2;
+    config.outsidePolicy = "level=low,intensity=30";
+    module = llvm::parseAssemblyString(source, error, context);
+    assert(FunctionPolicy::resolve(*module, config) == std::vector<std::string>{"low"});
+    assert(FunctionPolicy::getLevel(*module->getFunction("mix")).empty());
+    assert(FunctionPolicy::getLevel(*module->getFunction("leaf")) == "low");
+    assert(FunctionPolicy::getIntensity(*module->getFunction("render")) == 30);
+    
+    // Lazily loaded bodies are read as the region grows
+    llvm::SmallVector<char, 0> bitcode;
+    {
+        llvm::raw_svector_ostream stream(bitcode);
+        llvm::WriteBitcodeToFile(*llvm::parseAssemblyString(source, error, context), stream);
+    }
+    auto lazy = llvm::getLazyBitcodeModule(
+        llvm::MemoryBufferRef(llvm::StringRef(bitcode.data(), bitcode.size()), "lazy"), context);
+    assert(lazy);
+    FunctionPolicy::resolve(**lazy, config);
+    assert(FunctionPolicy::getLevel(*(*lazy)->getFunction("mix")).empty());
+    assert(FunctionPolicy::getLevel(*(*lazy)->getFunction("leaf")) == "low");
+    assert((*lazy)->getFunction("render")->isMaterializable());
+    
+    std::cout << "✓\n";
+}
+
+/**
+ * @brief IR of a function with a chain of blocks, each branching one or two blocks ahead
+ */
+std::string makeBranchChain(size_t blocks) {
+    std::string source = "define i64 @chain(i64 %x) {\nentry:\n  br label %b0\n";
+    for (size_t i = 0; i < blocks; ++i) {
+        std::string n = std::to_string(i);
+        source += "b" + n + ":\n";
+        if (i == 0) {
+            source += "  %v0 = add i64 %x, 1\n";
+        } else if (i == 1) {
+            source += "  %v1 = add i64 %v0, 2\n";
+        } else {
+            std::string a = std::to_string(i - 1), b = std::to_string(i - 2);
+            source += "  %p" + n + " = phi i64 [ %v" + a + ", %b" + a + " ], [ %v" + b + ", %b" +
+                      b + " ]\n  %v" + n + " = add i64 %p" + n + ", " + n + "\n";
+        }
+        if (i + 1 == blocks) {
+            source += "  ret i64 %v" + n + "\n";
+        } else if (i + 2 == blocks) {
+            source += "  br label %b" + std::to_string(i + 1) + "\n";
+        } else {
+            source += "  %c" + n + " = icmp ult i64 %v" + n + ", " + std::to_string(i * 7) + "\n"
+                      "  br i1 %c" + n + ", label %b" + std::to_string(i + 1) + ", label %b" +
+                      std::to_string(i + 2) + "\n";
+        }
+    }
+    return source + "}\n";
+}
+
+void testFlatteningScales() {
+    std::cout << "Testing control flow flattening of large functions... ";
+    
+    auto regions = [](const llvm::Function& func) {
+        return std::count_if(func.begin(), func.end(), [](const llvm::BasicBlock& bb) {
+            return bb.getName().startswith("dispatch.region");
+        });
+    };
+    
+    // PHIs and values crossing blocks survive flattening; small functions
+    // have one dispatcher, large ones one per region
+    for (size_t blocks : {6, 2000}) {
+        llvm::LLVMContext context;
+        llvm::SMDiagnostic error;
+        auto module = llvm::parseAssemblyString(makeBranchChain(blocks), error, context);
+        assert(module && !llvm::verifyModule(*module, &llvm::errs()));
+        
+        ControlFlowFlattening flattening(100);
+        MetricsCollector metrics;
+        assert(flattening.runOnModule(*module, metrics));
+        assert(!llvm::verifyModule(*module, &llvm::errs()));
+        llvm::Function* func = module->getFunction("chain");
+        assert(func->getMetadata("obfuscated.ControlFlowFlattening"));
+        for (const auto& bb : *func) {
+            assert(!llvm::isa<llvm::PHINode>(bb.front()));
+        }
+        assert(blocks < 100 ? regions(*func) == 0 : regions(*func) > 1);
+    }
+    
+    std::cout << "✓\n";
+}
+
 int main() {
     std::cout << "Running unit tests...\n\n";
     
@@ -69,6 +1557,29 @@ int main() {
         testObfuscationConfig();
         testMetricsCollector();
         testRandomGenerator();
+        testRandomStream();
+        testResultCache();
+        testFunctionCache();
+        testCodegenPartitions();
+        testObjectConstructors();
+        testLowMemoryPipeline();
+        testMemoryFile();
+        testProjectBuilder();
+        testManifest();
+        testServerProtocol();
+        testBoundedQueue();
+        testTracer();
+        testPerfCounters();
+        testMemoryTracker();
+        testParallelPasses();
+        testPassScheduler();
+        testNewPassManager();
+        testPassPlugin();
+        testProfileGuidedHotness();
+        testStaticHotness();
+        testFunctionPolicy();
+        testProtectedRegion();
+        testFlatteningScales();
         
         std::cout << "\n✓ All unit tests passed!\n";
         return 0;